@@ -0,0 +1,16 @@
+#version 430
+
+layout(location = 0) in vec4 inColor;
+
+// We output a single color to the color buffer
+layout(location = 0) out vec4 frag_color;
+
+void main() {
+	// Round sprites that fade out towards the edges
+	vec2 offset = gl_PointCoord * 2.0 - 1.0;
+	float falloff = 1.0 - dot(offset, offset);
+	if (falloff <= 0.0) {
+		discard;
+	}
+	frag_color = vec4(inColor.rgb, inColor.a * falloff);
+}
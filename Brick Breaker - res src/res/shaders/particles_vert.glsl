@@ -0,0 +1,38 @@
+#version 430
+
+// Draws the particles from ParticleSystem as point sprites, one vertex per particle, with no vertex buffers
+
+layout(location = 0) out vec4 outColor;
+
+// Matches Particle in ParticleSim.h
+struct Particle {
+	vec4 PositionLife;
+	vec4 VelocitySize;
+	vec4 Color;
+};
+
+layout(std430, binding = 1) readonly buffer b_Particles {
+	Particle Particles[];
+};
+
+uniform mat4  u_ViewProjection;
+// How many pixels a particle of size 1 covers at a distance of 1
+uniform float u_PointScale;
+
+void main() {
+	Particle particle = Particles[gl_VertexID];
+
+	// Dead particles go outside of the clip volume, so they never get rasterized
+	if (particle.PositionLife.w <= 0.0) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		gl_PointSize = 1.0;
+		outColor = vec4(0.0);
+		return;
+	}
+
+	gl_Position = u_ViewProjection * vec4(particle.PositionLife.xyz, 1.0);
+	gl_PointSize = max(1.0, particle.VelocitySize.w * u_PointScale / gl_Position.w);
+
+	// Fade out over the particle's life
+	outColor = vec4(particle.Color.rgb, particle.PositionLife.w / particle.Color.a);
+}
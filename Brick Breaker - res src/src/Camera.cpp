@@ -15,6 +15,7 @@ Camera::Camera() :
     _view(glm::mat4(1.0f)),
     _projection(glm::mat4(1.0f)),
     _viewProjection(glm::mat4(1.0f)),
+    _frustumPlanes(),
     _isDirty(true)
 {
     __CalculateProjection();
@@ -68,11 +69,30 @@ void Camera::SetOrthoVerticalScale(float value) {
 const glm::mat4& Camera::GetViewProjection() const {
     if (_isDirty) {
         _viewProjection = _projection * _view;
+        __CalculateFrustumPlanes();
         _isDirty = false;
     }
     return _viewProjection;
 }
 
+const glm::vec4* Camera::GetFrustumPlanes() const {
+    // Makes sure our view projection and planes are up to date
+    GetViewProjection();
+    return _frustumPlanes;
+}
+
+float Camera::GetProjectedSize(const glm::vec4& sphere) const {
+    if (_isOrtho) {
+        return (sphere.w * 2.0f) / _orthoVerticalScale;
+    }
+    // Anything the camera is inside of covers the whole screen
+    const float distance = glm::length(glm::vec3(sphere) - _position);
+    if (distance <= sphere.w) {
+        return 1.0f;
+    }
+    return sphere.w / (distance * glm::tan(_fovRadians * 0.5f));
+}
+
 void Camera::__CalculateProjection()
 {
     if (_isOrtho) {
@@ -86,6 +106,28 @@ void Camera::__CalculateProjection()
     _isDirty = true;
 }
 
+void Camera::__CalculateFrustumPlanes() const
+{
+    // Gribb & Hartmann, a point is inside the clip volume when -w <= x, y, z <= w, so each plane
+    // is the last row of the view projection plus or minus one of the other rows
+    const glm::mat4& m = _viewProjection;
+    glm::vec4 rows[4];
+    for (int ix = 0; ix < 4; ix++) {
+        rows[ix] = glm::vec4(m[0][ix], m[1][ix], m[2][ix], m[3][ix]);
+    }
+    _frustumPlanes[0] = rows[3] + rows[0]; // Left
+    _frustumPlanes[1] = rows[3] - rows[0]; // Right
+    _frustumPlanes[2] = rows[3] + rows[1]; // Bottom
+    _frustumPlanes[3] = rows[3] - rows[1]; // Top
+    _frustumPlanes[4] = rows[3] + rows[2]; // Near
+    _frustumPlanes[5] = rows[3] - rows[2]; // Far
+
+    // Normalize so that plane distances are in world units, and can be compared against sphere radii
+    for (int ix = 0; ix < 6; ix++) {
+        _frustumPlanes[ix] /= glm::length(glm::vec3(_frustumPlanes[ix]));
+    }
+}
+
 void Camera::__CalculateView() {
     _view = glm::lookAt(_position, _position + _normal, _up);
     _isDirty = true;
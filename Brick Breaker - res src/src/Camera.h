@@ -99,6 +99,17 @@ public:
 	/// Gets the combined view-projection matrix for this camera, calculating if needed
 	/// </summary>
 	const glm::mat4& GetViewProjection() const;
+	/// <summary>
+	/// Gets the 6 planes of the camera's view frustum in world space, in the order left, right, bottom, top, near, far.
+	/// Each plane is stored as (normal, distance) with the normal facing into the frustum, so a point p is inside
+	/// a plane when dot(plane.xyz, p) + plane.w >= 0. Works for both orthographic and perspective projections
+	/// </summary>
+	const glm::vec4* GetFrustumPlanes() const;
+	/// <summary>
+	/// Gets how large a bounding sphere appears on screen, as a fraction of the window's height (1 fills the window vertically)
+	/// </summary>
+	/// <param name="sphere">The world space sphere, as (center, radius)</param>
+	float GetProjectedSize(const glm::vec4& sphere) const;
 
 protected:
 	float _nearPlane;
@@ -118,6 +129,8 @@ protected:
 
 	// The view projection, it is mutable so we can re-calculate it during const methods
 	mutable glm::mat4 _viewProjection;
+	// The frustum planes, extracted from the view projection whenever it is re-calculated
+	mutable glm::vec4 _frustumPlanes[6];
 	// A dirty flag that indicates whether we need to re-calculate our view projection matrix
 	mutable bool      _isDirty;
 
@@ -125,4 +138,6 @@ protected:
 	void __CalculateProjection();
 	// Recalculates the view matrix
 	void __CalculateView();
+	// Extracts the frustum planes from the view projection matrix
+	void __CalculateFrustumPlanes() const;
 };
\ No newline at end of file
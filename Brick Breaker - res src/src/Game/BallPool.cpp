@@ -0,0 +1,101 @@
+#include "Game/BallPool.h"
+
+#include <Logging.h>
+
+BallPool::BallPool() :
+	_count(0),
+	_positions(std::vector<glm::vec2>()),
+	_previousPositions(std::vector<glm::vec2>()),
+	_directions(std::vector<glm::vec2>()),
+	_speeds(std::vector<glm::vec2>()),
+	_radii(std::vector<float>()),
+	_flags(std::vector<BallFlags>()),
+	_handleToIndex(std::vector<uint32_t>()),
+	_indexToHandle(std::vector<Handle>()),
+	_freeHandles(std::vector<Handle>()),
+	_freeCount(0) { }
+
+void BallPool::SetCapacity(uint32_t capacity) {
+	_positions.resize(capacity);
+	_previousPositions.resize(capacity);
+	_directions.resize(capacity);
+	_speeds.resize(capacity);
+	_radii.resize(capacity);
+	_flags.resize(capacity);
+	_handleToIndex.resize(capacity);
+	_indexToHandle.resize(capacity);
+	_freeHandles.resize(capacity);
+	Clear();
+}
+
+void BallPool::Clear() {
+	_count = 0;
+	// Hand out the lowest handles first, so the same spawns always get the same handles
+	const uint32_t capacity = GetCapacity();
+	for (uint32_t ix = 0; ix < capacity; ix++) {
+		_freeHandles[ix] = capacity - 1 - ix;
+		_handleToIndex[ix] = INVALID_HANDLE;
+	}
+	_freeCount = capacity;
+}
+
+BallPool::Handle BallPool::Spawn(const Ball& ball) {
+	if (_freeCount == 0) {
+		return INVALID_HANDLE;
+	}
+	const Handle handle = _freeHandles[--_freeCount];
+	const uint32_t index = _count++;
+	_handleToIndex[handle] = index;
+	_indexToHandle[index] = handle;
+	Set(index, ball);
+	_previousPositions[index] = ball.Position;
+	return handle;
+}
+
+void BallPool::Despawn(Handle handle) {
+	const uint32_t index = GetIndex(handle);
+	LOG_ASSERT(index != INVALID_HANDLE, "Ball has already been despawned!");
+	DespawnAt(index);
+}
+
+void BallPool::DespawnAt(uint32_t index) {
+	LOG_ASSERT(index < _count, "Ball index out of range!");
+	const Handle handle = _indexToHandle[index];
+	const uint32_t last = --_count;
+	if (index != last) {
+		_positions[index] = _positions[last];
+		_previousPositions[index] = _previousPositions[last];
+		_directions[index] = _directions[last];
+		_speeds[index] = _speeds[last];
+		_radii[index] = _radii[last];
+		_flags[index] = _flags[last];
+		_indexToHandle[index] = _indexToHandle[last];
+		_handleToIndex[_indexToHandle[index]] = index;
+	}
+	_handleToIndex[handle] = INVALID_HANDLE;
+	_freeHandles[_freeCount++] = handle;
+}
+
+BallPool::Ball BallPool::Get(uint32_t index) const {
+	Ball result;
+	result.Position = _positions[index];
+	result.Direction = _directions[index];
+	result.Speed = _speeds[index];
+	result.Radius = _radii[index];
+	result.Flags = _flags[index];
+	return result;
+}
+
+void BallPool::Set(uint32_t index, const Ball& ball) {
+	_positions[index] = ball.Position;
+	_directions[index] = ball.Direction;
+	_speeds[index] = ball.Speed;
+	_radii[index] = ball.Radius;
+	_flags[index] = ball.Flags;
+}
+
+void BallPool::StorePreviousPositions() {
+	for (uint32_t ix = 0; ix < _count; ix++) {
+		_previousPositions[ix] = _positions[ix];
+	}
+}
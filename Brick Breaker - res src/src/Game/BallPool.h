@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Flags for each ball in a BallPool
+/// </summary>
+enum class BallFlags : uint8_t {
+	None       = 0,
+	// The ball is moving and colliding, only cleared on the last ball once the game is lost
+	Active     = 1 << 0,
+	// Fired from the paddle, it's gone once it hits anything and doesn't count towards keeping the game going
+	Projectile = 1 << 1
+};
+
+/// <summary>
+/// Storage for every ball and projectile in the game, kept as structure-of-arrays so passes over a single
+/// field (like building the render instances) only touch the memory they need
+///
+/// All the storage is allocated up front by SetCapacity, so spawning and despawning never touch the heap. Live
+/// balls are packed into the first GetCount() elements of each array, and despawning moves the last ball into
+/// the hole it leaves. Since that changes indices, Spawn returns a handle that stays the same for the ball's
+/// whole life
+/// </summary>
+class BallPool
+{
+public:
+	typedef uint32_t Handle;
+	static constexpr Handle INVALID_HANDLE = 0xFFFFFFFF;
+
+	/// <summary>
+	/// A copy of a single ball, for working with one ball at a time
+	/// </summary>
+	struct Ball {
+		glm::vec2 Position;
+		// The direction signs on each axis (-1, 0 or 1)
+		glm::vec2 Direction;
+		// The speed along each axis, per step
+		glm::vec2 Speed;
+		float     Radius;
+		BallFlags Flags;
+
+		bool HasFlag(BallFlags flag) const { return ((uint8_t)Flags & (uint8_t)flag) != 0; }
+	};
+
+	BallPool();
+	~BallPool() = default;
+
+	/// <summary>
+	/// Removes all balls, and allocates room for the given number of them. This is the only time the pool allocates
+	/// </summary>
+	void SetCapacity(uint32_t capacity);
+	uint32_t GetCapacity() const { return static_cast<uint32_t>(_positions.size()); }
+	uint32_t GetCount() const { return _count; }
+	bool IsFull() const { return _count == GetCapacity(); }
+
+	/// <summary>
+	/// Adds a ball to the end of the pool
+	/// </summary>
+	/// <returns>The handle for the new ball, or INVALID_HANDLE if the pool is full</returns>
+	Handle Spawn(const Ball& ball);
+	/// <summary>
+	/// Removes a ball, moving the last ball into it's place
+	/// </summary>
+	void Despawn(Handle handle);
+	/// <summary>
+	/// Removes the ball at an index, moving the last ball into it's place. When despawning while looping over the
+	/// pool, the same index needs to be visited again
+	/// </summary>
+	void DespawnAt(uint32_t index);
+	/// <summary>
+	/// Removes all balls, keeping the storage
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets the current index of a ball, or INVALID_HANDLE if it has been despawned
+	/// </summary>
+	uint32_t GetIndex(Handle handle) const { return handle < _handleToIndex.size() ? _handleToIndex[handle] : INVALID_HANDLE; }
+	Handle GetHandle(uint32_t index) const { return _indexToHandle[index]; }
+
+	/// <summary>
+	/// Copies a ball out of the pool, or back into it
+	/// </summary>
+	Ball Get(uint32_t index) const;
+	void Set(uint32_t index, const Ball& ball);
+
+	/// <summary>
+	/// Remembers where every ball is, so rendering can blend between steps (see GetPreviousPositions)
+	/// </summary>
+	void StorePreviousPositions();
+
+	// The arrays for each field, only the first GetCount() elements are valid
+	const glm::vec2* GetPositions() const { return _positions.data(); }
+	const glm::vec2* GetPreviousPositions() const { return _previousPositions.data(); }
+	const glm::vec2* GetDirections() const { return _directions.data(); }
+	const glm::vec2* GetSpeeds() const { return _speeds.data(); }
+	const float* GetRadii() const { return _radii.data(); }
+	const BallFlags* GetFlags() const { return _flags.data(); }
+
+protected:
+	uint32_t               _count;
+	std::vector<glm::vec2> _positions;
+	std::vector<glm::vec2> _previousPositions;
+	std::vector<glm::vec2> _directions;
+	std::vector<glm::vec2> _speeds;
+	std::vector<float>     _radii;
+	std::vector<BallFlags> _flags;
+
+	// Handles index into _handleToIndex, which stays valid while balls move around. Unused handles are kept
+	// on a stack in _freeHandles, with the top at _freeHandles[_freeCount - 1]
+	std::vector<uint32_t>  _handleToIndex;
+	std::vector<Handle>    _indexToHandle;
+	std::vector<Handle>    _freeHandles;
+	uint32_t               _freeCount;
+};
@@ -0,0 +1,560 @@
+// Replays depend on every step giving the exact same result on every machine, so stop the compiler from fusing
+// multiplies and adds into FMA instructions, which round differently depending on the CPU the build targets
+#if defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+	#pragma fp_contract(off)
+#elif defined(__GNUC__)
+	#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "Game/BrickBreakerSim.h"
+#include "Game/CollisionKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Logging.h>
+
+BrickBreakerSim::BrickBreakerSim() :
+	_playfield(Playfield()),
+	_stepScale(1.0f),
+	_balls(BallPool()),
+	_fireCooldown(0.0f),
+	_paddle(glm::vec2(0.0f)),
+	_bricks(std::vector<Brick>()),
+	_bricksHit(0),
+	_breakableBricks(0),
+	_state(SimState::Playing),
+	_stepCount(0),
+	_grid(CollisionGrid()),
+	_isGridDirty(true),
+	_candidates(std::vector<uint32_t>()),
+	_circleX(std::vector<float>()),
+	_circleY(std::vector<float>()),
+	_circleRadius(std::vector<float>()),
+	_circleIds(std::vector<uint32_t>())
+{
+	_balls.SetCapacity(DEFAULT_BALL_CAPACITY);
+	Reset(glm::vec2(0.0f), glm::vec2(0.0f));
+}
+
+bool BrickBreakerSim::Overlaps(const Ball& ball, const Brick& brick) {
+	const glm::vec2 offset = ball.Position - brick.Position;
+	if (brick.Shape == BrickShape::Circle) {
+		const float hitDistance = brick.HalfExtents.x + ball.Radius;
+		return glm::dot(offset, offset) <= hitDistance * hitDistance;
+	}
+	else {
+		// Distance from the ball to the closest point on the box
+		const glm::vec2 outside = glm::max(glm::abs(offset) - brick.HalfExtents, glm::vec2(0.0f));
+		return glm::dot(outside, outside) <= ball.Radius * ball.Radius;
+	}
+}
+
+bool BrickBreakerSim::SweepCircle(const glm::vec2& start, const glm::vec2& velocity, float radius, const glm::vec2& center, float maxTime, float& outTime) {
+	// Solve |offset + velocity * t| = radius for the first t
+	const glm::vec2 offset = start - center;
+	const float c = glm::dot(offset, offset) - radius * radius;
+	const float b = glm::dot(offset, velocity);
+	// Moving away, or not moving at all. This includes circles that are already touching, so a ball that just
+	// bounced off a brick that survived the hit doesn't hit it again straight away
+	if (b >= 0.0f) {
+		return false;
+	}
+	if (c <= 0.0f) {
+		outTime = 0.0f;
+		return true;
+	}
+	const float a = glm::dot(velocity, velocity);
+	const float discriminant = b * b - a * c;
+	if (discriminant < 0.0f) {
+		return false;
+	}
+	const float time = (-b - std::sqrt(discriminant)) / a;
+	if (time > maxTime) {
+		return false;
+	}
+	outTime = time;
+	return true;
+}
+
+bool BrickBreakerSim::SweepBox(const glm::vec2& start, const glm::vec2& velocity, float radius, const glm::vec2& center, const glm::vec2& halfExtents, float maxTime, float& outTime) {
+	const glm::vec2 offset = start - center;
+	const glm::vec2 outside = glm::max(glm::abs(offset) - halfExtents, glm::vec2(0.0f));
+	if (glm::dot(outside, outside) <= radius * radius) {
+		// Touching, but only a hit if the circle isn't already moving away from the closest point on the box
+		const glm::vec2 push = offset - glm::clamp(offset, -halfExtents, halfExtents);
+		if (push != glm::vec2(0.0f) && glm::dot(push, velocity) >= 0.0f) {
+			return false;
+		}
+		outTime = 0.0f;
+		return true;
+	}
+
+	// Trace the center against the box grown by the radius, using the slab test
+	const glm::vec2 extents = halfExtents + glm::vec2(radius);
+	float entry = 0.0f, exit = maxTime;
+	for (int axis = 0; axis < 2; axis++) {
+		if (velocity[axis] == 0.0f) {
+			if (std::abs(offset[axis]) > extents[axis]) {
+				return false;
+			}
+			continue;
+		}
+		float near = (-extents[axis] - offset[axis]) / velocity[axis];
+		float far = (extents[axis] - offset[axis]) / velocity[axis];
+		if (near > far) {
+			std::swap(near, far);
+		}
+		entry = std::max(entry, near);
+		exit = std::min(exit, far);
+		if (entry > exit) {
+			return false;
+		}
+	}
+
+	// The grown box has rounded corners, if we entered it in a corner region the real hit is against the corner
+	const glm::vec2 hit = offset + velocity * entry;
+	if (std::abs(hit.x) > halfExtents.x && std::abs(hit.y) > halfExtents.y) {
+		const glm::vec2 corner = glm::vec2(hit.x > 0.0f ? halfExtents.x : -halfExtents.x, hit.y > 0.0f ? halfExtents.y : -halfExtents.y);
+		return SweepCircle(offset, velocity, radius, corner, maxTime, outTime);
+	}
+	outTime = entry;
+	return true;
+}
+
+bool BrickBreakerSim::SweepBrick(const Ball& ball, const glm::vec2& velocity, const Brick& brick, float maxTime, float& outTime) {
+	if (brick.Shape == BrickShape::Circle) {
+		return SweepCircle(ball.Position, velocity, brick.HalfExtents.x + ball.Radius, brick.Position, maxTime, outTime);
+	}
+	else {
+		return SweepBox(ball.Position, velocity, ball.Radius, brick.Position, brick.HalfExtents, maxTime, outTime);
+	}
+}
+
+void BrickBreakerSim::SetTickRate(float ticksPerSecond) {
+	LOG_ASSERT(ticksPerSecond > 0.0f, "Tick rate must be greater than zero!");
+	_stepScale = BASE_TICK_RATE / ticksPerSecond;
+}
+
+void BrickBreakerSim::SetBallCapacity(uint32_t capacity) {
+	LOG_ASSERT(capacity > 0, "There needs to be room for at least one ball!");
+	_balls.SetCapacity(capacity);
+}
+
+void BrickBreakerSim::Reset(const glm::vec2& ballPosition, const glm::vec2& paddlePosition) {
+	_balls.Clear();
+	_fireCooldown = 0.0f;
+	// The ball starts off heading straight down towards the paddle
+	AddBall(ballPosition, glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, 0.013f));
+	_paddle = paddlePosition;
+	_bricks.clear();
+	_bricksHit = 0;
+	_breakableBricks = 0;
+	_state = SimState::Playing;
+	_stepCount = 0;
+	_isGridDirty = true;
+}
+
+void BrickBreakerSim::LoadDefaultLevel() {
+	_playfield = Playfield();
+	Reset(glm::vec2(0.0f, 0.0f), glm::vec2(0.0f, 5.8f));
+	AddBrick(glm::vec2(-4.3f, -4.5f));
+	AddBrick(glm::vec2(-4.3f, -0.52f));
+	AddBrick(glm::vec2(0.0f, -2.5f));
+	AddBrick(glm::vec2(4.3f, -4.5f));
+	AddBrick(glm::vec2(4.3f, -0.52f));
+}
+
+uint32_t BrickBreakerSim::AddBrick(const glm::vec2& position, float radius, uint16_t hitPoints) {
+	Brick brick;
+	brick.Position = position;
+	brick.HalfExtents = glm::vec2(radius);
+	brick.Shape = BrickShape::Circle;
+	brick.IsAlive = true;
+	brick.Type = 0;
+	brick.HitPoints = hitPoints;
+	return AddBricks(&brick, 1);
+}
+
+uint32_t BrickBreakerSim::AddBoxBrick(const glm::vec2& position, const glm::vec2& halfExtents, uint16_t hitPoints) {
+	Brick brick;
+	brick.Position = position;
+	brick.HalfExtents = halfExtents;
+	brick.Shape = BrickShape::Box;
+	brick.IsAlive = true;
+	brick.Type = 0;
+	brick.HitPoints = hitPoints;
+	return AddBricks(&brick, 1);
+}
+
+uint32_t BrickBreakerSim::AddBricks(const Brick* bricks, uint32_t count) {
+	const uint32_t first = static_cast<uint32_t>(_bricks.size());
+	_bricks.insert(_bricks.end(), bricks, bricks + count);
+	for (uint32_t ix = 0; ix < count; ix++) {
+		_breakableBricks += bricks[ix].IsAlive && bricks[ix].HitPoints > 0;
+	}
+	_isGridDirty = true;
+	return first;
+}
+
+BallPool::Handle BrickBreakerSim::AddBall(const glm::vec2& position, const glm::vec2& direction, const glm::vec2& speed, float radius) {
+	Ball ball;
+	ball.Position = position;
+	ball.Direction = direction;
+	ball.Speed = speed;
+	ball.Radius = radius;
+	ball.Flags = BallFlags::Active;
+	return _balls.Spawn(ball);
+}
+
+BallPool::Handle BrickBreakerSim::FireProjectile() {
+	Ball projectile;
+	projectile.Position = glm::vec2(_paddle.x, _playfield.PaddleHitY);
+	projectile.Direction = glm::vec2(0.0f, -1.0f);
+	projectile.Speed = glm::vec2(0.0f, PROJECTILE_SPEED);
+	projectile.Radius = PROJECTILE_RADIUS;
+	projectile.Flags = (BallFlags)((uint8_t)BallFlags::Active | (uint8_t)BallFlags::Projectile);
+	return _balls.Spawn(projectile);
+}
+
+uint32_t BrickBreakerSim::SpawnMultiball(uint32_t copies) {
+	// The same directions and speeds as the outer and inner hit zones of the paddle, on either side
+	const glm::vec2 speeds[2] = { glm::vec2(0.0122f, 0.0296f), glm::vec2(0.03f, 0.03f) };
+
+	// Only copy the balls that were in play before we started adding more
+	const uint32_t count = _balls.GetCount();
+	uint32_t added = 0;
+	for (uint32_t ix = 0; ix < count; ix++) {
+		const Ball ball = _balls.Get(ix);
+		if (!ball.HasFlag(BallFlags::Active) || ball.HasFlag(BallFlags::Projectile)) {
+			continue;
+		}
+		for (uint32_t copy = 0; copy < copies; copy++) {
+			const glm::vec2 direction = glm::vec2(copy % 2 == 0 ? -1.0f : 1.0f, ball.Direction.y != 0.0f ? ball.Direction.y : -1.0f);
+			if (AddBall(ball.Position, direction, speeds[(copy / 2) % 2], ball.Radius) == BallPool::INVALID_HANDLE) {
+				return added;
+			}
+			added++;
+		}
+	}
+	return added;
+}
+
+void BrickBreakerSim::FindOverlaps(const Ball& ball, std::vector<uint32_t>& outBricks) {
+	if (_isGridDirty) {
+		_RebuildGrid();
+	}
+	_GatherCandidates(ball.Position - ball.Radius, ball.Position + ball.Radius);
+
+	outBricks.clear();
+	for (uint32_t brickIx : _candidates) {
+		if (Overlaps(ball, _bricks[brickIx])) {
+			outBricks.push_back(brickIx);
+		}
+	}
+	for (uint32_t first = 0; first < _circleIds.size(); first += CollisionKernels::MAX_MASK_COUNT) {
+		const uint32_t count = std::min(CollisionKernels::MAX_MASK_COUNT, static_cast<uint32_t>(_circleIds.size()) - first);
+		uint32_t mask = CollisionKernels::OverlapMask(ball.Position, ball.Radius, &_circleX[first], &_circleY[first], &_circleRadius[first], count);
+		for (uint32_t ix = first; mask != 0; ix++, mask >>= 1) {
+			if (mask & 1) {
+				outBricks.push_back(_circleIds[ix]);
+			}
+		}
+	}
+	std::sort(outBricks.begin(), outBricks.end());
+}
+
+void BrickBreakerSim::Step(const SimInput& input) {
+	// Once the game is over, nothing moves until it's reset
+	if (_state != SimState::Playing) {
+		return;
+	}
+	_stepCount++;
+
+	_balls.StorePreviousPositions();
+
+	// Projectiles don't keep the game going, only the player's balls do
+	uint32_t activeBalls = 0;
+	const BallFlags* flags = _balls.GetFlags();
+	for (uint32_t ix = 0; ix < _balls.GetCount(); ix++) {
+		activeBalls += flags[ix] == BallFlags::Active;
+	}
+
+	// Despawning moves the last ball into the current index, so the index only moves on when a ball stays
+	for (uint32_t ix = 0; ix < _balls.GetCount(); ) {
+		Ball ball = _balls.Get(ix);
+		if (!ball.HasFlag(BallFlags::Active)) {
+			ix++;
+			continue;
+		}
+		if (!_Move(ball)) {
+			_balls.DespawnAt(ix);
+			continue;
+		}
+		// The ball went past the paddle. The last one stays where it fell, so there's still a ball to show
+		if (ball.Position.y > _playfield.LoseY && !ball.HasFlag(BallFlags::Projectile)) {
+			if (--activeBalls > 0) {
+				_balls.DespawnAt(ix);
+				continue;
+			}
+			ball.Speed = glm::vec2(0.0f);
+			ball.Flags = BallFlags::None;
+		}
+		_balls.Set(ix, ball);
+		ix++;
+	}
+
+	if (activeBalls == 0) {
+		_state = SimState::Lost;
+	}
+	if (_bricksHit == _breakableBricks && _breakableBricks > 0) {
+		_state = SimState::Won;
+	}
+	if (_state != SimState::Playing) {
+		return;
+	}
+
+	if (input.IsDown(SimKey::Left) && _paddle.x > -_playfield.PaddleLimitX) {
+		_paddle.x -= PADDLE_SPEED * _stepScale;
+	}
+	if (input.IsDown(SimKey::Right) && _paddle.x < _playfield.PaddleLimitX) {
+		_paddle.x += PADDLE_SPEED * _stepScale;
+	}
+
+	_fireCooldown = std::max(0.0f, _fireCooldown - _stepScale);
+	if (input.IsDown(SimKey::Fire) && _fireCooldown == 0.0f && FireProjectile() != BallPool::INVALID_HANDLE) {
+		_fireCooldown = FIRE_COOLDOWN;
+	}
+}
+
+uint64_t BrickBreakerSim::ComputeChecksum() const {
+	// FNV-1a over the raw bytes
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&](const void* data, size_t size) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+		for (size_t ix = 0; ix < size; ix++) {
+			hash = (hash ^ bytes[ix]) * 1099511628211ull;
+		}
+	};
+	for (uint32_t ix = 0; ix < _balls.GetCount(); ix++) {
+		mix(&_balls.GetPositions()[ix], sizeof(glm::vec2));
+		mix(&_balls.GetDirections()[ix], sizeof(glm::vec2));
+		mix(&_balls.GetSpeeds()[ix], sizeof(glm::vec2));
+		mix(&_balls.GetFlags()[ix], sizeof(BallFlags));
+	}
+	mix(&_paddle, sizeof(glm::vec2));
+	mix(&_fireCooldown, sizeof(float));
+	for (const Brick& brick : _bricks) {
+		mix(&brick.IsAlive, sizeof(bool));
+		// Single hit bricks are fully described by IsAlive, so they're left out to keep the checksums of
+		// recordings made before bricks had hit points
+		if (brick.HitPoints != (brick.IsAlive ? 1 : 0)) {
+			mix(&brick.HitPoints, sizeof(uint16_t));
+		}
+	}
+	mix(&_state, sizeof(SimState));
+	mix(&_stepCount, sizeof(uint64_t));
+	return hash;
+}
+
+void BrickBreakerSim::_RebuildGrid() {
+	// Cells about the size of the biggest brick keep each brick in at most 4 cells
+	float cellSize = 2.0f * BALL_RADIUS;
+	for (const Brick& brick : _bricks) {
+		cellSize = std::max(cellSize, 2.0f * std::max(brick.HalfExtents.x, brick.HalfExtents.y));
+	}
+
+	_grid.Clear(cellSize);
+	for (uint32_t ix = 0; ix < _bricks.size(); ix++) {
+		_grid.Insert(ix, _bricks[ix].Position - _bricks[ix].HalfExtents, _bricks[ix].Position + _bricks[ix].HalfExtents);
+	}
+	_grid.Build();
+	_isGridDirty = false;
+}
+
+void BrickBreakerSim::_GatherCandidates(const glm::vec2& min, const glm::vec2& max) {
+	if (_isGridDirty) {
+		_RebuildGrid();
+	}
+	_candidates.clear();
+	_grid.Query(min, max, _candidates);
+	// The grid returns bricks in whatever order it stores them, but hits need to be handled in the same order every time
+	std::sort(_candidates.begin(), _candidates.end());
+
+	_circleX.clear();
+	_circleY.clear();
+	_circleRadius.clear();
+	_circleIds.clear();
+	size_t boxes = 0;
+	for (uint32_t brickIx : _candidates) {
+		const Brick& brick = _bricks[brickIx];
+		if (!brick.IsAlive) {
+			continue;
+		}
+		if (brick.Shape == BrickShape::Circle) {
+			_circleX.push_back(brick.Position.x);
+			_circleY.push_back(brick.Position.y);
+			_circleRadius.push_back(brick.HalfExtents.x);
+			_circleIds.push_back(brickIx);
+		}
+		else {
+			_candidates[boxes++] = brickIx;
+		}
+	}
+	_candidates.resize(boxes);
+}
+
+bool BrickBreakerSim::_Move(Ball& ball) {
+	enum class ContactType { None, WallX, WallTop, Brick, Paddle };
+
+	// Time is measured in base ticks, so the speeds work the same at any tick rate
+	float remaining = _stepScale;
+	for (uint32_t substep = 0; substep < MAX_SUBSTEPS && remaining > 0.0f; substep++) {
+		// The ball was tuned to move twice as fast vertically
+		const glm::vec2 velocity = glm::vec2(ball.Speed.x * ball.Direction.x, ball.Speed.y * ball.Direction.y * 2.0f);
+
+		// Find the first thing the ball touches this step. Walls and the paddle are tested against the ball's
+		// center, the same as the game was designed with
+		ContactType contact = ContactType::None;
+		float contactTime = remaining;
+		uint32_t contactBrick = 0;
+
+		if (velocity.x != 0.0f) {
+			const float wall = velocity.x > 0.0f ? _playfield.WallX : -_playfield.WallX;
+			const float time = std::max(0.0f, (wall - ball.Position.x) / velocity.x);
+			if (time <= contactTime) {
+				contact = ContactType::WallX;
+				contactTime = time;
+			}
+		}
+		if (velocity.y < 0.0f) {
+			const float time = std::max(0.0f, (_playfield.WallTop - ball.Position.y) / velocity.y);
+			if (time <= contactTime) {
+				contact = ContactType::WallTop;
+				contactTime = time;
+			}
+		}
+
+		// Only the bricks near the path the ball takes this step need testing. If several are hit at the same
+		// time, the lowest index wins so the result is always the same
+		const glm::vec2 end = ball.Position + velocity * remaining;
+		_GatherCandidates(glm::min(ball.Position, end) - ball.Radius, glm::max(ball.Position, end) + ball.Radius);
+		float brickTime = contactTime;
+		int32_t circle = CollisionKernels::SweepEarliest(ball.Position, velocity, ball.Radius, _circleX.data(), _circleY.data(),
+														 _circleRadius.data(), static_cast<uint32_t>(_circleIds.size()), contactTime, brickTime);
+		bool hasBrick = circle >= 0;
+		uint32_t brickIx = hasBrick ? _circleIds[circle] : 0;
+		for (uint32_t boxIx : _candidates) {
+			float time;
+			if (SweepBrick(ball, velocity, _bricks[boxIx], contactTime, time) &&
+				(!hasBrick || time < brickTime || (time == brickTime && boxIx < brickIx))) {
+				hasBrick = true;
+				brickTime = time;
+				brickIx = boxIx;
+			}
+		}
+		if (hasBrick && brickTime < contactTime) {
+			contact = ContactType::Brick;
+			contactTime = brickTime;
+			contactBrick = brickIx;
+		}
+
+		if (velocity.y > 0.0f) {
+			const float time = std::max(0.0f, (_playfield.PaddleHitY - ball.Position.y) / velocity.y);
+			const float x = ball.Position.x + velocity.x * time;
+			if (time < contactTime && std::abs(x - _paddle.x) <= PADDLE_HALF_WIDTH) {
+				contact = ContactType::Paddle;
+				contactTime = time;
+			}
+		}
+
+		ball.Position += velocity * contactTime;
+		remaining -= contactTime;
+
+		// Projectiles are used up by whatever they hit
+		const bool isProjectile = ball.HasFlag(BallFlags::Projectile);
+		switch (contact) {
+			case ContactType::WallX:
+				ball.Direction.x = velocity.x > 0.0f ? -1.0f : 1.0f;
+				break;
+			case ContactType::WallTop:
+				ball.Direction.y = 1.0f;
+				break;
+			case ContactType::Brick:
+				_HitBrick(ball, _bricks[contactBrick]);
+				break;
+			case ContactType::Paddle:
+				_HitPaddle(ball);
+				break;
+			case ContactType::None:
+			default:
+				return true;
+		}
+		if (isProjectile) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void BrickBreakerSim::_HitBrick(Ball& ball, Brick& brick) {
+	const glm::vec2 offset = ball.Position - brick.Position;
+
+	if (brick.Shape == BrickShape::Circle) {
+		// The ball keeps it's speed, but bounces away from the brick's center. Note that the Y speed is
+		// based on the new X speed, which is how the game was originally tuned
+		const float hitDistance = brick.HalfExtents.x + ball.Radius;
+		ball.Speed.x = std::abs(offset.x) / (hitDistance / glm::length(ball.Speed));
+		ball.Speed.y = std::abs(offset.y) / (hitDistance / glm::length(ball.Speed));
+		if (offset.x != 0.0f) {
+			ball.Direction.x = offset.x > 0.0f ? 1.0f : -1.0f;
+		}
+		if (offset.y != 0.0f) {
+			ball.Direction.y = offset.y > 0.0f ? 1.0f : -1.0f;
+		}
+	}
+	else {
+		// Bounce off the side of the box that the ball is the least far into
+		const glm::vec2 penetration = brick.HalfExtents + glm::vec2(ball.Radius) - glm::abs(offset);
+		if (penetration.x < penetration.y) {
+			ball.Direction.x = offset.x >= 0.0f ? 1.0f : -1.0f;
+		}
+		else {
+			ball.Direction.y = offset.y >= 0.0f ? 1.0f : -1.0f;
+		}
+	}
+
+	// Unbreakable bricks just bounce the ball
+	if (brick.HitPoints > 0 && --brick.HitPoints == 0) {
+		brick.IsAlive = false;
+		_bricksHit++;
+	}
+}
+
+void BrickBreakerSim::_HitPaddle(Ball& ball) {
+	const float offset = ball.Position.x - _paddle.x;
+	ball.Direction.y = -1.0f;
+
+	// The further from the middle the ball hits, the sharper it bounces off to that side
+	if (offset < -PADDLE_EDGE_ZONE) {
+		ball.Direction.x = -1.0f;
+		ball.Speed = glm::vec2(0.03f, 0.03f);
+	}
+	else if (offset < -PADDLE_MIDDLE_ZONE) {
+		ball.Direction.x = -1.0f;
+		ball.Speed = glm::vec2(0.0122f, 0.0296f);
+	}
+	else if (offset <= PADDLE_MIDDLE_ZONE) {
+		ball.Direction.x = 0.0f;
+		ball.Speed = glm::vec2(0.0f, 0.022f);
+	}
+	else if (offset <= PADDLE_EDGE_ZONE) {
+		ball.Direction.x = 1.0f;
+		ball.Speed = glm::vec2(0.0122f, 0.0296f);
+	}
+	else {
+		ball.Direction.x = 1.0f;
+		ball.Speed = glm::vec2(0.03f, 0.03f);
+	}
+}
@@ -0,0 +1,307 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Game/BallPool.h"
+#include "Game/CollisionGrid.h"
+
+/// <summary>
+/// The keys that make up the player's input, as bits of SimInput::Keys
+/// </summary>
+enum class SimKey : uint8_t {
+	Left      = 1 << 0,
+	Right     = 1 << 1,
+	// The lighting toggles don't affect the simulation, but are recorded along with everything else
+	Lighting1 = 1 << 2,
+	Lighting2 = 1 << 3,
+	Lighting3 = 1 << 4,
+	Lighting4 = 1 << 5,
+	Lighting5 = 1 << 6,
+	Fire      = 1 << 7
+};
+
+/// <summary>
+/// The input for a single simulation step, stored as one byte so it can be recorded compactly (see InputLog)
+/// </summary>
+struct SimInput {
+	uint8_t Keys;
+
+	SimInput() : Keys(0) { }
+	explicit SimInput(uint8_t keys) : Keys(keys) { }
+	SimInput(bool left, bool right) : Keys(0) {
+		SetDown(SimKey::Left, left);
+		SetDown(SimKey::Right, right);
+	}
+
+	bool IsDown(SimKey key) const { return (Keys & (uint8_t)key) != 0; }
+	void SetDown(SimKey key, bool isDown) {
+		Keys = isDown ? (Keys | (uint8_t)key) : (Keys & ~(uint8_t)key);
+	}
+};
+
+/// <summary>
+/// Whether the game is still going, or how it ended
+/// </summary>
+enum class SimState {
+	Playing,
+	Won,
+	Lost
+};
+
+/// <summary>
+/// The shape that a brick collides as
+/// </summary>
+enum class BrickShape {
+	Circle,
+	Box
+};
+
+/// <summary>
+/// The brick breaker game logic, with no dependencies on the window or OpenGL. Positions are in the XY plane
+/// of the game's world space, with Y pointing down towards the paddle
+///
+/// The simulation only changes when Step is called, and only depends on the input it is given, so the same
+/// inputs will always produce the same game. This lets it run without a window, as fast as the CPU allows
+/// (see --headless), and keeps rendering completely separate from gameplay
+///
+/// Bricks are stored in a uniform grid (see CollisionGrid), so each ball is only tested against the few bricks
+/// near it, and the game can have any number of balls and bricks. Circle bricks are then tested several at a
+/// time with SIMD (see CollisionKernels)
+///
+/// Balls are moved with swept collision tests, so they stop at the exact time they touch a wall, brick or the
+/// paddle, bounce, and carry on for the rest of the step. Fast balls can't pass through anything between steps,
+/// which also lets the simulation run at a lower tick rate (see SetTickRate) and still play the same
+///
+/// Balls and the projectiles fired from the paddle live in a BallPool, which is allocated once, so thousands of
+/// them can come and go (see SpawnMultiball) without touching the heap
+/// </summary>
+class BrickBreakerSim
+{
+public:
+	// The playing field
+	static constexpr float WALL_X = 7.21f;
+	static constexpr float WALL_TOP = -7.17f;
+	static constexpr float LOSE_Y = 6.0f;
+
+	// The paddle, it's hit zones and how fast it moves each step
+	static constexpr float PADDLE_HIT_Y = 5.36f;
+	static constexpr float PADDLE_HALF_WIDTH = 1.44f;
+	static constexpr float PADDLE_EDGE_ZONE = 0.864f;
+	static constexpr float PADDLE_MIDDLE_ZONE = 0.288f;
+	static constexpr float PADDLE_LIMIT_X = 6.12f;
+	static constexpr float PADDLE_SPEED = 0.05f;
+
+	static constexpr float BALL_RADIUS = 0.3f;
+	static constexpr float BRICK_RADIUS = 0.63f;
+
+	// Projectiles fired from the paddle, and how many base ticks the paddle has to wait between shots
+	static constexpr float PROJECTILE_RADIUS = 0.1f;
+	static constexpr float PROJECTILE_SPEED = 0.075f;
+	static constexpr float FIRE_COOLDOWN = 15.0f;
+
+	// How many balls and projectiles can be in play at once, unless changed with SetBallCapacity
+	static constexpr uint32_t DEFAULT_BALL_CAPACITY = 4096;
+
+	// The speeds above were tuned for this many steps per second
+	static constexpr float BASE_TICK_RATE = 60.0f;
+	// The most times a ball can bounce in a single step, any movement left after that is dropped
+	static constexpr uint32_t MAX_SUBSTEPS = 8;
+
+	/// <summary>
+	/// The size of the playing field, which defaults to the one the game was designed for
+	/// </summary>
+	struct Playfield {
+		// Balls bounce off the walls at -WallX and WallX
+		float WallX;
+		// Balls bounce off the top wall when they go above this
+		float WallTop;
+		// Balls can hit the paddle once they're below this
+		float PaddleHitY;
+		// Balls are lost once they're below this
+		float LoseY;
+		// How far the paddle can move to either side
+		float PaddleLimitX;
+
+		Playfield() : WallX(WALL_X), WallTop(WALL_TOP), PaddleHitY(PADDLE_HIT_Y), LoseY(LOSE_Y), PaddleLimitX(PADDLE_LIMIT_X) { }
+	};
+
+	typedef BallPool::Ball Ball;
+
+	struct Brick {
+		glm::vec2  Position;
+		// Half the width and height of a box brick, or the radius on both axes for a circle brick
+		glm::vec2  HalfExtents;
+		BrickShape Shape;
+		bool       IsAlive;
+		// The level's type for the brick, which the game uses to pick it's material
+		uint16_t   Type;
+		// How many more hits the brick can take before it breaks, bricks that start with 0 never break
+		uint16_t   HitPoints;
+	};
+
+	/// <summary>
+	/// Returns true if a ball is touching a brick, using squared distances so no square roots are needed
+	/// </summary>
+	static bool Overlaps(const Ball& ball, const Brick& brick);
+	/// <summary>
+	/// Finds when a moving circle first touches a circle that isn't moving
+	/// </summary>
+	/// <param name="start">The center of the moving circle at time 0</param>
+	/// <param name="velocity">How far the moving circle moves per unit of time</param>
+	/// <param name="radius">The combined radius of both circles</param>
+	/// <param name="center">The center of the circle that isn't moving</param>
+	/// <param name="maxTime">The latest time to report a hit at</param>
+	/// <param name="outTime">Receives the time of impact, or 0 if the circles already overlap and are moving closer</param>
+	/// <returns>True if the circles touch before maxTime</returns>
+	static bool SweepCircle(const glm::vec2& start, const glm::vec2& velocity, float radius, const glm::vec2& center, float maxTime, float& outTime);
+	/// <summary>
+	/// Finds when a moving circle first touches a box that isn't moving
+	/// </summary>
+	/// <param name="start">The center of the circle at time 0</param>
+	/// <param name="velocity">How far the circle moves per unit of time</param>
+	/// <param name="radius">The radius of the circle</param>
+	/// <param name="center">The center of the box</param>
+	/// <param name="halfExtents">Half the width and height of the box</param>
+	/// <param name="maxTime">The latest time to report a hit at</param>
+	/// <param name="outTime">Receives the time of impact, or 0 if the circle already overlaps the box and is moving further in</param>
+	/// <returns>True if the circle touches the box before maxTime</returns>
+	static bool SweepBox(const glm::vec2& start, const glm::vec2& velocity, float radius, const glm::vec2& center, const glm::vec2& halfExtents, float maxTime, float& outTime);
+	/// <summary>
+	/// Finds when a moving ball first touches a brick
+	/// </summary>
+	static bool SweepBrick(const Ball& ball, const glm::vec2& velocity, const Brick& brick, float maxTime, float& outTime);
+
+	BrickBreakerSim();
+	~BrickBreakerSim() = default;
+
+	/// <summary>
+	/// Removes all bricks and extra balls, and puts the ball and paddle at the given positions
+	/// </summary>
+	void Reset(const glm::vec2& ballPosition, const glm::vec2& paddlePosition);
+	/// <summary>
+	/// Changes the size of the playing field, for levels bigger than the default one
+	/// </summary>
+	void SetPlayfield(const Playfield& playfield) { _playfield = playfield; }
+	const Playfield& GetPlayfield() const { return _playfield; }
+	/// <summary>
+	/// Sets how many times a second Step will be called, so each step moves things the right amount. Lower tick
+	/// rates are cheaper, and still give the same gameplay since balls can't skip past anything
+	/// </summary>
+	void SetTickRate(float ticksPerSecond);
+	float GetTickRate() const { return BASE_TICK_RATE / _stepScale; }
+	/// <summary>
+	/// Sets up the default level, with the same layout as the default scene
+	/// </summary>
+	void LoadDefaultLevel();
+	/// <summary>
+	/// Adds a circular brick to the level
+	/// </summary>
+	/// <returns>The index of the brick</returns>
+	uint32_t AddBrick(const glm::vec2& position, float radius = BRICK_RADIUS, uint16_t hitPoints = 1);
+	/// <summary>
+	/// Adds a rectangular brick to the level
+	/// </summary>
+	/// <param name="position">The center of the brick</param>
+	/// <param name="halfExtents">Half the width and height of the brick</param>
+	/// <param name="hitPoints">How many hits the brick takes to break, or 0 if it never breaks</param>
+	/// <returns>The index of the brick</returns>
+	uint32_t AddBoxBrick(const glm::vec2& position, const glm::vec2& halfExtents, uint16_t hitPoints = 1);
+	/// <summary>
+	/// Adds a whole layout of bricks at once, copying them straight into the brick storage with a single
+	/// allocation, so big levels can be loaded without the cost of adding bricks one at a time (see Level)
+	/// </summary>
+	/// <returns>The index of the first brick that was added</returns>
+	uint32_t AddBricks(const Brick* bricks, uint32_t count);
+	/// <summary>
+	/// Changes how many balls and projectiles can be in play at once. This is the only time the ball storage is
+	/// allocated, so it removes every ball, and should be called before the level is set up
+	/// </summary>
+	void SetBallCapacity(uint32_t capacity);
+	/// <summary>
+	/// Adds another ball to the game, the game is only lost once every ball is gone
+	/// </summary>
+	/// <returns>The handle of the ball, or BallPool::INVALID_HANDLE if there's no room for it</returns>
+	BallPool::Handle AddBall(const glm::vec2& position, const glm::vec2& direction, const glm::vec2& speed, float radius = BALL_RADIUS);
+	/// <summary>
+	/// Fires a projectile straight up from the middle of the paddle
+	/// </summary>
+	/// <returns>The handle of the projectile, or BallPool::INVALID_HANDLE if there's no room for it</returns>
+	BallPool::Handle FireProjectile();
+	/// <summary>
+	/// The multiball power-up, adds copies of every ball in play that fan out at the same angles the paddle's
+	/// hit zones bounce balls at
+	/// </summary>
+	/// <param name="copies">The number of copies to add for each ball</param>
+	/// <returns>The number of balls that were added, which is less than asked for if the pool fills up</returns>
+	uint32_t SpawnMultiball(uint32_t copies);
+
+	/// <summary>
+	/// Finds the live bricks that a ball is touching
+	/// </summary>
+	/// <param name="ball">The ball to test</param>
+	/// <param name="outBricks">Will be replaced with the indices of the bricks, in increasing order</param>
+	void FindOverlaps(const Ball& ball, std::vector<uint32_t>& outBricks);
+
+	/// <summary>
+	/// Advances the game by a single step
+	/// </summary>
+	/// <param name="input">The player's input for this step</param>
+	void Step(const SimInput& input);
+
+	/// <summary>
+	/// Gets a copy of a ball. The first ball is the one the player starts with, until it's lost
+	/// </summary>
+	Ball GetBall(uint32_t index = 0) const { return _balls.Get(index); }
+	const BallPool& GetBalls() const { return _balls; }
+	const glm::vec2& GetPaddlePosition() const { return _paddle; }
+	const std::vector<Brick>& GetBricks() const { return _bricks; }
+	// The number of bricks that have been broken, the game is won once it reaches GetBreakableBricks
+	uint32_t GetBricksHit() const { return _bricksHit; }
+	uint32_t GetBreakableBricks() const { return _breakableBricks; }
+	SimState GetState() const { return _state; }
+	uint64_t GetStepCount() const { return _stepCount; }
+
+	/// <summary>
+	/// Hashes the exact bits of everything that can change while playing, so two runs can be checked to see if
+	/// they ended up in exactly the same state
+	/// </summary>
+	uint64_t ComputeChecksum() const;
+
+protected:
+	Playfield             _playfield;
+	// How many base ticks each step covers
+	float                 _stepScale;
+	BallPool              _balls;
+	// Base ticks until the paddle can fire again
+	float                 _fireCooldown;
+	glm::vec2             _paddle;
+	std::vector<Brick>    _bricks;
+	uint32_t              _bricksHit;
+	uint32_t              _breakableBricks;
+	SimState              _state;
+	uint64_t              _stepCount;
+
+	// The broadphase for the bricks, rebuilt when bricks are added. Bricks that are hit stay in the grid, and
+	// get skipped by FindOverlaps instead
+	CollisionGrid         _grid;
+	bool                  _isGridDirty;
+	std::vector<uint32_t> _candidates;
+	// The circle bricks from the broadphase, copied into structure-of-arrays for CollisionKernels
+	std::vector<float>    _circleX;
+	std::vector<float>    _circleY;
+	std::vector<float>    _circleRadius;
+	std::vector<uint32_t> _circleIds;
+
+	void _RebuildGrid();
+	// Finds the bricks near an area, copying the live circle bricks into the structure-of-arrays, and leaving
+	// the live box bricks in _candidates
+	void _GatherCandidates(const glm::vec2& min, const glm::vec2& max);
+	// Moves a ball for one step, bouncing off the walls, bricks and paddle along the way. Returns false if the
+	// ball was a projectile that hit something, and should be despawned
+	bool _Move(Ball& ball);
+	// Changes a ball's direction and speed after it hit a brick
+	void _HitBrick(Ball& ball, Brick& brick);
+	// Changes a ball's direction and speed based on where it hit the paddle
+	void _HitPaddle(Ball& ball);
+};
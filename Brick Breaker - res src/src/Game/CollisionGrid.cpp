@@ -0,0 +1,99 @@
+#include "Game/CollisionGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Logging.h>
+
+CollisionGrid::CollisionGrid() :
+	_cellSize(1.0f),
+	_bucketMask(0),
+	_items(std::vector<Item>()),
+	_bucketStarts(std::vector<uint32_t>()),
+	_references(std::vector<uint32_t>()),
+	_lastQuery(std::vector<uint32_t>()),
+	_queryCount(0) { }
+
+void CollisionGrid::Clear(float cellSize) {
+	LOG_ASSERT(cellSize > 0.0f, "Cell size must be greater than zero!");
+	_cellSize = cellSize;
+	_items.clear();
+	_bucketStarts.clear();
+	_references.clear();
+}
+
+void CollisionGrid::Insert(uint32_t id, const glm::vec2& min, const glm::vec2& max) {
+	Item item;
+	item.Id = id;
+	item.MinCell = _GetCell(min);
+	item.MaxCell = _GetCell(max);
+	_items.push_back(item);
+	if (id >= _lastQuery.size()) {
+		_lastQuery.resize(id + 1, 0);
+	}
+}
+
+void CollisionGrid::Build() {
+	// Use about 2 buckets per item, rounded up to a power of two so we can mask instead of using modulo
+	uint32_t bucketCount = 64;
+	while (bucketCount < _items.size() * 2) {
+		bucketCount <<= 1;
+	}
+	_bucketMask = bucketCount - 1;
+
+	// Count how many references land in each bucket, then turn the counts into start offsets
+	_bucketStarts.assign(bucketCount + 1, 0);
+	for (const Item& item : _items) {
+		for (int y = item.MinCell.y; y <= item.MaxCell.y; y++) {
+			for (int x = item.MinCell.x; x <= item.MaxCell.x; x++) {
+				_bucketStarts[_GetBucket(x, y) + 1]++;
+			}
+		}
+	}
+	for (uint32_t ix = 0; ix < bucketCount; ix++) {
+		_bucketStarts[ix + 1] += _bucketStarts[ix];
+	}
+
+	_references.resize(_bucketStarts[bucketCount]);
+	std::vector<uint32_t> cursor(_bucketStarts.begin(), _bucketStarts.end() - 1);
+	for (const Item& item : _items) {
+		for (int y = item.MinCell.y; y <= item.MaxCell.y; y++) {
+			for (int x = item.MinCell.x; x <= item.MaxCell.x; x++) {
+				_references[cursor[_GetBucket(x, y)]++] = item.Id;
+			}
+		}
+	}
+}
+
+void CollisionGrid::Query(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& outIds) {
+	if (_bucketStarts.empty()) {
+		return;
+	}
+	// When the counter wraps around, the old marks could match new queries
+	if (++_queryCount == 0) {
+		std::fill(_lastQuery.begin(), _lastQuery.end(), 0);
+		_queryCount = 1;
+	}
+
+	const glm::ivec2 minCell = _GetCell(min);
+	const glm::ivec2 maxCell = _GetCell(max);
+	for (int y = minCell.y; y <= maxCell.y; y++) {
+		for (int x = minCell.x; x <= maxCell.x; x++) {
+			const uint32_t bucket = _GetBucket(x, y);
+			for (uint32_t ix = _bucketStarts[bucket]; ix < _bucketStarts[bucket + 1]; ix++) {
+				const uint32_t id = _references[ix];
+				if (_lastQuery[id] != _queryCount) {
+					_lastQuery[id] = _queryCount;
+					outIds.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+glm::ivec2 CollisionGrid::_GetCell(const glm::vec2& position) const {
+	return glm::ivec2((int)std::floor(position.x / _cellSize), (int)std::floor(position.y / _cellSize));
+}
+
+uint32_t CollisionGrid::_GetBucket(int x, int y) const {
+	return (((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u)) & _bucketMask;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A uniform grid broadphase for 2D colliders. Space is split into square cells, and each item is stored in every
+/// cell that it's bounding box overlaps. Cells are hashed into a fixed number of buckets, so the grid doesn't need
+/// to know how big the world is ahead of time
+///
+/// Items are added with Insert, and Build packs them into one flat array sorted by bucket (a counting sort), so a
+/// query only reads a few small contiguous ranges instead of testing against every item
+/// </summary>
+class CollisionGrid
+{
+public:
+	CollisionGrid();
+	~CollisionGrid() = default;
+
+	/// <summary>
+	/// Removes all items, and sets the size of the cells for the next build
+	/// </summary>
+	/// <param name="cellSize">The width and height of each cell, works best at about the size of the largest item</param>
+	void Clear(float cellSize);
+	/// <summary>
+	/// Adds an item to the grid, it won't be found by queries until the next Build
+	/// </summary>
+	/// <param name="id">The ID to return from queries, must be unique and ideally small, since it indexes into an internal array</param>
+	/// <param name="min">The bottom left corner of the item's bounds</param>
+	/// <param name="max">The top right corner of the item's bounds</param>
+	void Insert(uint32_t id, const glm::vec2& min, const glm::vec2& max);
+	/// <summary>
+	/// Sorts the inserted items into their cells
+	/// </summary>
+	void Build();
+
+	/// <summary>
+	/// Finds all items whose cells overlap the given area. Results may include items that don't actually overlap
+	/// the area, so they still need a narrowphase test. Each item is reported once
+	/// </summary>
+	/// <param name="min">The bottom left corner of the area</param>
+	/// <param name="max">The top right corner of the area</param>
+	/// <param name="outIds">The vector to append the IDs of the items to</param>
+	void Query(const glm::vec2& min, const glm::vec2& max, std::vector<uint32_t>& outIds);
+
+	float GetCellSize() const { return _cellSize; }
+	size_t GetItemCount() const { return _items.size(); }
+	size_t GetBucketCount() const { return _bucketStarts.empty() ? 0 : _bucketStarts.size() - 1; }
+	/// <summary>
+	/// Gets the total number of times items are stored in the grid, which is more than the number of items when
+	/// they overlap several cells
+	/// </summary>
+	size_t GetReferenceCount() const { return _references.size(); }
+
+protected:
+	struct Item {
+		uint32_t   Id;
+		glm::ivec2 MinCell;
+		glm::ivec2 MaxCell;
+	};
+
+	float                 _cellSize;
+	uint32_t              _bucketMask;
+	std::vector<Item>     _items;
+	// The start of each bucket's range in _references, with an extra entry at the end
+	std::vector<uint32_t> _bucketStarts;
+	std::vector<uint32_t> _references;
+	// The query that last reported each ID, so items in several cells aren't reported twice
+	std::vector<uint32_t> _lastQuery;
+	uint32_t              _queryCount;
+
+	glm::ivec2 _GetCell(const glm::vec2& position) const;
+	uint32_t _GetBucket(int x, int y) const;
+};
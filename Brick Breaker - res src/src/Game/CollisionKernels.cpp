@@ -0,0 +1,310 @@
+// The scalar fallback has to match the SIMD paths bit for bit, so stop the compiler from fusing
+// multiplies and adds into FMA instructions, which round differently
+#if defined(__clang__)
+	#pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+	#pragma fp_contract(off)
+#elif defined(__GNUC__)
+	#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "Game/CollisionKernels.h"
+
+#include <cmath>
+#include <limits>
+#include <Logging.h>
+
+// SSE2 is part of the base x64 instruction set, so we can always use it there. MSVC lets us use AVX
+// intrinsics without compiling the whole project for AVX, so we check for it at runtime instead
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CK_HAS_SSE 1
+	#include <emmintrin.h>
+	#if defined(_MSC_VER) || defined(__AVX__)
+		#define CK_HAS_AVX 1
+		#include <immintrin.h>
+	#endif
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+bool CollisionKernels::_forceScalar = false;
+
+#pragma region Scalar
+
+static bool _OverlapScalar(float px, float py, float radius, float cx, float cy, float cr) {
+	const float dx = px - cx;
+	const float dy = py - cy;
+	const float hitDistance = cr + radius;
+	return dx * dx + dy * dy <= hitDistance * hitDistance;
+}
+
+static bool _SweepScalar(float px, float py, float vx, float vy, float radius, float cx, float cy, float cr, float maxTime, float& outTime) {
+	const float dx = px - cx;
+	const float dy = py - cy;
+	const float hitDistance = cr + radius;
+	const float c = (dx * dx + dy * dy) - hitDistance * hitDistance;
+	const float b = dx * vx + dy * vy;
+	if (b >= 0.0f) {
+		return false;
+	}
+	if (c <= 0.0f) {
+		outTime = 0.0f;
+		return true;
+	}
+	const float a = vx * vx + vy * vy;
+	const float discriminant = b * b - a * c;
+	if (discriminant < 0.0f) {
+		return false;
+	}
+	const float time = (-b - std::sqrt(discriminant)) / a;
+	if (time > maxTime) {
+		return false;
+	}
+	outTime = time;
+	return true;
+}
+
+static uint32_t _OverlapMaskScalar(const glm::vec2& position, float radius, const float* xs, const float* ys, const float* radii, uint32_t begin, uint32_t count) {
+	uint32_t mask = 0;
+	for (uint32_t ix = begin; ix < count; ix++) {
+		mask |= (uint32_t)_OverlapScalar(position.x, position.y, radius, xs[ix], ys[ix], radii[ix]) << ix;
+	}
+	return mask;
+}
+
+static int32_t _SweepEarliestScalar(const glm::vec2& start, const glm::vec2& velocity, float radius,
+									const float* xs, const float* ys, const float* radii, uint32_t begin, uint32_t count,
+									float maxTime, float& bestTime, int32_t best) {
+	for (uint32_t ix = begin; ix < count; ix++) {
+		float time;
+		if (_SweepScalar(start.x, start.y, velocity.x, velocity.y, radius, xs[ix], ys[ix], radii[ix], maxTime, time) && time < bestTime) {
+			bestTime = time;
+			best = static_cast<int32_t>(ix);
+		}
+	}
+	return best;
+}
+
+#pragma endregion
+
+#if CK_HAS_SSE
+
+#pragma region Lane Traits
+
+// The kernels are written once against these traits, and instantiated for each instruction set
+
+struct SseLanes {
+	typedef __m128 Type;
+	static const int Width = 4;
+
+	static Type Set(float value) { return _mm_set1_ps(value); }
+	static Type Load(const float* src) { return _mm_loadu_ps(src); }
+	static void Store(float* dest, Type value) { _mm_storeu_ps(dest, value); }
+	static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+	static Type Sqrt(Type value) { return _mm_sqrt_ps(value); }
+	static Type LessEqual(Type a, Type b) { return _mm_cmple_ps(a, b); }
+	static Type Less(Type a, Type b) { return _mm_cmplt_ps(a, b); }
+	static Type And(Type a, Type b) { return _mm_and_ps(a, b); }
+	static Type Or(Type a, Type b) { return _mm_or_ps(a, b); }
+	static Type Select(Type mask, Type a, Type b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static uint32_t Mask(Type value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+	static void Finish() { }
+};
+
+#if CK_HAS_AVX
+struct AvxLanes {
+	typedef __m256 Type;
+	static const int Width = 8;
+
+	static Type Set(float value) { return _mm256_set1_ps(value); }
+	static Type Load(const float* src) { return _mm256_loadu_ps(src); }
+	static void Store(float* dest, Type value) { _mm256_storeu_ps(dest, value); }
+	static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+	static Type Sqrt(Type value) { return _mm256_sqrt_ps(value); }
+	static Type LessEqual(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static Type Less(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static Type And(Type a, Type b) { return _mm256_and_ps(a, b); }
+	static Type Or(Type a, Type b) { return _mm256_or_ps(a, b); }
+	static Type Select(Type mask, Type a, Type b) { return _mm256_blendv_ps(b, a, mask); }
+	static uint32_t Mask(Type value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+	// Avoids the penalty for switching back to SSE code with the upper halves of the registers in use
+	static void Finish() { _mm256_zeroupper(); }
+};
+
+static bool _DetectAvx() {
+	#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx     = (info[2] & (1 << 28)) != 0;
+	// The OS also needs to be saving the upper halves of the YMM registers on context switches
+	return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+	#else
+	// We were compiled with AVX enabled, so the entire program already requires it
+	return true;
+	#endif
+}
+static const bool s_HasAvx = _DetectAvx();
+#endif
+
+#pragma endregion
+
+#pragma region Kernels
+
+template <typename Lanes>
+static uint32_t _OverlapMaskSimd(const glm::vec2& position, float radius, const float* xs, const float* ys, const float* radii, uint32_t count) {
+	typedef typename Lanes::Type V;
+	const V px = Lanes::Set(position.x);
+	const V py = Lanes::Set(position.y);
+	const V r = Lanes::Set(radius);
+
+	uint32_t mask = 0;
+	uint32_t ix = 0;
+	for (; ix + Lanes::Width <= count; ix += Lanes::Width) {
+		const V dx = Lanes::Sub(px, Lanes::Load(xs + ix));
+		const V dy = Lanes::Sub(py, Lanes::Load(ys + ix));
+		const V hitDistance = Lanes::Add(Lanes::Load(radii + ix), r);
+		const V distanceSq = Lanes::Add(Lanes::Mul(dx, dx), Lanes::Mul(dy, dy));
+		mask |= Lanes::Mask(Lanes::LessEqual(distanceSq, Lanes::Mul(hitDistance, hitDistance))) << ix;
+	}
+	Lanes::Finish();
+	return mask | _OverlapMaskScalar(position, radius, xs, ys, radii, ix, count);
+}
+
+template <typename Lanes>
+static int32_t _SweepEarliestSimd(const glm::vec2& start, const glm::vec2& velocity, float radius,
+								  const float* xs, const float* ys, const float* radii, uint32_t count,
+								  float maxTime, float& bestTime) {
+	typedef typename Lanes::Type V;
+	const V px = Lanes::Set(start.x);
+	const V py = Lanes::Set(start.y);
+	const V vx = Lanes::Set(velocity.x);
+	const V vy = Lanes::Set(velocity.y);
+	const V r = Lanes::Set(radius);
+	const V zero = Lanes::Set(0.0f);
+	const V limit = Lanes::Set(maxTime);
+	// The velocity is the same for every circle, so this only needs working out once
+	const V a = Lanes::Add(Lanes::Mul(vx, vx), Lanes::Mul(vy, vy));
+
+	alignas(32) float times[8];
+	int32_t best = -1;
+	uint32_t ix = 0;
+	for (; ix + Lanes::Width <= count; ix += Lanes::Width) {
+		const V dx = Lanes::Sub(px, Lanes::Load(xs + ix));
+		const V dy = Lanes::Sub(py, Lanes::Load(ys + ix));
+		const V hitDistance = Lanes::Add(Lanes::Load(radii + ix), r);
+		const V c = Lanes::Sub(Lanes::Add(Lanes::Mul(dx, dx), Lanes::Mul(dy, dy)), Lanes::Mul(hitDistance, hitDistance));
+		const V b = Lanes::Add(Lanes::Mul(dx, vx), Lanes::Mul(dy, vy));
+		const V discriminant = Lanes::Sub(Lanes::Mul(b, b), Lanes::Mul(a, c));
+		// Lanes that miss end up with NaNs here, but they get masked out below
+		const V time = Lanes::Div(Lanes::Sub(Lanes::Sub(zero, b), Lanes::Sqrt(discriminant)), a);
+
+		// Circles the ball is already touching only count if it's moving towards them
+		const V towards = Lanes::Less(b, zero);
+		const V overlapping = Lanes::And(towards, Lanes::LessEqual(c, zero));
+		const V approaching = Lanes::And(towards, Lanes::LessEqual(zero, discriminant));
+		const V hit = Lanes::Or(overlapping, Lanes::And(approaching, Lanes::LessEqual(time, limit)));
+		uint32_t mask = Lanes::Mask(hit);
+		if (mask == 0) {
+			continue;
+		}
+
+		// Hits are rare, so finding the earliest lane in scalar code is cheaper than reducing across the register
+		Lanes::Store(times, Lanes::Select(overlapping, zero, time));
+		for (int lane = 0; lane < Lanes::Width; lane++, mask >>= 1) {
+			if ((mask & 1) && times[lane] < bestTime) {
+				bestTime = times[lane];
+				best = static_cast<int32_t>(ix + lane);
+			}
+		}
+	}
+	Lanes::Finish();
+	return _SweepEarliestScalar(start, velocity, radius, xs, ys, radii, ix, count, maxTime, bestTime, best);
+}
+
+#pragma endregion
+
+#endif
+
+uint32_t CollisionKernels::OverlapMask(const glm::vec2& position, float radius,
+									   const float* centersX, const float* centersY, const float* radii, uint32_t count) {
+	LOG_ASSERT(count <= MAX_MASK_COUNT, "Can only test up to {} circles at once, got {}", MAX_MASK_COUNT, count);
+	#if CK_HAS_SSE
+	if (!_forceScalar) {
+		#if CK_HAS_AVX
+		if (s_HasAvx) {
+			return _OverlapMaskSimd<AvxLanes>(position, radius, centersX, centersY, radii, count);
+		}
+		#endif
+		return _OverlapMaskSimd<SseLanes>(position, radius, centersX, centersY, radii, count);
+	}
+	#endif
+	return _OverlapMaskScalar(position, radius, centersX, centersY, radii, 0, count);
+}
+
+int32_t CollisionKernels::SweepEarliest(const glm::vec2& start, const glm::vec2& velocity, float radius,
+										const float* centersX, const float* centersY, const float* radii, uint32_t count,
+										float maxTime, float& outTime) {
+	float bestTime = std::numeric_limits<float>::infinity();
+	int32_t best = -1;
+	#if CK_HAS_SSE
+	if (!_forceScalar) {
+		#if CK_HAS_AVX
+		if (s_HasAvx) {
+			best = _SweepEarliestSimd<AvxLanes>(start, velocity, radius, centersX, centersY, radii, count, maxTime, bestTime);
+		}
+		else
+		#endif
+		{
+			best = _SweepEarliestSimd<SseLanes>(start, velocity, radius, centersX, centersY, radii, count, maxTime, bestTime);
+		}
+	}
+	else
+	#endif
+	{
+		best = _SweepEarliestScalar(start, velocity, radius, centersX, centersY, radii, 0, count, maxTime, bestTime, -1);
+	}
+	if (best >= 0) {
+		outTime = bestTime;
+	}
+	return best;
+}
+
+const char* CollisionKernels::GetInstructionSet() {
+	if (_forceScalar) {
+		return "Scalar";
+	}
+	#if CK_HAS_AVX
+	if (s_HasAvx) {
+		return "AVX";
+	}
+	#endif
+	#if CK_HAS_SSE
+	return "SSE2";
+	#else
+	return "Scalar";
+	#endif
+}
+
+uint32_t CollisionKernels::GetLaneCount() {
+	if (_forceScalar) {
+		return 1;
+	}
+	#if CK_HAS_AVX
+	if (s_HasAvx) {
+		return AvxLanes::Width;
+	}
+	#endif
+	#if CK_HAS_SSE
+	return SseLanes::Width;
+	#else
+	return 1;
+	#endif
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Batched narrowphase tests of one ball against many circles, with the circles stored as structure-of-arrays
+/// (separate arrays of X, Y and radius) so a whole register of circles can be loaded at once
+///
+/// On x86 the circles are tested 8 at a time with AVX when the CPU supports it, or 4 at a time with SSE
+/// otherwise. Other platforms fall back to a scalar implementation. Every path does the same operations in the
+/// same order as BrickBreakerSim::Overlaps and BrickBreakerSim::SweepCircle, so they all give exactly the same results
+/// </summary>
+class CollisionKernels {
+public:
+	CollisionKernels() = delete;
+
+	/// <summary>
+	/// The most circles that OverlapMask can test in one call
+	/// </summary>
+	static constexpr uint32_t MAX_MASK_COUNT = 32;
+
+	/// <summary>
+	/// Tests which circles a ball is touching
+	/// </summary>
+	/// <param name="position">The center of the ball</param>
+	/// <param name="radius">The radius of the ball</param>
+	/// <param name="centersX">The X coordinates of the circles' centers</param>
+	/// <param name="centersY">The Y coordinates of the circles' centers</param>
+	/// <param name="radii">The radii of the circles</param>
+	/// <param name="count">The number of circles, up to MAX_MASK_COUNT</param>
+	/// <returns>A mask with bit N set if the ball is touching circle N</returns>
+	static uint32_t OverlapMask(const glm::vec2& position, float radius,
+								const float* centersX, const float* centersY, const float* radii, uint32_t count);
+
+	/// <summary>
+	/// Finds the first circle that a moving ball touches
+	/// </summary>
+	/// <param name="start">The center of the ball at time 0</param>
+	/// <param name="velocity">How far the ball moves per unit of time</param>
+	/// <param name="radius">The radius of the ball</param>
+	/// <param name="centersX">The X coordinates of the circles' centers</param>
+	/// <param name="centersY">The Y coordinates of the circles' centers</param>
+	/// <param name="radii">The radii of the circles</param>
+	/// <param name="count">The number of circles</param>
+	/// <param name="maxTime">The latest time to report a hit at</param>
+	/// <param name="outTime">Receives the time of impact, or 0 if the ball already overlaps the circle and is moving closer</param>
+	/// <returns>The index of the first circle hit, the lowest index if several are hit at the same time, or -1 if none are hit</returns>
+	static int32_t SweepEarliest(const glm::vec2& start, const glm::vec2& velocity, float radius,
+								 const float* centersX, const float* centersY, const float* radii, uint32_t count,
+								 float maxTime, float& outTime);
+
+	/// <summary>
+	/// Gets the name of the instruction set the kernels will use on this machine (ex: "AVX", "SSE2", "Scalar")
+	/// </summary>
+	static const char* GetInstructionSet();
+	/// <summary>
+	/// Gets the number of circles tested per instruction on this machine
+	/// </summary>
+	static uint32_t GetLaneCount();
+
+	/// <summary>
+	/// Forces the kernels to use the scalar fallback, for comparing results and performance against the SIMD paths
+	/// </summary>
+	static void SetForceScalar(bool value) { _forceScalar = value; }
+
+protected:
+	static bool _forceScalar;
+};
@@ -0,0 +1,868 @@
+#include "Game/HeadlessRunner.h"
+#include "Game/CollisionKernels.h"
+#include "Game/InputLog.h"
+#include "Game/Level.h"
+#include "Game/ParticleSim.h"
+
+#include "Scene/TransformStore.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/TransformKernels.h"
+
+#include <Logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/common.hpp> // for fmod (floating modulus)
+
+namespace {
+	// FNV-1a, mixed in one float at a time so the checksum depends on the exact bits of the state
+	void __HashFloat(uint64_t& hash, float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		for (int ix = 0; ix < 4; ix++) {
+			hash ^= (bits >> (ix * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	}
+
+	// Moves the paddle to stay under the ball, with a bit of slack so it doesn't jitter back and forth. The ball
+	// would just bounce straight up and down if it always hit the middle, so the paddle lines up to bounce the
+	// ball towards the first brick that's left to break
+	SimInput __FollowBall(const BrickBreakerSim& sim) {
+		float target = 0.0f;
+		for (const BrickBreakerSim::Brick& brick : sim.GetBricks()) {
+			if (brick.IsAlive && brick.HitPoints > 0) {
+				target = brick.Position.x;
+				break;
+			}
+		}
+		// Hitting the right side of the paddle bounces the ball right, and the left side bounces it left
+		const float aim = target < sim.GetBall().Position.x ? 0.6f : -0.6f;
+		const float offset = sim.GetBall().Position.x + aim - sim.GetPaddlePosition().x;
+		const float slack = 0.5f * BrickBreakerSim::PADDLE_SPEED * BrickBreakerSim::BASE_TICK_RATE / sim.GetTickRate();
+		return SimInput(offset < -slack, offset > slack);
+	}
+
+	// Loads the level from the options, returning false if one was asked for but couldn't be loaded
+	bool __LoadLevel(const HeadlessRunner::Options& options, Level::Sptr& outLevel) {
+		outLevel = options.LevelPath.empty() ? nullptr : Level::LoadFromFile(options.LevelPath);
+		if (!options.LevelPath.empty() && outLevel == nullptr) {
+			LOG_ERROR("Failed to load level \"{}\"", options.LevelPath);
+			return false;
+		}
+		return true;
+	}
+
+	// Starts a new game on the level, or on the default level if there isn't one
+	void __StartGame(BrickBreakerSim& sim, const Level::Sptr& level) {
+		if (level != nullptr) {
+			level->Apply(sim);
+		}
+		else {
+			sim.LoadDefaultLevel();
+		}
+	}
+
+	// Gets the input for a step from the input mode in the options
+	SimInput __SampleInput(const HeadlessRunner::Options& options, const BrickBreakerSim& sim, uint64_t tick, std::mt19937& random, SimInput& randomInput) {
+		switch (options.Input) {
+			case HeadlessRunner::InputMode::Follow:
+				return __FollowBall(sim);
+			case HeadlessRunner::InputMode::Random:
+				// Hold each random input for a few steps, like a player would
+				if ((tick & 15) == 0) {
+					const uint32_t keys = random() % 3;
+					randomInput = SimInput(keys == 1, keys == 2);
+				}
+				return randomInput;
+			case HeadlessRunner::InputMode::None:
+			default:
+				return SimInput();
+		}
+	}
+}
+
+bool HeadlessRunner::IsRequested(int argc, char** argv) {
+	for (int ix = 1; ix < argc; ix++) {
+		if (strcmp(argv[ix], "--headless") == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+HeadlessRunner::Options HeadlessRunner::ParseArgs(int argc, char** argv) {
+	Options result;
+	for (int ix = 1; ix < argc; ix++) {
+		const bool hasValue = ix + 1 < argc;
+		if (strcmp(argv[ix], "--ticks") == 0 && hasValue) {
+			result.Ticks = std::strtoull(argv[++ix], nullptr, 10);
+		}
+		else if (strcmp(argv[ix], "--seed") == 0 && hasValue) {
+			result.Seed = static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10));
+		}
+		else if (strcmp(argv[ix], "--tick-rate") == 0 && hasValue) {
+			result.TickRate = std::strtof(argv[++ix], nullptr);
+			if (result.TickRate <= 0.0f) {
+				LOG_WARN("Tick rate must be greater than zero, using {}", BrickBreakerSim::BASE_TICK_RATE);
+				result.TickRate = BrickBreakerSim::BASE_TICK_RATE;
+			}
+		}
+		else if (strcmp(argv[ix], "--benchmark") == 0 && hasValue) {
+			result.Benchmark = argv[++ix];
+		}
+		else if (strcmp(argv[ix], "--check") == 0 && hasValue) {
+			result.Check = argv[++ix];
+		}
+		else if (strcmp(argv[ix], "--bricks") == 0 && hasValue) {
+			result.Bricks = static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10));
+		}
+		else if (strcmp(argv[ix], "--balls") == 0 && hasValue) {
+			result.Balls = static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10));
+		}
+		else if (strcmp(argv[ix], "--steps") == 0 && hasValue) {
+			result.Steps = static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10));
+		}
+		else if (strcmp(argv[ix], "--particles") == 0 && hasValue) {
+			result.Particles = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10)));
+		}
+		else if (strcmp(argv[ix], "--objects") == 0 && hasValue) {
+			result.Objects = std::max(1u, static_cast<uint32_t>(std::strtoul(argv[++ix], nullptr, 10)));
+		}
+		else if (strcmp(argv[ix], "--record") == 0 && hasValue) {
+			result.RecordPath = argv[++ix];
+		}
+		else if (strcmp(argv[ix], "--replay") == 0 && hasValue) {
+			result.ReplayPath = argv[++ix];
+		}
+		else if (strcmp(argv[ix], "--level") == 0 && hasValue) {
+			result.LevelPath = argv[++ix];
+		}
+		else if (strcmp(argv[ix], "--input") == 0 && hasValue) {
+			const char* mode = argv[++ix];
+			if (strcmp(mode, "none") == 0) {
+				result.Input = InputMode::None;
+			}
+			else if (strcmp(mode, "follow") == 0) {
+				result.Input = InputMode::Follow;
+			}
+			else if (strcmp(mode, "random") == 0) {
+				result.Input = InputMode::Random;
+			}
+			else {
+				LOG_WARN("Unknown input mode \"{}\", using follow", mode);
+			}
+		}
+	}
+	return result;
+}
+
+HeadlessRunner::Results HeadlessRunner::Run(const Options& options) {
+	Results result;
+	memset(&result, 0, sizeof(Results));
+	result.Checksum = 14695981039346656037ull;
+
+	std::mt19937 random(options.Seed);
+	SimInput randomInput;
+
+	// Main makes sure the level loads before we get here, so a level that fails now just falls back to the default
+	Level::Sptr level;
+	__LoadLevel(options, level);
+	BrickBreakerSim sim;
+	sim.SetTickRate(options.TickRate);
+	__StartGame(sim, level);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint64_t tick = 0; tick < options.Ticks; tick++) {
+		sim.Step(__SampleInput(options, sim, tick, random, randomInput));
+
+		if (sim.GetState() != SimState::Playing) {
+			result.Games++;
+			result.Wins += sim.GetState() == SimState::Won;
+			result.Losses += sim.GetState() == SimState::Lost;
+			result.BricksHit += sim.GetBricksHit();
+			__HashFloat(result.Checksum, sim.GetBall().Position.x);
+			__HashFloat(result.Checksum, sim.GetBall().Position.y);
+			__HashFloat(result.Checksum, sim.GetPaddlePosition().x);
+			__StartGame(sim, level);
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	result.Ticks = options.Ticks;
+	result.Seconds = std::chrono::duration<double>(end - start).count();
+	// Include the game that was still running, so runs that never finish a game still get a useful checksum
+	__HashFloat(result.Checksum, sim.GetBall().Position.x);
+	__HashFloat(result.Checksum, sim.GetBall().Position.y);
+	__HashFloat(result.Checksum, sim.GetPaddlePosition().x);
+	return result;
+}
+
+void HeadlessRunner::BuildStressLevel(BrickBreakerSim& sim, uint32_t brickCount, uint32_t ballCount, uint32_t seed) {
+	// Bricks are laid out on a grid 2 units apart, about twice as wide as it is tall
+	const uint32_t columns = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(2.0 * brickCount))));
+	const uint32_t rows = (brickCount + columns - 1) / columns;
+	const float halfWidth = static_cast<float>(columns);
+
+	BrickBreakerSim::Playfield playfield;
+	playfield.WallX = halfWidth + 1.0f;
+	playfield.WallTop = -2.0f * rows - 2.0f;
+	playfield.LoseY = halfWidth * 0.5f + 4.0f;
+	playfield.PaddleHitY = playfield.LoseY - 0.64f;
+	playfield.PaddleLimitX = halfWidth;
+	sim.SetPlayfield(playfield);
+	if (sim.GetBalls().GetCapacity() < ballCount) {
+		sim.SetBallCapacity(ballCount);
+	}
+	sim.Reset(glm::vec2(0.0f, 1.0f), glm::vec2(0.0f, playfield.LoseY - 0.2f));
+
+	// Alternate between the two shapes so both narrowphase paths get exercised
+	for (uint32_t ix = 0; ix < brickCount; ix++) {
+		const glm::vec2 position = glm::vec2(-halfWidth + 1.0f + 2.0f * (ix % columns), -2.0f * (ix / columns) - 2.0f);
+		if (ix % 2 == 0) {
+			sim.AddBrick(position);
+		}
+		else {
+			sim.AddBoxBrick(position, glm::vec2(0.8f, 0.4f));
+		}
+	}
+
+	// The balls start inside the brick field, so every step has them hitting bricks rather than flying towards them
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const float fieldTop = playfield.WallTop + 1.0f;
+	const float fieldBottom = -1.0f;
+	for (uint32_t ix = 1; ix < ballCount; ix++) {
+		const glm::vec2 position = glm::vec2((unit(random) * 2.0f - 1.0f) * halfWidth, fieldTop + unit(random) * (fieldBottom - fieldTop));
+		const glm::vec2 direction = glm::vec2(unit(random) < 0.5f ? -1.0f : 1.0f, unit(random) < 0.5f ? -1.0f : 1.0f);
+		sim.AddBall(position, direction, glm::vec2(0.02f + unit(random) * 0.04f));
+	}
+}
+
+int HeadlessRunner::RunBroadphaseBenchmark(const Options& options) {
+	BrickBreakerSim sim;
+	auto start = std::chrono::high_resolution_clock::now();
+	BuildStressLevel(sim, options.Bricks, options.Balls, options.Seed);
+	// The grid gets built on the first query, so do one up front to time it on it's own
+	std::vector<uint32_t> overlaps;
+	sim.FindOverlaps(sim.GetBall(), overlaps);
+	auto built = std::chrono::high_resolution_clock::now();
+
+	// Every ball does a broadphase query each step, and the ones that land on a brick run the narrowphase against it
+	double totalStep = 0.0, maxStep = 0.0;
+	uint64_t totalBalls = 0;
+	uint32_t steps = 0, slowSteps = 0;
+	for (; steps < options.Steps && sim.GetState() == SimState::Playing; steps++) {
+		totalBalls += sim.GetBalls().GetCount();
+		auto stepStart = std::chrono::high_resolution_clock::now();
+		sim.Step(SimInput());
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - stepStart).count();
+		totalStep += seconds;
+		maxStep = std::max(maxStep, seconds);
+		slowSteps += seconds >= 0.001;
+	}
+
+	// Compare a single pass of finding every overlap through the grid with testing every pair, with the same number
+	// of balls scattered over the whole brick field
+	const std::vector<BrickBreakerSim::Brick>& bricks = sim.GetBricks();
+	const BrickBreakerSim::Playfield& playfield = sim.GetPlayfield();
+	std::vector<BrickBreakerSim::Ball> probes(sim.GetBalls().GetCount(), sim.GetBall());
+	std::mt19937 random(options.Seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for (BrickBreakerSim::Ball& probe : probes) {
+		probe.Position = glm::vec2((unit(random) * 2.0f - 1.0f) * playfield.WallX, unit(random) * playfield.WallTop);
+	}
+
+	uint64_t gridHits = 0, bruteHits = 0;
+	auto gridStart = std::chrono::high_resolution_clock::now();
+	for (const BrickBreakerSim::Ball& ball : probes) {
+		sim.FindOverlaps(ball, overlaps);
+		gridHits += overlaps.size();
+	}
+	auto bruteStart = std::chrono::high_resolution_clock::now();
+	for (const BrickBreakerSim::Ball& ball : probes) {
+		for (const BrickBreakerSim::Brick& brick : bricks) {
+			bruteHits += brick.IsAlive && BrickBreakerSim::Overlaps(ball, brick);
+		}
+	}
+	auto bruteEnd = std::chrono::high_resolution_clock::now();
+
+	const double gridSeconds = std::chrono::duration<double>(bruteStart - gridStart).count();
+	const double bruteSeconds = std::chrono::duration<double>(bruteEnd - bruteStart).count();
+	LOG_INFO("==== Broadphase Benchmark ====");
+	LOG_INFO("\tBricks:          {} ({} hit, {:.1f} per step)", bricks.size(), sim.GetBricksHit(), steps > 0 ? (double)sim.GetBricksHit() / steps : 0.0);
+	LOG_INFO("\tBalls:           {} ({:.0f} queries per step)", sim.GetBalls().GetCount(), steps > 0 ? (double)totalBalls / steps : 0.0);
+	LOG_INFO("\tBuild:           {:.3f} ms", std::chrono::duration<double>(built - start).count() * 1000.0);
+	LOG_INFO("\tStep (avg/max):  {:.4f} / {:.4f} ms over {} steps, {} took 1 ms or more", steps > 0 ? totalStep * 1000.0 / steps : 0.0, maxStep * 1000.0, steps, slowSteps);
+	LOG_INFO("\tOverlaps (grid): {:.4f} ms ({} found)", gridSeconds * 1000.0, gridHits);
+	LOG_INFO("\tOverlaps (all):  {:.4f} ms ({} found)", bruteSeconds * 1000.0, bruteHits);
+	// This is the only thing checking the grid against the real answer, so it needs to fail release builds too
+	if (gridHits != bruteHits) {
+		LOG_ERROR("FAILED: the broadphase found {} overlaps, but testing every pair found {}", gridHits, bruteHits);
+		return 1;
+	}
+	return 0;
+}
+
+int HeadlessRunner::RunBallBenchmark(const Options& options) {
+	BrickBreakerSim sim;
+	sim.SetBallCapacity(std::max(options.Balls, 1u));
+	BuildStressLevel(sim, options.Bricks, 1, options.Seed);
+
+	// Nothing should allocate once the pool is set up, so it's arrays should never move. Balls only fill half
+	// the pool, so there's room for the projectiles
+	const glm::vec2* positions = sim.GetBalls().GetPositions();
+	uint64_t spawned = sim.SpawnMultiball(options.Balls / 2), totalBalls = 0;
+	double totalStep = 0.0, maxStep = 0.0;
+	uint32_t steps = 0;
+	for (; steps < options.Steps && sim.GetState() == SimState::Playing; steps++) {
+		auto stepStart = std::chrono::high_resolution_clock::now();
+		// Keep firing, and split the balls again whenever enough are lost, to keep balls coming and going
+		sim.Step(SimInput(static_cast<uint8_t>(SimKey::Fire)));
+		if (sim.GetBalls().GetCount() < options.Balls / 4) {
+			spawned += sim.SpawnMultiball(1);
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - stepStart).count();
+		totalStep += seconds;
+		maxStep = std::max(maxStep, seconds);
+		totalBalls += sim.GetBalls().GetCount();
+	}
+
+	LOG_INFO("==== Ball Pool Benchmark ====");
+	LOG_INFO("\tCapacity:       {}", sim.GetBalls().GetCapacity());
+	LOG_INFO("\tBalls (avg):    {:.0f} in play, {} spawned", steps > 0 ? (double)totalBalls / steps : 0.0, spawned);
+	LOG_INFO("\tBricks hit:     {} / {}", sim.GetBricksHit(), sim.GetBricks().size());
+	LOG_INFO("\tStep (avg/max): {:.4f} / {:.4f} ms over {} steps", steps > 0 ? totalStep * 1000.0 / steps : 0.0, maxStep * 1000.0, steps);
+	// The pool promises not to allocate after SetCapacity, so moving arrays fail the run in release builds too
+	if (positions != sim.GetBalls().GetPositions()) {
+		LOG_ERROR("FAILED: the ball pool was reallocated while playing");
+		return 1;
+	}
+	return 0;
+}
+
+int HeadlessRunner::RunParticleBenchmark(const Options& options) {
+	ParticleSim sim(options.Particles);
+	const ParticleSettings settings;
+	const float deltaTime = 1.0f / BrickBreakerSim::BASE_TICK_RATE;
+
+	// A handful of bricks breaking at once, filling the whole buffer between them
+	const uint32_t emitterCount = 8;
+	ParticleEmitter emitter;
+	emitter.Life = 1.5f;
+	uint32_t emitted = 0;
+	for (uint32_t ix = 0; ix < emitterCount; ix++) {
+		emitter.Position = glm::vec3(ix * 2.0f - 7.0f, -3.0f, 0.0f);
+		emitter.Count = options.Particles / emitterCount + (ix < options.Particles % emitterCount);
+		emitter.Seed = options.Seed + ix;
+		sim.Emit(emitter);
+		emitted += emitter.Count;
+	}
+
+	// The longest a particle can live, plus the update that spawns them
+	const uint32_t maxSteps = static_cast<uint32_t>(std::ceil(emitter.Life * 1.25f / deltaTime)) + 2;
+	double totalUpdate = 0.0;
+	uint32_t steps = 0, spawned = 0;
+	for (; steps < maxSteps; steps++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		sim.Update(deltaTime, settings);
+		totalUpdate += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		if (steps == 0) {
+			spawned = sim.CountAlive();
+		}
+	}
+	const uint32_t alive = sim.CountAlive();
+
+	LOG_INFO("==== Particle Benchmark (CPU reference) ====");
+	LOG_INFO("\tParticles:      {}", emitted);
+	LOG_INFO("\tUpdates:        {} until all died", steps);
+	LOG_INFO("\tUpdate (avg):   {:.4f} ms", totalUpdate * 1000.0 / steps);
+	LOG_INFO("\tThroughput:     {:.1f} M particles/s per core", (double)options.Particles * steps / totalUpdate / 1e6);
+
+	// Dropped or immortal particles would make the timings meaningless, so they fail release builds too
+	bool passed = true;
+	if (spawned != emitted) {
+		LOG_ERROR("FAILED: only {} of {} particles were spawned", spawned, emitted);
+		passed = false;
+	}
+	if (alive != 0) {
+		LOG_ERROR("FAILED: {} particles outlived their lifetime", alive);
+		passed = false;
+	}
+	return passed ? 0 : 1;
+}
+
+int HeadlessRunner::RunLevelBenchmark(const Options& options) {
+	// The same layout as the stress level, as a grid of circles and unbreakable boxes 2 units apart
+	const uint32_t brickCount = std::max(options.Bricks, 1u);
+	const uint32_t columns = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(2.0 * brickCount))));
+	const uint32_t rows = (brickCount + columns - 1) / columns;
+	const float halfWidth = static_cast<float>(columns);
+
+	nlohmann::json grid;
+	grid["name"] = "Benchmark";
+	grid["playfield"] = {
+		{ "wall_x", halfWidth + 1.0f },
+		{ "wall_top", -2.0f * rows - 2.0f },
+		{ "paddle_hit_y", halfWidth * 0.5f + 4.0f - 0.64f },
+		{ "lose_y", halfWidth * 0.5f + 4.0f },
+		{ "paddle_limit_x", halfWidth }
+	};
+	grid["ball"] = GlmToJson(glm::vec2(0.0f, 1.0f));
+	grid["paddle"] = GlmToJson(glm::vec2(0.0f, halfWidth * 0.5f + 3.8f));
+	grid["types"] = {
+		{ "o", { { "shape", "circle" }, { "radius", BrickBreakerSim::BRICK_RADIUS }, { "hp", 1 } } },
+		{ "#", { { "shape", "box" }, { "half_extents", GlmToJson(glm::vec2(0.8f, 0.4f)) }, { "hp", 0 } } }
+	};
+	nlohmann::json list = grid;
+	nlohmann::json compact = grid;
+
+	std::vector<std::string> gridRows(rows, std::string(columns, '.'));
+	std::vector<nlohmann::json> listBricks, compactBricks;
+	listBricks.reserve(brickCount);
+	compactBricks.reserve(brickCount);
+	for (uint32_t ix = 0; ix < brickCount; ix++) {
+		const char type = ix % 2 == 0 ? 'o' : '#';
+		const float x = -halfWidth + 1.0f + 2.0f * (ix % columns);
+		const float y = -2.0f * (ix / columns) - 2.0f;
+		gridRows[rows - 1 - ix / columns][ix % columns] = type;
+		listBricks.push_back({ { "type", std::string(1, type) }, { "x", x }, { "y", y } });
+		compactBricks.push_back(nlohmann::json::array({ std::string(1, type), x, y }));
+	}
+	grid["grid"] = { { "origin", GlmToJson(glm::vec2(-halfWidth + 1.0f, -2.0f * rows)) }, { "spacing", GlmToJson(glm::vec2(2.0f)) }, { "rows", gridRows } };
+	list["bricks"] = listBricks;
+	compact["bricks"] = compactBricks;
+
+	// Times going from the text of a level to a game that's ready to play, including building the broadphase.
+	// The text is already in memory, so this doesn't depend on how fast the disk is
+	struct Timings {
+		size_t Bytes;
+		bool   Passed;
+		double Load, Apply, Grid, Total, Max;
+	};
+	auto timeLoading = [&](const char* name, const nlohmann::json& level) {
+		const std::string text = level.dump();
+		Timings result = { text.size(), true, 0.0, 0.0, 0.0, 0.0, 0.0 };
+		BrickBreakerSim sim;
+		std::vector<uint32_t> overlaps;
+		const uint32_t runs = std::max(options.Steps, 1u);
+		for (uint32_t run = 0; run < runs; run++) {
+			std::istringstream stream(text);
+			auto start = std::chrono::high_resolution_clock::now();
+			Level::Sptr loaded = Level::FromStream(stream);
+			auto loadedTime = std::chrono::high_resolution_clock::now();
+			if (loaded == nullptr) {
+				LOG_ERROR("FAILED: the {} level didn't load", name);
+				result.Passed = false;
+				break;
+			}
+			loaded->Apply(sim);
+			auto appliedTime = std::chrono::high_resolution_clock::now();
+			// The grid gets built on the first query
+			sim.FindOverlaps(sim.GetBall(), overlaps);
+			auto end = std::chrono::high_resolution_clock::now();
+			if (sim.GetBricks().size() != brickCount) {
+				LOG_ERROR("FAILED: the {} level has {} bricks, expected {}", name, sim.GetBricks().size(), brickCount);
+				result.Passed = false;
+				break;
+			}
+
+			result.Load += std::chrono::duration<double>(loadedTime - start).count() / runs;
+			result.Apply += std::chrono::duration<double>(appliedTime - loadedTime).count() / runs;
+			result.Grid += std::chrono::duration<double>(end - appliedTime).count() / runs;
+			result.Total += std::chrono::duration<double>(end - start).count() / runs;
+			result.Max = std::max(result.Max, std::chrono::duration<double>(end - start).count());
+		}
+		return result;
+	};
+	const Timings gridTimings = timeLoading("grid", grid);
+	const Timings listTimings = timeLoading("list", list);
+	const Timings compactTimings = timeLoading("compact list", compact);
+
+	const double frameMs = 1000.0 / BrickBreakerSim::BASE_TICK_RATE;
+	LOG_INFO("==== Level Loading Benchmark ====");
+	LOG_INFO("\tBricks:            {} ({} breakable)", brickCount, (brickCount + 1) / 2);
+	for (const auto& [name, timings] : { std::make_pair("Grid", gridTimings), std::make_pair("List", listTimings), std::make_pair("Compact list", compactTimings) }) {
+		LOG_INFO("\t{} ({} KB):", name, timings.Bytes / 1024);
+		LOG_INFO("\t\tParse and build: {:.3f} ms", timings.Load * 1000.0);
+		LOG_INFO("\t\tApply:           {:.3f} ms", timings.Apply * 1000.0);
+		LOG_INFO("\t\tBroadphase:      {:.3f} ms", timings.Grid * 1000.0);
+		LOG_INFO("\t\tTotal (avg/max): {:.3f} / {:.3f} ms, {} a {:.1f} ms frame", timings.Total * 1000.0, timings.Max * 1000.0,
+			timings.Max * 1000.0 < frameMs ? "fits in" : "doesn't fit in", frameMs);
+	}
+	// A format that loads the wrong level has to fail the run in release builds, not just report fast timings
+	return gridTimings.Passed && listTimings.Passed && compactTimings.Passed ? 0 : 1;
+}
+
+int HeadlessRunner::RunTransformBenchmark(const Options& options) {
+	// The members RenderObject had before it's transform moved into the store, so the old path walks over the
+	// same amount of memory it used to
+	struct LegacyObject {
+		std::string       Name;
+		uint8_t           GUID[16];
+		glm::mat4         Transform;
+		void*             Mesh;
+		void*             Material;
+		std::vector<char> MeshBuilderParams;
+		glm::vec3         Position;
+		glm::vec3         Rotation;
+		glm::vec3         Scale;
+	};
+
+	std::mt19937 random(options.Seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto randomVec3 = [&](float min, float max) {
+		return glm::vec3(min + unit(random) * (max - min), min + unit(random) * (max - min), min + unit(random) * (max - min));
+	};
+
+	const uint32_t count = options.Objects;
+	std::vector<LegacyObject> objects(count);
+	TransformStore store;
+	store.Reserve(count);
+	for (uint32_t ix = 0; ix < count; ix++) {
+		const uint32_t index = store.Allocate();
+		objects[ix].Position = randomVec3(-50.0f, 50.0f);
+		objects[ix].Rotation = randomVec3(0.0f, 360.0f);
+		objects[ix].Scale = randomVec3(0.25f, 4.0f);
+		store.SetPosition(index, objects[ix].Position);
+		store.SetRotation(index, objects[ix].Rotation);
+		store.SetScale(index, objects[ix].Scale);
+	}
+	store.RecalcAll();
+
+	// About 1 in 100 objects move each frame, which is more than the game ever moves
+	const uint32_t movedCount = std::max(count / 100, 1u);
+	std::vector<uint32_t> moved(movedCount);
+
+	static const glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
+	const uint32_t runs = std::max(options.Steps, 1u);
+	double legacySeconds = 0.0, legacyNormalSeconds = 0.0, allSeconds = 0.0, dirtySeconds = 0.0;
+	float checksum = 0.0f;
+	for (uint32_t run = 0; run < runs; run++) {
+		// RenderObject::RecalcTransform, run on every object each frame
+		auto start = std::chrono::high_resolution_clock::now();
+		for (LegacyObject& object : objects) {
+			object.Rotation = glm::fmod(object.Rotation, glm::vec3(360.0f));
+			object.Transform = glm::translate(MAT4_IDENTITY, object.Position) * glm::mat4_cast(glm::quat(glm::radians(object.Rotation))) * glm::scale(MAT4_IDENTITY, object.Scale);
+		}
+		auto legacyEnd = std::chrono::high_resolution_clock::now();
+		// The normal matrix the render loop used to calculate for each object as it was drawn
+		for (const LegacyObject& object : objects) {
+			checksum += glm::mat3(glm::transpose(glm::inverse(object.Transform)))[1][1];
+		}
+		auto normalEnd = std::chrono::high_resolution_clock::now();
+		store.RecalcAll();
+		auto allEnd = std::chrono::high_resolution_clock::now();
+
+		for (uint32_t& index : moved) {
+			index = random() % count;
+			store.SetPosition(index, store.GetPosition(index) + glm::vec3(0.1f, 0.0f, 0.0f));
+		}
+		auto dirtyStart = std::chrono::high_resolution_clock::now();
+		store.RecalcDirty();
+		auto dirtyEnd = std::chrono::high_resolution_clock::now();
+
+		legacySeconds += std::chrono::duration<double>(legacyEnd - start).count() / runs;
+		legacyNormalSeconds += std::chrono::duration<double>(normalEnd - start).count() / runs;
+		allSeconds += std::chrono::duration<double>(allEnd - normalEnd).count() / runs;
+		dirtySeconds += std::chrono::duration<double>(dirtyEnd - dirtyStart).count() / runs;
+	}
+
+	LOG_INFO("==== Transform Benchmark ({}) ====", TransformKernels::GetInstructionSet());
+	LOG_INFO("\tObjects:                  {} ({} moved per frame)", count, movedCount);
+	LOG_INFO("\tRecalcTransform (glm):    {:.3f} ms", legacySeconds * 1000.0);
+	LOG_INFO("\t  with normal matrices:   {:.3f} ms", legacyNormalSeconds * 1000.0);
+	LOG_INFO("\tRecalcAll:                {:.3f} ms ({:.1f}x faster)", allSeconds * 1000.0, legacyNormalSeconds / allSeconds);
+	LOG_INFO("\tRecalcDirty:              {:.3f} ms ({} recalculated)", dirtySeconds * 1000.0, store.GetLastRecalcCount());
+	// Keeps the normal matrices from being optimized away
+	volatile float sink = checksum;
+	(void)sink;
+	return 0;
+}
+
+int HeadlessRunner::RunTransformCheck(const Options& options) {
+	std::mt19937 random(options.Seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto randomVec3 = [&](float min, float max) {
+		return glm::vec3(min + unit(random) * (max - min), min + unit(random) * (max - min), min + unit(random) * (max - min));
+	};
+
+	// Every 8th rotation is a multiple of 45 degrees, since those land right on the edges between the quadrants the
+	// SIMD sine and cosine pick their polynomials from. Scales include mirroring, as long as they aren't 0
+	const uint32_t count = options.Objects;
+	std::vector<glm::vec3> positions(count), rotations(count), scales(count);
+	for (uint32_t ix = 0; ix < count; ix++) {
+		positions[ix] = randomVec3(-50.0f, 50.0f);
+		rotations[ix] = ix % 8 == 0 ? glm::floor(randomVec3(-8.0f, 8.0f)) * 45.0f : randomVec3(-360.0f, 360.0f);
+		scales[ix] = randomVec3(0.25f, 4.0f) * glm::vec3(unit(random) < 0.1f ? -1.0f : 1.0f, 1.0f, 1.0f);
+	}
+	const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+		glm::lookAt(glm::vec3(0.0f, 20.0f, 80.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	// What RenderObject::RecalcTransform and the render loop used to calculate for each object
+	static const glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
+	std::vector<glm::mat4> expectedModels(count), expectedMVPs(count);
+	std::vector<glm::mat3> expectedNormals(count);
+	for (uint32_t ix = 0; ix < count; ix++) {
+		expectedModels[ix] = glm::translate(MAT4_IDENTITY, positions[ix]) * glm::mat4_cast(glm::quat(glm::radians(rotations[ix]))) * glm::scale(MAT4_IDENTITY, scales[ix]);
+		expectedNormals[ix] = glm::mat3(glm::transpose(glm::inverse(expectedModels[ix])));
+		expectedMVPs[ix] = viewProjection * expectedModels[ix];
+	}
+
+	// Relative error for big elements, so the perspective projection's large values get the same precision
+	auto error = [](float value, float expected) {
+		return std::abs(value - expected) / std::max(1.0f, std::abs(expected));
+	};
+
+	std::vector<glm::mat4> models(count), mvps(count);
+	std::vector<glm::mat3> normals(count);
+	std::vector<std::string> checked;
+	bool passed = true;
+	LOG_INFO("==== Transform Kernel Check ====");
+	LOG_INFO("\tObjects:   {}", count);
+	LOG_INFO("\tTolerance: {}", TRANSFORM_TOLERANCE);
+	for (const auto& [forceScalar, forceSse] : { std::make_pair(true, false), std::make_pair(false, true), std::make_pair(false, false) }) {
+		TransformKernels::SetForceScalar(forceScalar);
+		TransformKernels::SetForceSse(forceSse);
+		// Paths the CPU doesn't support fall back to the next best one, which has already been checked
+		const std::string name = TransformKernels::GetInstructionSet();
+		if (std::find(checked.begin(), checked.end(), name) != checked.end()) {
+			continue;
+		}
+		checked.push_back(name);
+
+		TransformKernels::ComputeModelMatrices(positions.data(), rotations.data(), scales.data(), nullptr, count, models.data(), normals.data());
+		TransformKernels::ComputeMVPs(viewProjection, models.data(), nullptr, count, mvps.data());
+
+		float modelError = 0.0f, normalError = 0.0f, mvpError = 0.0f;
+		uint32_t worst = 0;
+		for (uint32_t ix = 0; ix < count; ix++) {
+			float objectError = 0.0f;
+			for (int col = 0; col < 4; col++) {
+				for (int row = 0; row < 4; row++) {
+					modelError = std::max(modelError, error(models[ix][col][row], expectedModels[ix][col][row]));
+					mvpError = std::max(mvpError, error(mvps[ix][col][row], expectedMVPs[ix][col][row]));
+					if (col < 3 && row < 3) {
+						objectError = std::max(objectError, error(normals[ix][col][row], expectedNormals[ix][col][row]));
+					}
+				}
+			}
+			if (objectError > normalError) {
+				normalError = objectError;
+				worst = ix;
+			}
+		}
+
+		const bool pathPassed = modelError <= TRANSFORM_TOLERANCE && normalError <= TRANSFORM_TOLERANCE && mvpError <= TRANSFORM_TOLERANCE;
+		LOG_INFO("\t{}: {} (max error {:.2e} model, {:.2e} normal, {:.2e} MVP)", name, pathPassed ? "passed" : "FAILED", modelError, normalError, mvpError);
+		if (!pathPassed) {
+			LOG_ERROR("\t\tWorst normal matrix was object {}, rotation ({}, {}, {}), scale ({}, {}, {})", worst,
+				rotations[worst].x, rotations[worst].y, rotations[worst].z, scales[worst].x, scales[worst].y, scales[worst].z);
+		}
+		passed &= pathPassed;
+	}
+	TransformKernels::SetForceScalar(false);
+	TransformKernels::SetForceSse(false);
+	return passed ? 0 : 1;
+}
+
+int HeadlessRunner::RunNarrowphaseBenchmark(const Options& options) {
+	// Random circles the size of the default bricks, spread out so that only some of the tests hit
+	std::mt19937 random(options.Seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const uint32_t circleCount = std::max(options.Bricks, CollisionKernels::MAX_MASK_COUNT);
+	std::vector<float> xs(circleCount), ys(circleCount), radii(circleCount);
+	for (uint32_t ix = 0; ix < circleCount; ix++) {
+		xs[ix] = unit(random) * 20.0f - 10.0f;
+		ys[ix] = unit(random) * 20.0f - 10.0f;
+		radii[ix] = BrickBreakerSim::BRICK_RADIUS;
+	}
+	std::vector<glm::vec2> positions(options.Balls), velocities(options.Balls);
+	for (uint32_t ix = 0; ix < options.Balls; ix++) {
+		positions[ix] = glm::vec2(unit(random) * 20.0f - 10.0f, unit(random) * 20.0f - 10.0f);
+		velocities[ix] = glm::vec2(unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f);
+	}
+
+	// The sweep is timed in batches of 16, which is about how many candidates a busy grid query returns
+	const uint32_t sweepBatch = 16;
+	const uint32_t maskCount = circleCount / CollisionKernels::MAX_MASK_COUNT * CollisionKernels::MAX_MASK_COUNT;
+	const uint32_t sweepCount = circleCount / sweepBatch * sweepBatch;
+
+	struct Timing {
+		double   MaskSeconds;
+		double   SweepSeconds;
+		uint64_t Checksum;
+	};
+	auto run = [&](bool forceScalar) {
+		CollisionKernels::SetForceScalar(forceScalar);
+		Timing result;
+		result.Checksum = 14695981039346656037ull;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t ball = 0; ball < options.Balls; ball++) {
+			for (uint32_t ix = 0; ix < maskCount; ix += CollisionKernels::MAX_MASK_COUNT) {
+				const uint32_t mask = CollisionKernels::OverlapMask(positions[ball], BrickBreakerSim::BALL_RADIUS,
+					&xs[ix], &ys[ix], &radii[ix], CollisionKernels::MAX_MASK_COUNT);
+				result.Checksum = (result.Checksum ^ mask) * 1099511628211ull;
+			}
+		}
+		auto middle = std::chrono::high_resolution_clock::now();
+		for (uint32_t ball = 0; ball < options.Balls; ball++) {
+			for (uint32_t ix = 0; ix < sweepCount; ix += sweepBatch) {
+				float time = 0.0f;
+				const int32_t hit = CollisionKernels::SweepEarliest(positions[ball], velocities[ball], BrickBreakerSim::BALL_RADIUS,
+					&xs[ix], &ys[ix], &radii[ix], sweepBatch, 1.0f, time);
+				result.Checksum = (result.Checksum ^ (uint32_t)hit) * 1099511628211ull;
+				__HashFloat(result.Checksum, hit >= 0 ? time : 0.0f);
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		result.MaskSeconds = std::chrono::duration<double>(middle - start).count();
+		result.SweepSeconds = std::chrono::duration<double>(end - middle).count();
+		return result;
+	};
+
+	const Timing scalar = run(true);
+	const Timing simd = run(false);
+
+	const uint64_t maskTests = (uint64_t)options.Balls * maskCount;
+	const uint64_t sweepTests = (uint64_t)options.Balls * sweepCount;
+	LOG_INFO("==== Narrowphase Benchmark ({}, {} lanes) ====", CollisionKernels::GetInstructionSet(), CollisionKernels::GetLaneCount());
+	LOG_INFO("\tTests per pass:   {} overlap, {} sweep", maskTests, sweepTests);
+	LOG_INFO("\tOverlap (SIMD):   {:.1f} M tests/s per core", maskTests / simd.MaskSeconds / 1e6);
+	LOG_INFO("\tOverlap (scalar): {:.1f} M tests/s per core", maskTests / scalar.MaskSeconds / 1e6);
+	LOG_INFO("\tSweep (SIMD):     {:.1f} M tests/s per core", sweepTests / simd.SweepSeconds / 1e6);
+	LOG_INFO("\tSweep (scalar):   {:.1f} M tests/s per core", sweepTests / scalar.SweepSeconds / 1e6);
+	// Like --check transforms, a kernel that gives different answers has to fail the run in release builds too
+	const bool passed = scalar.Checksum == simd.Checksum;
+	LOG_INFO("\tResults:          {} ({:016x} SIMD, {:016x} scalar)", passed ? "match" : "FAILED", simd.Checksum, scalar.Checksum);
+	if (!passed) {
+		LOG_ERROR("{} collision kernels don't match the scalar results!", CollisionKernels::GetInstructionSet());
+		return 1;
+	}
+	return 0;
+}
+
+int HeadlessRunner::RunRecord(const Options& options) {
+	std::mt19937 random(options.Seed);
+	SimInput randomInput;
+
+	Level::Sptr level;
+	if (!__LoadLevel(options, level)) {
+		return 1;
+	}
+	BrickBreakerSim sim;
+	sim.SetTickRate(options.TickRate);
+	__StartGame(sim, level);
+
+	InputLog::Sptr log = InputLog::Create(options.TickRate);
+	for (uint64_t tick = 0; tick < options.Ticks && sim.GetState() == SimState::Playing; tick++) {
+		const SimInput input = __SampleInput(options, sim, tick, random, randomInput);
+		log->Append(input);
+		sim.Step(input);
+	}
+	log->SetFinalChecksum(sim.ComputeChecksum());
+
+	LOG_INFO("Recorded {} steps, the game was {}", log->GetStepCount(),
+		sim.GetState() == SimState::Won ? "won" : sim.GetState() == SimState::Lost ? "lost" : "still playing");
+	LOG_INFO("Final checksum: {:016x}", log->GetFinalChecksum());
+	return log->Save(options.RecordPath) ? 0 : 1;
+}
+
+int HeadlessRunner::RunReplay(const Options& options) {
+	InputLog::Sptr log = InputLog::Load(options.ReplayPath);
+	Level::Sptr level;
+	if (log == nullptr || !__LoadLevel(options, level)) {
+		return 1;
+	}
+
+	// The log knows what rate it was recorded at, so that overrides the options
+	BrickBreakerSim sim;
+	sim.SetTickRate(log->GetTickRate());
+	__StartGame(sim, level);
+
+	InputPlayback playback(log);
+	auto start = std::chrono::high_resolution_clock::now();
+	while (!playback.IsFinished()) {
+		sim.Step(playback.Next());
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	const uint64_t checksum = sim.ComputeChecksum();
+	LOG_INFO("==== Replay Results ====");
+	LOG_INFO("\tSteps:      {} at {} steps per second", log->GetStepCount(), log->GetTickRate());
+	LOG_INFO("\tTime:       {:.3f} ms", seconds * 1000.0);
+	LOG_INFO("\tBricks hit: {}", sim.GetBricksHit());
+	LOG_INFO("\tChecksum:   {:016x} (recorded {:016x})", checksum, log->GetFinalChecksum());
+	if (log->GetFinalChecksum() != 0 && checksum != log->GetFinalChecksum()) {
+		LOG_ERROR("Replay of \"{}\" ended in a different state than it was recorded in", options.ReplayPath);
+		return 1;
+	}
+	return 0;
+}
+
+int HeadlessRunner::Main(int argc, char** argv) {
+	const Options options = ParseArgs(argc, argv);
+	if (!options.ReplayPath.empty()) {
+		return RunReplay(options);
+	}
+	else if (!options.RecordPath.empty()) {
+		return RunRecord(options);
+	}
+	if (options.Check == "transforms") {
+		return RunTransformCheck(options);
+	}
+	else if (!options.Check.empty()) {
+		LOG_ERROR("Unknown check \"{}\"", options.Check);
+		return 1;
+	}
+
+	if (options.Benchmark == "broadphase") {
+		return RunBroadphaseBenchmark(options);
+	}
+	else if (options.Benchmark == "narrowphase") {
+		return RunNarrowphaseBenchmark(options);
+	}
+	else if (options.Benchmark == "balls") {
+		return RunBallBenchmark(options);
+	}
+	else if (options.Benchmark == "particles") {
+		return RunParticleBenchmark(options);
+	}
+	else if (options.Benchmark == "level") {
+		return RunLevelBenchmark(options);
+	}
+	else if (options.Benchmark == "transforms") {
+		return RunTransformBenchmark(options);
+	}
+	else if (!options.Benchmark.empty()) {
+		LOG_ERROR("Unknown benchmark \"{}\"", options.Benchmark);
+		return 1;
+	}
+
+	Level::Sptr level;
+	if (!__LoadLevel(options, level)) {
+		return 1;
+	}
+
+	LOG_INFO("Running {} simulation steps headless at {} steps per second", options.Ticks, options.TickRate);
+
+	const Results results = Run(options);
+
+	LOG_INFO("==== Headless Results ====");
+	LOG_INFO("\tTicks:      {}", results.Ticks);
+	LOG_INFO("\tTime:       {:.3f} s", results.Seconds);
+	LOG_INFO("\tTicks/sec:  {:.0f}", results.Seconds > 0.0 ? results.Ticks / results.Seconds : 0.0);
+	LOG_INFO("\tGames:      {} ({} won, {} lost)", results.Games, results.Wins, results.Losses);
+	LOG_INFO("\tBricks hit: {}", results.BricksHit);
+	LOG_INFO("\tChecksum:   {:016x}", results.Checksum);
+	return 0;
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Game/BrickBreakerSim.h"
+
+/// <summary>
+/// Runs the brick breaker simulation without a window or OpenGL context, as fast as the CPU allows. Useful for
+/// soak tests, training AI players and checking that gameplay hasn't changed on machines with no GPU
+///
+/// Started with the --headless command line argument, see ParseArgs for the other options
+/// </summary>
+class HeadlessRunner
+{
+public:
+	HeadlessRunner() = delete;
+
+	// The most a transform kernel's result can differ from glm's for --check transforms to pass
+	static constexpr float TRANSFORM_TOLERANCE = 1e-4f;
+
+	/// <summary>
+	/// Where the paddle input comes from while running headless
+	/// </summary>
+	enum class InputMode {
+		// The paddle doesn't move
+		None,
+		// The paddle tries to stay under the ball
+		Follow,
+		// The paddle moves randomly, using a fixed seed so runs can be repeated
+		Random
+	};
+
+	struct Options {
+		// The total number of simulation steps to run
+		uint64_t    Ticks;
+		InputMode   Input;
+		uint32_t    Seed;
+		// The number of simulation steps per second of game time
+		float       TickRate;
+		// If not empty, the name of the benchmark to run instead of playing games
+		std::string Benchmark;
+		// If not empty, the name of the correctness check to run instead of playing games
+		std::string Check;
+		// The size of the stress test level used by the benchmarks
+		uint32_t    Bricks;
+		uint32_t    Balls;
+		// The number of steps to time in the benchmarks
+		uint32_t    Steps;
+		// The number of particles in the particle benchmark
+		uint32_t    Particles;
+		// The number of transforms in the transform benchmark
+		uint32_t    Objects;
+		// If not empty, a single game is played and it's input saved to this file
+		std::string RecordPath;
+		// If not empty, the input log to play back instead of playing games
+		std::string ReplayPath;
+		// If not empty, the level file to play instead of the default level
+		std::string LevelPath;
+
+		Options() : Ticks(10000000), Input(InputMode::Follow), Seed(0), TickRate(BrickBreakerSim::BASE_TICK_RATE), Benchmark(""), Check(""), Bricks(100000), Balls(1000), Steps(1000), Particles(65536), Objects(1000000), RecordPath(""), ReplayPath(""), LevelPath("") { }
+	};
+
+	struct Results {
+		uint64_t Ticks;
+		uint64_t Games;
+		uint64_t Wins;
+		uint64_t Losses;
+		uint64_t BricksHit;
+		double   Seconds;
+		// A hash of the final state of every game, if this changes for the same options then gameplay has changed
+		uint64_t Checksum;
+	};
+
+	/// <summary>
+	/// Returns true if the command line asks for a headless run
+	/// </summary>
+	static bool IsRequested(int argc, char** argv);
+
+	/// <summary>
+	/// Parses the headless options from the command line:
+	///    --ticks N                   The number of steps to run (default 10 million)
+	///    --input none|follow|random  Where the paddle input comes from (default follow)
+	///    --seed N                    The seed for random input (default 0)
+	///    --tick-rate N               The number of steps per second of game time (default 60)
+	///    --benchmark broadphase      Times the collision broadphase against testing every ball against every brick
+	///    --benchmark narrowphase     Times the SIMD collision kernels against the scalar fallback
+	///    --benchmark balls           Times steps with the ball pool full of multiballs and projectiles
+	///    --benchmark particles       Times the CPU reference for the debris particles, and checks they all die on time
+	///    --benchmark level           Times loading a level with as many bricks as --bricks, from JSON to a playable game
+	///    --benchmark transforms      Times the TransformStore against recalculating each object's matrix with glm
+	///    --check transforms          Checks every path of the transform kernels against glm, failing if any are off
+	///    --particles N               The number of particles in the particle benchmark (default 65536)
+	///    --objects N                 The number of transforms in the transform benchmark and check (default 1 million)
+	///    --bricks N, --balls N       The size of the benchmark level (default 100000 bricks and 1000 balls)
+	///    --steps N                   The number of steps to time in the benchmark (default 1000)
+	///    --record PATH               Plays a single game and saves it's input to PATH
+	///    --replay PATH               Plays back the input saved in PATH and checks it ends the same way
+	///    --level PATH                Plays the level in PATH instead of the default level, including for --record
+	///                                and --replay, so a log needs to be replayed on the level it was recorded on
+	/// </summary>
+	static Options ParseArgs(int argc, char** argv);
+
+	/// <summary>
+	/// Runs the simulation with the given options, starting a new game on the level whenever one ends
+	/// </summary>
+	static Results Run(const Options& options);
+
+	/// <summary>
+	/// Sets up a level with lots of bricks and balls for stress testing, with the bricks packed into the top half
+	/// of a playfield big enough to fit them, and the balls scattered between the bricks
+	/// </summary>
+	static void BuildStressLevel(BrickBreakerSim& sim, uint32_t brickCount, uint32_t ballCount, uint32_t seed);
+
+	/// <summary>
+	/// Runs the broadphase benchmark, logging the time per step with the grid, and the time it would take to test
+	/// every ball against every brick instead
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunBroadphaseBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs the ball pool benchmark, filling the pool with multiballs while firing projectiles every step, and
+	/// checking that the pool never reallocates
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunBallBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs the particle benchmark, bursting the whole particle buffer at once with the CPU reference simulation
+	/// and updating it at 60 steps per second until every particle has died. This is the CPU time that running
+	/// the particles on the GPU saves each frame
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunParticleBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs the level loading benchmark, building the JSON for a level with as many bricks as the options ask
+	/// for, and timing how long it takes to go from that JSON to a game that's ready to play, both with the bricks
+	/// laid out as a grid and listed one at a time
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunLevelBenchmark(const Options& options);
+
+	/// <summary>
+	/// Runs the transform benchmark, timing how long the TransformStore takes to update every transform, and to
+	/// update the few that changed, against the old way of recalculating each object's matrices one at a time
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunTransformBenchmark(const Options& options);
+
+	/// <summary>
+	/// Checks the scalar, SSE and AVX transform kernels against building the same matrices with glm, one object
+	/// at a time. Every element has to be within TRANSFORM_TOLERANCE of glm's result, relative to the size of the
+	/// element when it's bigger than 1
+	/// </summary>
+	/// <returns>The exit code for the program, 1 if any of the kernels were outside the tolerance</returns>
+	static int RunTransformCheck(const Options& options);
+
+	/// <summary>
+	/// Runs the narrowphase benchmark, logging how many ball-circle tests per second a single core can do with
+	/// the SIMD kernels and with the scalar fallback, and checking that both give the same results
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunNarrowphaseBenchmark(const Options& options);
+
+	/// <summary>
+	/// Plays a single game on the level with the input mode from the options, and saves the input for
+	/// every step along with the checksum of the final state
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int RunRecord(const Options& options);
+
+	/// <summary>
+	/// Plays back a saved input log on the level, logging how fast it ran and checking that it ends in
+	/// the same state it was recorded in
+	/// </summary>
+	/// <returns>The exit code for the program, 1 if the replay didn't match the recording</returns>
+	static int RunReplay(const Options& options);
+
+	/// <summary>
+	/// Parses the command line, runs the simulation and logs the results
+	/// </summary>
+	/// <returns>The exit code for the program</returns>
+	static int Main(int argc, char** argv);
+};
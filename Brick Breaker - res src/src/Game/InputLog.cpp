@@ -0,0 +1,113 @@
+#include "Game/InputLog.h"
+
+#include <cstring>
+#include <fstream>
+#include <Logging.h>
+
+#include "Utils/FileHelpers.h"
+
+namespace {
+	const char MAGIC[4] = { 'B', 'B', 'I', 'N' };
+
+	template <typename T>
+	void __Write(std::string& output, const T& value) {
+		output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool __Read(const std::string& input, size_t& offset, T& value) {
+		if (offset + sizeof(T) > input.size()) {
+			return false;
+		}
+		memcpy(&value, input.data() + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+
+	// Variable length integers, 7 bits per byte with the high bit set on every byte but the last
+	void __WriteVarint(std::string& output, uint32_t value) {
+		while (value >= 0x80) {
+			output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		output.push_back(static_cast<char>(value));
+	}
+
+	bool __ReadVarint(const std::string& input, size_t& offset, uint32_t& value) {
+		value = 0;
+		for (int shift = 0; shift < 35 && offset < input.size(); shift += 7) {
+			const uint8_t byte = static_cast<uint8_t>(input[offset++]);
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+InputLog::InputLog(float tickRate) :
+	_tickRate(tickRate),
+	_finalChecksum(0),
+	_inputs(std::vector<SimInput>()) { }
+
+bool InputLog::Save(const std::string& path) const {
+	std::string output;
+	output.append(MAGIC, sizeof(MAGIC));
+	__Write(output, VERSION);
+	__Write(output, _tickRate);
+	__Write(output, GetStepCount());
+	__Write(output, _finalChecksum);
+
+	for (size_t ix = 0; ix < _inputs.size(); ) {
+		size_t end = ix + 1;
+		while (end < _inputs.size() && _inputs[end].Keys == _inputs[ix].Keys) {
+			end++;
+		}
+		output.push_back(static_cast<char>(_inputs[ix].Keys));
+		__WriteVarint(output, static_cast<uint32_t>(end - ix));
+		ix = end;
+	}
+
+	std::ofstream file(path, std::ios::out | std::ios::binary);
+	if (!file.is_open()) {
+		LOG_WARN("Failed to open \"{}\" to save input log", path);
+		return false;
+	}
+	file.write(output.data(), output.size());
+	LOG_INFO("Saved {} steps of input to \"{}\" ({} bytes)", GetStepCount(), path, output.size());
+	return file.good();
+}
+
+InputLog::Sptr InputLog::Load(const std::string& path) {
+	const std::string input = FileHelpers::ReadFile(path);
+	size_t offset = 0;
+
+	uint32_t version = 0, stepCount = 0;
+	float tickRate = 0.0f;
+	uint64_t checksum = 0;
+	if (input.size() < sizeof(MAGIC) || memcmp(input.data(), MAGIC, sizeof(MAGIC)) != 0) {
+		LOG_WARN("\"{}\" is not an input log", path);
+		return nullptr;
+	}
+	offset += sizeof(MAGIC);
+	if (!__Read(input, offset, version) || version != VERSION ||
+		!__Read(input, offset, tickRate) || !__Read(input, offset, stepCount) || !__Read(input, offset, checksum)) {
+		LOG_WARN("Input log \"{}\" has an unsupported version or a damaged header", path);
+		return nullptr;
+	}
+
+	Sptr result = Create(tickRate);
+	result->_finalChecksum = checksum;
+	result->_inputs.reserve(stepCount);
+	while (result->_inputs.size() < stepCount) {
+		uint8_t keys;
+		uint32_t count;
+		if (!__Read(input, offset, keys) || !__ReadVarint(input, offset, count) || count > stepCount - result->_inputs.size()) {
+			LOG_WARN("Input log \"{}\" is truncated or damaged", path);
+			return nullptr;
+		}
+		result->_inputs.insert(result->_inputs.end(), count, SimInput(keys));
+	}
+	return result;
+}
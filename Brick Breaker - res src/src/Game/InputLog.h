@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Game/BrickBreakerSim.h"
+
+/// <summary>
+/// A recording of the input for every simulation step of a session. Since the simulation only depends on it's
+/// input, playing a log back into a simulation that starts from the same level reproduces the session exactly,
+/// down to the last bit (see BrickBreakerSim::ComputeChecksum)
+///
+/// Logs are saved as a small header followed by the inputs, run-length encoded since keys are usually held
+/// for many steps at a time:
+///    char[4]  "BBIN"
+///    uint32   Version
+///    float    Tick rate the session was recorded at
+///    uint32   Number of steps
+///    uint64   Checksum of the simulation after the last step (0 if unknown)
+///    Runs of (uint8 keys, varint count) until all steps are covered
+/// </summary>
+class InputLog
+{
+public:
+	typedef std::shared_ptr<InputLog> Sptr;
+
+	static constexpr uint32_t VERSION = 1;
+
+	static inline Sptr Create(float tickRate = BrickBreakerSim::BASE_TICK_RATE) {
+		return std::make_shared<InputLog>(tickRate);
+	}
+
+	InputLog(float tickRate);
+	~InputLog() = default;
+
+	/// <summary>
+	/// Adds the input for the next step to the end of the log
+	/// </summary>
+	void Append(const SimInput& input) { _inputs.push_back(input); }
+	/// <summary>
+	/// Gets the input for a step, or no keys if the step is past the end of the log
+	/// </summary>
+	SimInput GetInput(uint32_t step) const { return step < _inputs.size() ? _inputs[step] : SimInput(); }
+	uint32_t GetStepCount() const { return static_cast<uint32_t>(_inputs.size()); }
+	float GetTickRate() const { return _tickRate; }
+
+	/// <summary>
+	/// Sets the checksum of the simulation after the last step, so playback can check that it ends up the same
+	/// </summary>
+	void SetFinalChecksum(uint64_t checksum) { _finalChecksum = checksum; }
+	uint64_t GetFinalChecksum() const { return _finalChecksum; }
+
+	/// <summary>
+	/// Saves the log to a binary file
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	bool Save(const std::string& path) const;
+	/// <summary>
+	/// Loads a log from a binary file
+	/// </summary>
+	/// <returns>The log, or nullptr if the file couldn't be read or isn't an input log</returns>
+	static Sptr Load(const std::string& path);
+
+protected:
+	float                 _tickRate;
+	uint64_t              _finalChecksum;
+	std::vector<SimInput> _inputs;
+};
+
+/// <summary>
+/// Feeds the inputs from a log into a simulation one step at a time
+/// </summary>
+class InputPlayback
+{
+public:
+	InputPlayback(const InputLog::Sptr& log) : _log(log), _step(0) { }
+	~InputPlayback() = default;
+
+	/// <summary>
+	/// Returns true once every step in the log has been played back
+	/// </summary>
+	bool IsFinished() const { return _log == nullptr || _step >= _log->GetStepCount(); }
+	/// <summary>
+	/// Gets the input for the next step, and moves on to the step after it
+	/// </summary>
+	SimInput Next() { return IsFinished() ? SimInput() : _log->GetInput(_step++); }
+	uint32_t GetStep() const { return _step; }
+	const InputLog::Sptr& GetLog() const { return _log; }
+
+protected:
+	InputLog::Sptr _log;
+	uint32_t       _step;
+};
@@ -0,0 +1,474 @@
+#include "Game/Level.h"
+
+#include <Logging.h>
+#include <algorithm>
+#include <fstream>
+
+namespace {
+	// Level files come from outside the game, so every value is checked before it's read. The readers below leave
+	// the value alone if the key is missing, and return false if it's there but the wrong type
+
+	bool __ReadFloat(const nlohmann::json& blob, const char* key, float& outValue) {
+		auto it = blob.find(key);
+		if (it == blob.end()) {
+			return true;
+		}
+		if (!it->is_number()) {
+			return false;
+		}
+		outValue = it->get<float>();
+		return true;
+	}
+
+	bool __ReadString(const nlohmann::json& blob, const char* key, std::string& outValue) {
+		auto it = blob.find(key);
+		if (it == blob.end()) {
+			return true;
+		}
+		if (!it->is_string()) {
+			return false;
+		}
+		outValue = it->get<std::string>();
+		return true;
+	}
+
+	// Reads an { "x": 0.0, "y": 0.0 } object, where both parts are required
+	bool __ReadVec2(const nlohmann::json& blob, glm::vec2& outValue) {
+		auto x = blob.find("x");
+		auto y = blob.find("y");
+		if (!blob.is_object() || x == blob.end() || y == blob.end() || !x->is_number() || !y->is_number()) {
+			return false;
+		}
+		outValue = glm::vec2(x->get<float>(), y->get<float>());
+		return true;
+	}
+
+	bool __ReadVec2(const nlohmann::json& blob, const char* key, glm::vec2& outValue) {
+		auto it = blob.find(key);
+		return it == blob.end() || __ReadVec2(*it, outValue);
+	}
+
+	// Reads the brick type from a single entry in the level's "types"
+	bool __ParseBrickType(char key, const nlohmann::json& blob, Level::BrickType& outType) {
+		outType.Key = key;
+		if (!blob.is_object()) {
+			LOG_WARN("Brick type '{}' needs to be an object", key);
+			return false;
+		}
+		std::string shape = "circle";
+		if (!__ReadString(blob, "shape", shape)) {
+			LOG_WARN("Brick type '{}' needs it's shape to be a string", key);
+			return false;
+		}
+		if (shape == "circle") {
+			float radius = BrickBreakerSim::BRICK_RADIUS;
+			if (!__ReadFloat(blob, "radius", radius)) {
+				LOG_WARN("Brick type '{}' needs it's radius to be a number", key);
+				return false;
+			}
+			outType.Shape = BrickShape::Circle;
+			outType.HalfExtents = glm::vec2(radius);
+		}
+		else if (shape == "box") {
+			if (!blob.contains("half_extents") || !__ReadVec2(blob["half_extents"], outType.HalfExtents)) {
+				LOG_WARN("Box brick type '{}' needs half_extents with an x and y", key);
+				return false;
+			}
+			outType.Shape = BrickShape::Box;
+		}
+		else {
+			LOG_WARN("Brick type '{}' has an unknown shape \"{}\"", key, shape);
+			return false;
+		}
+
+		// Hit points are stored in 16 bits, so anything that doesn't fit would silently wrap around
+		outType.HitPoints = 1;
+		auto hp = blob.find("hp");
+		if (hp != blob.end()) {
+			if (!hp->is_number_integer() || hp->get<int64_t>() < 0 || hp->get<int64_t>() > UINT16_MAX) {
+				LOG_WARN("Brick type '{}' needs it's hp to be a whole number from 0 to {}", key, UINT16_MAX);
+				return false;
+			}
+			outType.HitPoints = static_cast<uint16_t>(hp->get<int64_t>());
+		}
+
+		outType.Texture = Level::DEFAULT_TEXTURE;
+		outType.Shininess = 1.0f;
+		auto material = blob.find("material");
+		if (material != blob.end()) {
+			if (!material->is_object() || !__ReadString(*material, "texture", outType.Texture) || !__ReadFloat(*material, "shininess", outType.Shininess)) {
+				LOG_WARN("Brick type '{}' needs it's material to be an object with a texture string and shininess number", key);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	BrickBreakerSim::Brick __MakeBrick(const Level::BrickType& type, uint16_t typeIndex, const glm::vec2& position) {
+		BrickBreakerSim::Brick brick;
+		brick.Position = position;
+		brick.HalfExtents = type.HalfExtents;
+		brick.Shape = type.Shape;
+		brick.IsAlive = true;
+		brick.Type = typeIndex;
+		brick.HitPoints = type.HitPoints;
+		return brick;
+	}
+
+	// A brick from the "bricks" list. Bricks can come before the types they use, so they're kept like this until
+	// all of the types have been read
+	struct ListedBrick {
+		std::string Type;
+		glm::vec2   Position;
+	};
+
+	// Reads a brick from the "bricks" list, either { "type": "o", "x": 0.0, "y": 0.0 } or the compact [ "o", 0.0, 0.0 ]
+	bool __ParseListedBrick(const nlohmann::json& entry, ListedBrick& outBrick) {
+		if (entry.is_array()) {
+			if (entry.size() != 3 || !entry[0].is_string() || !entry[1].is_number() || !entry[2].is_number()) {
+				return false;
+			}
+			outBrick.Type = entry[0].get<std::string>();
+			outBrick.Position = glm::vec2(entry[1].get<float>(), entry[2].get<float>());
+			return true;
+		}
+		return entry.is_object() && entry.contains("type") && __ReadString(entry, "type", outBrick.Type) && __ReadVec2(entry, outBrick.Position);
+	}
+
+	/// <summary>
+	/// SAX handler that reads the "bricks" list straight into ListedBricks as it's streamed, rather than building a
+	/// JSON object for every brick, which is where most of the time loading a big list used to go. Everything else
+	/// in the level is small, so it's passed through to nlohmann's DOM builder and read the same as a parsed level
+	/// </summary>
+	class LevelSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+	public:
+		LevelSaxHandler(nlohmann::json& outBlob, std::vector<ListedBrick>& outBricks) :
+			_dom(outBlob, false),
+			_bricks(outBricks),
+			_depth(0),
+			_bricksNext(false),
+			_inBricks(false),
+			_entryDepth(0),
+			_entryIsArray(false),
+			_field(Field::Ignored),
+			_element(0),
+			_found(0),
+			_entry(ListedBrick()) { }
+
+		bool null() override { return _inBricks ? _BrickValue(false, 0.0f, nullptr) : _Forward() && _dom.null(); }
+		bool boolean(bool val) override { return _inBricks ? _BrickValue(false, 0.0f, nullptr) : _Forward() && _dom.boolean(val); }
+		bool number_integer(number_integer_t val) override { return _inBricks ? _BrickValue(true, static_cast<float>(val), nullptr) : _Forward() && _dom.number_integer(val); }
+		bool number_unsigned(number_unsigned_t val) override { return _inBricks ? _BrickValue(true, static_cast<float>(val), nullptr) : _Forward() && _dom.number_unsigned(val); }
+		bool number_float(number_float_t val, const string_t& text) override { return _inBricks ? _BrickValue(true, static_cast<float>(val), nullptr) : _Forward() && _dom.number_float(val, text); }
+		bool string(string_t& val) override { return _inBricks ? _BrickValue(false, 0.0f, &val) : _Forward() && _dom.string(val); }
+		bool binary(binary_t& val) override { return _inBricks ? _BrickValue(false, 0.0f, nullptr) : _Forward() && _dom.binary(val); }
+
+		bool start_object(std::size_t elements) override {
+			_depth++;
+			return _inBricks ? _StartBrickContainer(false) : _Forward() && _dom.start_object(elements);
+		}
+
+		bool key(string_t& val) override {
+			if (_inBricks) {
+				// Keys inside of an entry's values don't matter to us
+				if (_entryDepth == 1) {
+					_field = val == "type" ? Field::Type : val == "x" ? Field::X : val == "y" ? Field::Y : Field::Ignored;
+				}
+				return true;
+			}
+			// The bricks are the only thing we don't want in the DOM
+			if (_depth == 1 && val == "bricks") {
+				_bricksNext = true;
+				return true;
+			}
+			return _dom.key(val);
+		}
+
+		bool end_object() override {
+			_depth--;
+			return _inBricks ? _EndBrickContainer() : _dom.end_object();
+		}
+
+		bool start_array(std::size_t elements) override {
+			_depth++;
+			if (_bricksNext) {
+				_bricksNext = false;
+				_inBricks = true;
+				_entryDepth = 0;
+				return true;
+			}
+			return _inBricks ? _StartBrickContainer(true) : _Forward() && _dom.start_array(elements);
+		}
+
+		bool end_array() override {
+			_depth--;
+			if (_inBricks && _entryDepth == 0) {
+				_inBricks = false;
+				return true;
+			}
+			return _inBricks ? _EndBrickContainer() : _dom.end_array();
+		}
+
+		bool parse_error(std::size_t position, const std::string& lastToken, const nlohmann::detail::exception& ex) override {
+			LOG_WARN("Level JSON parse error at byte {}: {}", position, ex.what());
+			return false;
+		}
+
+	protected:
+		// The parts of an entry in the brick list
+		enum class Field {
+			Type,
+			X,
+			Y,
+			Ignored
+		};
+		static constexpr uint8_t ALL_FIELDS = (1 << (int)Field::Type) | (1 << (int)Field::X) | (1 << (int)Field::Y);
+
+		nlohmann::detail::json_sax_dom_parser<nlohmann::json> _dom;
+		std::vector<ListedBrick>& _bricks;
+
+		int  _depth;      // The number of containers we are currently nested in
+		bool _bricksNext; // True if we just read the "bricks" key, and it's array is up next
+		bool _inBricks;   // True while we are reading the brick list
+
+		int         _entryDepth;   // 0 between entries, 1 directly inside of an entry, and more inside of a value we don't care about
+		bool        _entryIsArray; // True if the entry is the compact [ type, x, y ] form
+		Field       _field;        // The field the next value in an object entry belongs to
+		uint32_t    _element;      // The index of the next value in an array entry
+		uint8_t     _found;        // A bit for each field we have found in the current entry
+		ListedBrick _entry;
+
+		// Called before passing a value to the DOM, to make sure that the bricks are an array like they should be
+		bool _Forward() {
+			if (_bricksNext) {
+				LOG_WARN("Level bricks need to be an array");
+				return false;
+			}
+			return true;
+		}
+
+		bool _Malformed() {
+			LOG_WARN("Brick {} needs a type, x and y", _bricks.size());
+			return false;
+		}
+
+		// Gets the field that a value directly inside of an entry belongs to
+		Field _NextField() {
+			if (!_entryIsArray) {
+				return _field;
+			}
+			const uint32_t element = _element++;
+			return element == 0 ? Field::Type : element == 1 ? Field::X : element == 2 ? Field::Y : Field::Ignored;
+		}
+
+		bool _BrickValue(bool isNumber, float number, string_t* text) {
+			if (_entryDepth == 0) {
+				return _Malformed();
+			}
+			if (_entryDepth > 1) {
+				return true;
+			}
+			const Field field = _NextField();
+			if (field == Field::Ignored) {
+				// Anything after the y in an array would be a mistake, but extra keys in an object are fine
+				return !_entryIsArray || _Malformed();
+			}
+			if (field == Field::Type ? text == nullptr : !isNumber) {
+				return _Malformed();
+			}
+			if (field == Field::Type) {
+				_entry.Type = std::move(*text);
+			}
+			else {
+				(field == Field::X ? _entry.Position.x : _entry.Position.y) = number;
+			}
+			_found |= 1 << (int)field;
+			return true;
+		}
+
+		bool _StartBrickContainer(bool isArray) {
+			if (_entryDepth == 0) {
+				_entryIsArray = isArray;
+				_field = Field::Ignored;
+				_element = 0;
+				_found = 0;
+			}
+			else if (_entryDepth == 1 && (_entryIsArray || _NextField() != Field::Ignored)) {
+				// The type and position can't be containers
+				return _Malformed();
+			}
+			_entryDepth++;
+			return true;
+		}
+
+		bool _EndBrickContainer() {
+			_entryDepth--;
+			if (_entryDepth == 0) {
+				if (_found != ALL_FIELDS) {
+					return _Malformed();
+				}
+				_bricks.push_back(std::move(_entry));
+			}
+			return true;
+		}
+	};
+
+	// Builds a level from it's JSON description, with the "bricks" list already read into listed
+	Level::Sptr __BuildLevel(const nlohmann::json& blob, const std::vector<ListedBrick>& listed) {
+		if (!blob.is_object() || !blob.contains("types") || !blob["types"].is_object()) {
+			LOG_WARN("Levels need an object of brick types");
+			return nullptr;
+		}
+
+		Level::Sptr result = Level::Create();
+		if (!__ReadString(blob, "name", result->Name)) {
+			LOG_WARN("Level name needs to be a string");
+			return nullptr;
+		}
+		if (blob.contains("playfield")) {
+			const nlohmann::json& playfield = blob["playfield"];
+			BrickBreakerSim::Playfield& out = result->Playfield;
+			if (!playfield.is_object() ||
+				!__ReadFloat(playfield, "wall_x", out.WallX) ||
+				!__ReadFloat(playfield, "wall_top", out.WallTop) ||
+				!__ReadFloat(playfield, "paddle_hit_y", out.PaddleHitY) ||
+				!__ReadFloat(playfield, "lose_y", out.LoseY) ||
+				!__ReadFloat(playfield, "paddle_limit_x", out.PaddleLimitX)) {
+				LOG_WARN("Level playfield needs to be an object of numbers");
+				return nullptr;
+			}
+		}
+		if (!__ReadVec2(blob, "ball", result->BallStart) || !__ReadVec2(blob, "paddle", result->PaddleStart)) {
+			LOG_WARN("Level ball and paddle positions need an x and y");
+			return nullptr;
+		}
+
+		// Characters are looked up in a table rather than searching the types, since a big grid has a lot of them
+		int32_t typeLookup[Level::MAX_TYPES];
+		std::fill(typeLookup, typeLookup + Level::MAX_TYPES, -1);
+		for (const auto& [key, value] : blob["types"].items()) {
+			if (key.size() != 1 || key[0] == '.' || key[0] == ' ') {
+				LOG_WARN("Brick type \"{}\" needs to be a single character, other than '.' or ' '", key);
+				return nullptr;
+			}
+			Level::BrickType type;
+			if (!__ParseBrickType(key[0], value, type)) {
+				return nullptr;
+			}
+			typeLookup[static_cast<uint8_t>(key[0])] = static_cast<int32_t>(result->Types.size());
+			result->Types.push_back(type);
+		}
+
+		if (blob.contains("grid")) {
+			const nlohmann::json& grid = blob["grid"];
+			glm::vec2 origin = glm::vec2(0.0f);
+			glm::vec2 spacing = glm::vec2(2.0f * BrickBreakerSim::BRICK_RADIUS);
+			if (!grid.is_object() || !__ReadVec2(grid, "origin", origin) || !__ReadVec2(grid, "spacing", spacing)) {
+				LOG_WARN("Grid origin and spacing need an x and y");
+				return nullptr;
+			}
+			if (!grid.contains("rows") || !grid["rows"].is_array()) {
+				LOG_WARN("Grids need an array of rows");
+				return nullptr;
+			}
+			const nlohmann::json& rows = grid["rows"];
+
+			// Reserve for a full grid up front, so the bricks are only ever allocated once
+			size_t cells = 0;
+			for (const nlohmann::json& row : rows) {
+				cells += row.is_string() ? row.get_ref<const std::string&>().size() : 0;
+			}
+			result->Bricks.reserve(cells + listed.size());
+
+			for (size_t rowIx = 0; rowIx < rows.size(); rowIx++) {
+				if (!rows[rowIx].is_string()) {
+					LOG_WARN("Grid row {} needs to be a string", rowIx);
+					return nullptr;
+				}
+				const std::string& row = rows[rowIx].get_ref<const std::string&>();
+				for (size_t column = 0; column < row.size(); column++) {
+					if (row[column] == '.' || row[column] == ' ') {
+						continue;
+					}
+					const int32_t typeIndex = typeLookup[static_cast<uint8_t>(row[column])];
+					if (typeIndex < 0) {
+						LOG_WARN("Grid row {} uses an unknown brick type '{}'", rowIx, row[column]);
+						return nullptr;
+					}
+					const glm::vec2 position = origin + spacing * glm::vec2(static_cast<float>(column), static_cast<float>(rowIx));
+					result->Bricks.push_back(__MakeBrick(result->Types[typeIndex], static_cast<uint16_t>(typeIndex), position));
+				}
+			}
+		}
+
+		for (size_t ix = 0; ix < listed.size(); ix++) {
+			const int32_t typeIndex = listed[ix].Type.size() == 1 ? typeLookup[static_cast<uint8_t>(listed[ix].Type[0])] : -1;
+			if (typeIndex < 0) {
+				LOG_WARN("Brick {} uses an unknown brick type \"{}\"", ix, listed[ix].Type);
+				return nullptr;
+			}
+			result->Bricks.push_back(__MakeBrick(result->Types[typeIndex], static_cast<uint16_t>(typeIndex), listed[ix].Position));
+		}
+
+		return result;
+	}
+}
+
+Level::Level() :
+	Name(""),
+	Playfield(BrickBreakerSim::Playfield()),
+	BallStart(glm::vec2(0.0f, 0.0f)),
+	PaddleStart(glm::vec2(0.0f, 5.8f)),
+	Types(std::vector<BrickType>()),
+	Bricks(std::vector<BrickBreakerSim::Brick>()) { }
+
+void Level::Apply(BrickBreakerSim& sim) const {
+	sim.SetPlayfield(Playfield);
+	sim.Reset(BallStart, PaddleStart);
+	sim.AddBricks(Bricks.data(), static_cast<uint32_t>(Bricks.size()));
+}
+
+Level::Sptr Level::FromJson(const nlohmann::json& blob) {
+	std::vector<ListedBrick> listed;
+	if (blob.is_object() && blob.contains("bricks")) {
+		const nlohmann::json& bricks = blob["bricks"];
+		if (!bricks.is_array()) {
+			LOG_WARN("Level bricks need to be an array");
+			return nullptr;
+		}
+		listed.resize(bricks.size());
+		for (size_t ix = 0; ix < bricks.size(); ix++) {
+			if (!__ParseListedBrick(bricks[ix], listed[ix])) {
+				LOG_WARN("Brick {} needs a type, x and y", ix);
+				return nullptr;
+			}
+		}
+	}
+	return __BuildLevel(blob, listed);
+}
+
+Level::Sptr Level::FromStream(std::istream& stream) {
+	nlohmann::json blob;
+	std::vector<ListedBrick> listed;
+	LevelSaxHandler handler(blob, listed);
+	if (!nlohmann::json::sax_parse(stream, &handler)) {
+		return nullptr;
+	}
+	return __BuildLevel(blob, listed);
+}
+
+Level::Sptr Level::LoadFromFile(const std::string& path) {
+	// We stream straight from the file, so big levels never have to be held in memory as text
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		LOG_WARN("Could not open level \"{}\"", path);
+		return nullptr;
+	}
+	Sptr result = FromStream(file);
+	if (result == nullptr) {
+		LOG_WARN("\"{}\" is not a valid level", path);
+		return nullptr;
+	}
+	LOG_INFO("Loaded level \"{}\" from \"{}\" ({} bricks, {} types)", result->Name, path, result->Bricks.size(), result->Types.size());
+	return result;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <istream>
+#include <vector>
+#include <json.hpp>
+#include <GLM/glm.hpp>
+
+#include "Game/BrickBreakerSim.h"
+
+/// <summary>
+/// A brick layout loaded from a JSON file, along with the playfield and where the ball and paddle start. Levels
+/// only hold data, so they can be loaded without a window (see --headless) and applied to a simulation as many
+/// times as needed
+///
+/// Each kind of brick is described once in "types", keyed by a single character, and the bricks themselves can
+/// be laid out as a grid of those characters, listed one at a time, or both:
+///    {
+///        "name": "Example",
+///        "playfield": { "wall_x": 7.21, "wall_top": -7.17, "paddle_hit_y": 5.36, "lose_y": 6.0, "paddle_limit_x": 6.12 },
+///        "ball":   { "x": 0.0, "y": 0.0 },
+///        "paddle": { "x": 0.0, "y": 5.8 },
+///        "types": {
+///            "o": { "shape": "circle", "radius": 0.63, "hp": 1, "material": { "texture": "textures/brickTex.jpg" } },
+///            "#": { "shape": "box", "half_extents": { "x": 0.8, "y": 0.4 }, "hp": 0 }
+///        },
+///        "grid": { "origin": { "x": -4.0, "y": -6.0 }, "spacing": { "x": 2.0, "y": 1.0 }, "rows": [ "o#o#o", "..o.." ] },
+///        "bricks": [ { "type": "o", "x": 0.0, "y": -2.5 }, [ "#", 2.0, -2.5 ] ]
+///    }
+///
+/// Everything but the types and bricks is optional. Grid rows go down the screen from the origin, with '.' or ' '
+/// for an empty cell, and bricks with 0 hp never break. Listed bricks can be an object, or a compact [ type, x, y ]
+/// array that's about half the size. Grids are the fast way to describe big levels, since the whole row is a single
+/// JSON string rather than an entry per brick, but loading from a stream reads the list without building a JSON
+/// value for each brick, so big lists load quickly too
+/// </summary>
+class Level
+{
+public:
+	typedef std::shared_ptr<Level> Sptr;
+
+	// The most kinds of brick a level can have, one for each character that can be used in a grid
+	static constexpr uint32_t MAX_TYPES = 256;
+	// The texture for brick types that don't give one
+	static constexpr const char* DEFAULT_TEXTURE = "textures/brickTex.jpg";
+
+	/// <summary>
+	/// A kind of brick, and how it should look
+	/// </summary>
+	struct BrickType {
+		// The character that stands for this type in the grid and brick list
+		char        Key;
+		BrickShape  Shape;
+		// Half the width and height of a box brick, or the radius on both axes for a circle brick
+		glm::vec2   HalfExtents;
+		// How many hits the brick takes to break, or 0 if it never breaks
+		uint16_t    HitPoints;
+		// The texture and shininess for the brick's material
+		std::string Texture;
+		float       Shininess;
+	};
+
+	static inline Sptr Create() {
+		return std::make_shared<Level>();
+	}
+
+	Level();
+	~Level() = default;
+
+	std::string                      Name;
+	BrickBreakerSim::Playfield       Playfield;
+	glm::vec2                        BallStart;
+	glm::vec2                        PaddleStart;
+	std::vector<BrickType>           Types;
+	// The bricks, ready to be copied into a simulation. Each brick's Type is an index into Types
+	std::vector<BrickBreakerSim::Brick> Bricks;
+
+	/// <summary>
+	/// Resets a simulation and sets it up to play this level
+	/// </summary>
+	void Apply(BrickBreakerSim& sim) const;
+
+	/// <summary>
+	/// Loads a level from it's JSON description (see the format above)
+	/// </summary>
+	/// <returns>The level, or nullptr if the description isn't a valid level</returns>
+	static Sptr FromJson(const nlohmann::json& blob);
+	/// <summary>
+	/// Streams a level from it's JSON text, reading the listed bricks as they arrive rather than building a JSON value for each
+	/// </summary>
+	/// <returns>The level, or nullptr if the text isn't valid JSON or isn't a valid level</returns>
+	static Sptr FromStream(std::istream& stream);
+	/// <summary>
+	/// Loads a level from a JSON file
+	/// </summary>
+	/// <returns>The level, or nullptr if the file couldn't be read or isn't a valid level</returns>
+	static Sptr LoadFromFile(const std::string& path);
+};
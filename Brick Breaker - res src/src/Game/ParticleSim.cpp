@@ -0,0 +1,81 @@
+#include "Game/ParticleSim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Logging.h>
+
+ParticleSim::ParticleSim(uint32_t capacity) :
+	_particles(std::vector<Particle>(capacity, Particle{ glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) })),
+	_pending(std::vector<ParticleEmitter>()),
+	_head(0)
+{
+	LOG_ASSERT(capacity > 0, "Particle capacity must be greater than zero!");
+}
+
+uint32_t ParticleSim::Hash(uint32_t value) {
+	value ^= value >> 16;
+	value *= 0x7FEB352Du;
+	value ^= value >> 15;
+	value *= 0x846CA68Bu;
+	value ^= value >> 16;
+	return value;
+}
+
+float ParticleSim::Random(uint32_t seed, uint32_t index, uint32_t stream) {
+	// The top 24 bits fit exactly in a float's mantissa
+	return static_cast<float>(Hash(seed ^ Hash(index * 4u + stream)) >> 8) / 16777216.0f;
+}
+
+Particle ParticleSim::Spawn(const ParticleEmitter& emitter, uint32_t index) {
+	// Debris flies out in every direction across the playfield, with a bit of spread towards and away from the camera
+	const float angle = Random(emitter.Seed, index, 0) * 6.28318531f;
+	const float speed = emitter.Speed * (0.25f + 0.75f * Random(emitter.Seed, index, 1));
+	const float depth = Random(emitter.Seed, index, 2) - 0.5f;
+	const float life = emitter.Life * (0.75f + 0.5f * Random(emitter.Seed, index, 3));
+
+	Particle result;
+	result.PositionLife = glm::vec4(emitter.Position, life);
+	result.VelocitySize = glm::vec4(std::cos(angle) * speed, std::sin(angle) * speed, depth * speed, emitter.Size * (1.0f + depth));
+	result.Color = glm::vec4(emitter.Color, life);
+	return result;
+}
+
+void ParticleSim::Integrate(Particle& particle, float deltaTime, const ParticleSettings& settings) {
+	if (particle.PositionLife.w <= 0.0f) {
+		return;
+	}
+	glm::vec3 velocity = glm::vec3(particle.VelocitySize);
+	velocity += settings.Gravity * deltaTime;
+	velocity *= std::max(0.0f, 1.0f - settings.Drag * deltaTime);
+	particle.VelocitySize = glm::vec4(velocity, particle.VelocitySize.w);
+	particle.PositionLife = glm::vec4(glm::vec3(particle.PositionLife) + velocity * deltaTime, particle.PositionLife.w - deltaTime);
+}
+
+uint32_t ParticleSim::Emit(ParticleEmitter emitter) {
+	emitter.Count = std::min(emitter.Count, GetCapacity());
+	emitter.FirstIndex = _head;
+	_head = (_head + emitter.Count) % GetCapacity();
+	_pending.push_back(emitter);
+	return emitter.FirstIndex;
+}
+
+void ParticleSim::Update(float deltaTime, const ParticleSettings& settings) {
+	for (Particle& particle : _particles) {
+		Integrate(particle, deltaTime, settings);
+	}
+	// Newly spawned particles don't move until the next update, the same as on the GPU
+	for (const ParticleEmitter& emitter : _pending) {
+		for (uint32_t ix = 0; ix < emitter.Count; ix++) {
+			_particles[(emitter.FirstIndex + ix) % GetCapacity()] = Spawn(emitter, ix);
+		}
+	}
+	_pending.clear();
+}
+
+uint32_t ParticleSim::CountAlive() const {
+	uint32_t result = 0;
+	for (const Particle& particle : _particles) {
+		result += particle.PositionLife.w > 0.0f;
+	}
+	return result;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A single particle, laid out to match the std430 struct in the particle shaders
+/// </summary>
+struct Particle {
+	// XYZ is the position, W is the number of seconds left to live
+	glm::vec4 PositionLife;
+	// XYZ is the velocity in units per second, W is the size in world units
+	glm::vec4 VelocitySize;
+	// RGB is the color, A is the total number of seconds the particle lives for, so it can fade out
+	glm::vec4 Color;
+};
+
+/// <summary>
+/// A burst of particles, all spawned from the same point at once
+/// </summary>
+struct ParticleEmitter {
+	glm::vec3 Position;
+	glm::vec3 Color;
+	// How fast the particles fly outwards, in units per second
+	float     Speed;
+	// How long the particles live for, in seconds
+	float     Life;
+	// How big the particles are, in world units
+	float     Size;
+	uint32_t  Count;
+	// Changes the random directions, sizes and lifetimes of the particles
+	uint32_t  Seed;
+	// Where the particles start in the particle buffer, set when the emitter is added
+	uint32_t  FirstIndex;
+
+	ParticleEmitter() : Position(glm::vec3(0.0f)), Color(glm::vec3(1.0f)), Speed(4.0f), Life(1.0f), Size(0.1f), Count(0), Seed(0), FirstIndex(0) { }
+};
+
+/// <summary>
+/// The forces that act on every particle
+/// </summary>
+struct ParticleSettings {
+	// Y points down towards the paddle, so debris falls with positive Y
+	glm::vec3 Gravity;
+	// The fraction of it's velocity a particle loses every second
+	float     Drag;
+
+	ParticleSettings() : Gravity(glm::vec3(0.0f, 9.8f, 0.0f)), Drag(0.8f) { }
+};
+
+/// <summary>
+/// The CPU reference for the particle simulation that runs on the GPU (see ParticleSystem and
+/// particles_update.glsl). Both spawn particles into a ring buffer in the same order with the same hash-based
+/// random numbers, and integrate them with the same steps, so the results can be compared particle by particle.
+/// The GPU won't match to the last bit, since it's free to fuse and reorder float math
+///
+/// Any changes to Spawn or Integrate need to be made to the compute shader as well
+/// </summary>
+class ParticleSim
+{
+public:
+	ParticleSim(uint32_t capacity);
+	~ParticleSim() = default;
+
+	/// <summary>
+	/// A 32 bit integer hash, the same one the compute shader uses
+	/// </summary>
+	static uint32_t Hash(uint32_t value);
+	/// <summary>
+	/// Gets a random number between 0 and 1 for a particle. Each particle has a few streams of random numbers
+	/// to pick from, so it's direction, speed and lifetime aren't related
+	/// </summary>
+	static float Random(uint32_t seed, uint32_t index, uint32_t stream);
+	/// <summary>
+	/// Creates a particle from an emitter
+	/// </summary>
+	/// <param name="emitter">The emitter the particle comes from</param>
+	/// <param name="index">Which of the emitter's particles this is, from 0 to Count - 1</param>
+	static Particle Spawn(const ParticleEmitter& emitter, uint32_t index);
+	/// <summary>
+	/// Moves a particle forward in time, does nothing to particles that are already dead
+	/// </summary>
+	static void Integrate(Particle& particle, float deltaTime, const ParticleSettings& settings);
+
+	/// <summary>
+	/// Queues up an emitter to spawn it's particles on the next Update, replacing the oldest particles
+	/// </summary>
+	/// <returns>The index of the first particle</returns>
+	uint32_t Emit(ParticleEmitter emitter);
+	/// <summary>
+	/// Integrates every particle that's alive, then spawns the particles from the emitters that were queued
+	/// </summary>
+	void Update(float deltaTime, const ParticleSettings& settings);
+
+	uint32_t GetCapacity() const { return static_cast<uint32_t>(_particles.size()); }
+	/// <summary>
+	/// Counts the particles that are still alive
+	/// </summary>
+	uint32_t CountAlive() const;
+	const std::vector<Particle>& GetParticles() const { return _particles; }
+
+protected:
+	std::vector<Particle>        _particles;
+	std::vector<ParticleEmitter> _pending;
+	// Where the next emitter will start spawning
+	uint32_t                     _head;
+};
@@ -0,0 +1,124 @@
+#include "Graphics/BufferAllocator.h"
+#include "Logging.h"
+
+BufferAllocator::BufferAllocator(size_t capacity) :
+	_capacity(0),
+	_used(0),
+	_freeByOffset(std::map<size_t, size_t>()),
+	_freeBySize(std::multimap<size_t, size_t>()),
+	_allocations(std::map<size_t, size_t>())
+{
+	Reset(capacity);
+}
+
+size_t BufferAllocator::Allocate(size_t size, size_t alignment) {
+	if (size == 0) {
+		return INVALID_OFFSET;
+	}
+	if (alignment == 0) {
+		alignment = 1;
+	}
+
+	// Walk the free blocks from the smallest one that could possibly fit, the first that fits with it's alignment padding wins
+	for (auto it = _freeBySize.lower_bound(size); it != _freeBySize.end(); it++) {
+		const size_t blockSize = it->first;
+		const size_t blockOffset = it->second;
+		const size_t offset = (blockOffset + alignment - 1) / alignment * alignment;
+		const size_t padding = offset - blockOffset;
+		if (padding + size > blockSize) {
+			continue;
+		}
+
+		// Split the block, any padding in front and leftover space behind go back into the free list
+		_RemoveFree(blockOffset, blockSize);
+		if (padding > 0) {
+			_AddFree(blockOffset, padding);
+		}
+		if (blockSize > padding + size) {
+			_AddFree(offset + size, blockSize - padding - size);
+		}
+		_allocations[offset] = size;
+		_used += size;
+		return offset;
+	}
+	return INVALID_OFFSET;
+}
+
+void BufferAllocator::Free(size_t offset) {
+	auto it = _allocations.find(offset);
+	LOG_ASSERT(it != _allocations.end(), "Tried to free a range that was not allocated!");
+	const size_t size = it->second;
+	_allocations.erase(it);
+	_used -= size;
+	_AddFree(offset, size);
+}
+
+void BufferAllocator::Grow(size_t capacity) {
+	if (capacity <= _capacity) {
+		return;
+	}
+	const size_t oldCapacity = _capacity;
+	_capacity = capacity;
+	_AddFree(oldCapacity, capacity - oldCapacity);
+}
+
+void BufferAllocator::Reset(size_t capacity) {
+	_freeByOffset.clear();
+	_freeBySize.clear();
+	_allocations.clear();
+	_used = 0;
+	_capacity = capacity;
+	if (capacity > 0) {
+		_AddFree(0, capacity);
+	}
+}
+
+size_t BufferAllocator::GetSize(size_t offset) const {
+	auto it = _allocations.find(offset);
+	return it != _allocations.end() ? it->second : 0;
+}
+
+BufferAllocator::Stats BufferAllocator::GetStats() const {
+	Stats result;
+	result.Capacity = _capacity;
+	result.Used = _used;
+	result.Free = _capacity - _used;
+	result.LargestFreeBlock = _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first;
+	result.Allocations = static_cast<uint32_t>(_allocations.size());
+	result.FreeBlocks = static_cast<uint32_t>(_freeByOffset.size());
+	result.Fragmentation = result.Free > 0 ? 1.0f - (float)result.LargestFreeBlock / (float)result.Free : 0.0f;
+	return result;
+}
+
+void BufferAllocator::_AddFree(size_t offset, size_t size) {
+	// Merge with the block that ends where this one starts
+	auto next = _freeByOffset.lower_bound(offset);
+	if (next != _freeByOffset.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			_RemoveFree(prev->first, prev->second);
+		}
+	}
+	// Merge with the block that starts where this one ends
+	next = _freeByOffset.find(offset + size);
+	if (next != _freeByOffset.end()) {
+		size += next->second;
+		_RemoveFree(next->first, next->second);
+	}
+
+	_freeByOffset[offset] = size;
+	_freeBySize.insert(std::make_pair(size, offset));
+}
+
+void BufferAllocator::_RemoveFree(size_t offset, size_t size) {
+	_freeByOffset.erase(offset);
+	auto range = _freeBySize.equal_range(size);
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second == offset) {
+			_freeBySize.erase(it);
+			return;
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <map>
+
+/// <summary>
+/// Hands out ranges of a larger block of memory (ex: a GPU buffer). The allocator only does the bookkeeping,
+/// it never touches the memory itself
+///
+/// Free space is kept in a free list ordered by offset, so freed ranges are merged with their neighbours right
+/// away, and indexed by size, so allocations take the smallest free range that fits (best fit). This is the
+/// same good-fit policy as TLSF, using ordered maps instead of segregated bitmaps since we only have a
+/// few thousand ranges at most
+/// </summary>
+class BufferAllocator
+{
+public:
+	/// <summary>
+	/// Returned by Allocate when there is no free range that is big enough
+	/// </summary>
+	static constexpr size_t INVALID_OFFSET = static_cast<size_t>(-1);
+
+	/// <summary>
+	/// Information about how the memory is being used
+	/// </summary>
+	struct Stats {
+		size_t   Capacity;
+		size_t   Used;
+		size_t   Free;
+		size_t   LargestFreeBlock;
+		uint32_t Allocations;
+		uint32_t FreeBlocks;
+		// 0 when all free space is in one block, approaching 1 as the free space gets split into many small blocks
+		float    Fragmentation;
+	};
+
+	BufferAllocator(size_t capacity = 0);
+	~BufferAllocator() = default;
+
+	/// <summary>
+	/// Allocates a range of the given size
+	/// </summary>
+	/// <param name="size">The number of bytes needed</param>
+	/// <param name="alignment">The offset of the range will be a multiple of this (does not need to be a power of 2)</param>
+	/// <returns>The offset of the range, or INVALID_OFFSET if there is no space for it</returns>
+	size_t Allocate(size_t size, size_t alignment = 1);
+	/// <summary>
+	/// Frees a range that was returned by Allocate, merging it with any free neighbours
+	/// </summary>
+	/// <param name="offset">The offset returned by Allocate</param>
+	void Free(size_t offset);
+
+	/// <summary>
+	/// Extends the end of the managed memory, the new space is merged with the last free block if it is at the end
+	/// </summary>
+	/// <param name="capacity">The new capacity, must be larger than the current one</param>
+	void Grow(size_t capacity);
+	/// <summary>
+	/// Frees all allocations, and resets the capacity
+	/// </summary>
+	void Reset(size_t capacity);
+
+	/// <summary>
+	/// Gets the size of an allocation, or 0 if there is no allocation at the given offset
+	/// </summary>
+	size_t GetSize(size_t offset) const;
+	size_t GetCapacity() const { return _capacity; }
+	size_t GetUsed() const { return _used; }
+	/// <summary>
+	/// Calculates the current memory usage stats
+	/// </summary>
+	Stats GetStats() const;
+
+protected:
+	size_t _capacity;
+	size_t _used;
+
+	std::map<size_t, size_t>      _freeByOffset; // Offset -> size of all free blocks
+	std::multimap<size_t, size_t> _freeBySize;   // Size -> offset of all free blocks
+	std::map<size_t, size_t>      _allocations;  // Offset -> size of all allocations
+
+	// Adds a free block, merging it with the blocks on either side of it
+	void _AddFree(size_t offset, size_t size);
+	// Removes a free block from both maps
+	void _RemoveFree(size_t offset, size_t size);
+};
@@ -0,0 +1,149 @@
+#include "Graphics/ClusterMesh.h"
+#include "Graphics/Culling.h"
+#include "Graphics/MeshBounds.h"
+
+#include <algorithm>
+
+ClusterMesh::Sptr ClusterMesh::Build(const glm::vec3* firstPosition, size_t stride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+	Sptr result = std::make_shared<ClusterMesh>();
+	const uint8_t* positions = reinterpret_cast<const uint8_t*>(firstPosition);
+	const uint32_t triangleCount = (indices != nullptr ? indexCount : vertexCount) / 3;
+
+	// The index of each vertex within the current meshlet, or 0xFF if it has not been added to it yet
+	std::vector<uint8_t> localIndex(vertexCount, 0xFF);
+
+	Meshlet current = { 0, 0, 0, 0 };
+	auto flush = [&]() {
+		if (current.TriangleCount == 0) {
+			return;
+		}
+		result->_meshlets.push_back(current);
+		result->_CalculateBounds(positions, stride);
+		for (uint32_t ix = 0; ix < current.VertexCount; ix++) {
+			localIndex[result->_vertices[current.VertexOffset + ix]] = 0xFF;
+		}
+		current.VertexOffset = static_cast<uint32_t>(result->_vertices.size());
+		current.TriangleOffset = static_cast<uint32_t>(result->_triangles.size() / 3);
+		current.VertexCount = 0;
+		current.TriangleCount = 0;
+	};
+
+	// Triangles are added in order, starting a new meshlet whenever the next one doesn't fit. Meshes tend to store
+	// neighbouring triangles near each other, so this keeps the meshlets reasonably compact
+	for (uint32_t tri = 0; tri < triangleCount; tri++) {
+		uint32_t corners[3];
+		for (int ix = 0; ix < 3; ix++) {
+			corners[ix] = indices != nullptr ? indices[tri * 3 + ix] : tri * 3 + ix;
+		}
+		uint32_t newVertices = (localIndex[corners[0]] == 0xFF) + (localIndex[corners[1]] == 0xFF) + (localIndex[corners[2]] == 0xFF);
+		if (current.VertexCount + newVertices > MAX_VERTICES || current.TriangleCount + 1u > MAX_TRIANGLES) {
+			flush();
+		}
+
+		for (int ix = 0; ix < 3; ix++) {
+			uint8_t& local = localIndex[corners[ix]];
+			if (local == 0xFF) {
+				local = current.VertexCount++;
+				result->_vertices.push_back(corners[ix]);
+			}
+			result->_triangles.push_back(local);
+		}
+		current.TriangleCount++;
+	}
+	flush();
+
+	return result;
+}
+
+void ClusterMesh::_CalculateBounds(const uint8_t* positions, size_t stride) {
+	const Meshlet& meshlet = _meshlets.back();
+	auto position = [&](uint8_t local) -> const glm::vec3& {
+		return *reinterpret_cast<const glm::vec3*>(positions + _vertices[meshlet.VertexOffset + local] * stride);
+	};
+
+	// Bounding sphere, using the same method as the whole mesh bounds
+	std::vector<glm::vec3> points(meshlet.VertexCount);
+	for (uint8_t ix = 0; ix < meshlet.VertexCount; ix++) {
+		points[ix] = position(ix);
+	}
+	MeshBounds sphere = MeshBounds::FromPositions(points.data(), points.size());
+
+	// The cone axis is the average of the face normals, and the cutoff comes from the normal furthest from it
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.TriangleCount);
+	glm::vec3 axis = glm::vec3(0.0f);
+	for (uint32_t tri = 0; tri < meshlet.TriangleCount; tri++) {
+		const uint8_t* corners = &_triangles[(meshlet.TriangleOffset + tri) * 3];
+		glm::vec3 normal = glm::cross(position(corners[1]) - position(corners[0]), position(corners[2]) - position(corners[0]));
+		float length = glm::length(normal);
+		// Degenerate triangles can't be seen anyways, so they don't affect the cone
+		if (length > 0.0f) {
+			normals.push_back(normal / length);
+			axis += normal / length;
+		}
+	}
+
+	float cutoff = 1.0f;
+	float axisLength = glm::length(axis);
+	if (axisLength > 0.0f) {
+		axis /= axisLength;
+		float minDot = 1.0f;
+		for (const glm::vec3& normal : normals) {
+			minDot = std::min(minDot, glm::dot(axis, normal));
+		}
+		// If the cone is wider than a hemisphere, some triangle is always facing the camera. Otherwise we store
+		// the sine of the cone's half angle, which is what the culling test needs
+		if (minDot > 0.0f) {
+			cutoff = glm::sqrt(1.0f - minDot * minDot);
+		}
+	}
+
+	MeshletBounds bounds;
+	bounds.Sphere = glm::vec4(sphere.Center, sphere.Radius);
+	bounds.Cone = glm::vec4(axis, cutoff);
+	_bounds.push_back(bounds);
+}
+
+uint32_t ClusterMesh::Cull(const glm::mat4& world, const glm::vec4* frustumPlanes, const glm::vec3& cameraPos, std::vector<uint32_t>& outIndices) {
+	outIndices.clear();
+	const size_t count = _meshlets.size();
+
+	// Frustum test the spheres in world space, in a single batch
+	const float scale = glm::sqrt(std::max({ glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+											  glm::dot(glm::vec3(world[1]), glm::vec3(world[1])),
+											  glm::dot(glm::vec3(world[2]), glm::vec3(world[2])) }));
+	_worldSpheres.resize(count);
+	_visible.resize(count);
+	for (size_t ix = 0; ix < count; ix++) {
+		const glm::vec4& sphere = _bounds[ix].Sphere;
+		_worldSpheres[ix] = glm::vec4(glm::vec3(world * glm::vec4(glm::vec3(sphere), 1.0f)), sphere.w * scale);
+	}
+	Culling::CullSpheres(frustumPlanes, _worldSpheres.data(), count, _visible.data());
+
+	// Whether a triangle faces the camera doesn't change under an affine transform, so we can do the cone
+	// test in model space by moving the camera there instead of moving every cone into world space
+	const glm::vec3 camera = glm::vec3(glm::inverse(world) * glm::vec4(cameraPos, 1.0f));
+
+	uint32_t visibleCount = 0;
+	for (size_t ix = 0; ix < count; ix++) {
+		if (!_visible[ix]) {
+			continue;
+		}
+		// Cull the meshlet if the camera is inside the cone's back side, for every point within the sphere
+		const MeshletBounds& bounds = _bounds[ix];
+		const glm::vec3 toCenter = glm::vec3(bounds.Sphere) - camera;
+		if (glm::dot(toCenter, glm::vec3(bounds.Cone)) >= bounds.Cone.w * glm::length(toCenter) + bounds.Sphere.w) {
+			continue;
+		}
+
+		// Expand the meshlet's local triangles back out to indices into the original vertices
+		const Meshlet& meshlet = _meshlets[ix];
+		const uint8_t* triangles = &_triangles[meshlet.TriangleOffset * 3];
+		const uint32_t* vertices = &_vertices[meshlet.VertexOffset];
+		for (uint32_t corner = 0; corner < meshlet.TriangleCount * 3u; corner++) {
+			outIndices.push_back(vertices[triangles[corner]]);
+		}
+		visibleCount++;
+	}
+	return visibleCount;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A small piece of a mesh (a meshlet), with at most ClusterMesh::MAX_VERTICES vertices and ClusterMesh::MAX_TRIANGLES triangles
+/// </summary>
+struct Meshlet {
+	// The index of the meshlet's first vertex in the cluster mesh's vertex list
+	uint32_t VertexOffset;
+	// The index of the meshlet's first triangle in the cluster mesh's triangle list
+	uint32_t TriangleOffset;
+	uint8_t  VertexCount;
+	uint8_t  TriangleCount;
+};
+
+/// <summary>
+/// The data used to cull a meshlet, kept separate from the meshlets so culling only streams through this.
+/// At 32 bytes, two meshlets fit in a cache line
+/// </summary>
+struct MeshletBounds {
+	// The model space bounding sphere, as (center, radius)
+	glm::vec4 Sphere;
+	// The normal cone, as (axis, cutoff). A cutoff of 1 means the meshlet can never be backface culled
+	glm::vec4 Cone;
+};
+
+/// <summary>
+/// Splits a mesh into meshlets (small clusters of triangles) that can each be culled on their own, so that
+/// only the visible parts of a large mesh get drawn. Each meshlet has a bounding sphere for frustum culling, and
+/// a cone that contains all of it's triangle normals, so meshlets that are entirely facing away from the camera
+/// can be skipped
+///
+/// Meshlets reference the original vertices through a vertex list, and store their triangles as 8 bit indices
+/// into their part of that list, like the layout used by mesh shaders
+/// </summary>
+class ClusterMesh
+{
+public:
+	typedef std::shared_ptr<ClusterMesh> Sptr;
+
+	static const uint32_t MAX_VERTICES = 64;
+	static const uint32_t MAX_TRIANGLES = 124;
+
+	/// <summary>
+	/// Meshes with fewer triangles than this are not worth splitting up, culling the whole object is enough
+	/// </summary>
+	static const uint32_t MIN_CLUSTERED_TRIANGLES = 1024;
+
+	ClusterMesh() = default;
+	~ClusterMesh() = default;
+
+	/// <summary>
+	/// Splits a mesh into meshlets
+	/// </summary>
+	/// <param name="firstPosition">A pointer to the position of the first vertex</param>
+	/// <param name="stride">The size of a vertex in bytes (ex: sizeof(VertexPosNormTexCol))</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="indices">The triangle list indices, or nullptr if the mesh is not indexed</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <returns>The meshlets for the mesh</returns>
+	static Sptr Build(const glm::vec3* firstPosition, size_t stride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+	/// <summary>
+	/// Culls the meshlets against the camera, and writes the indices of the visible triangles into outIndices
+	/// </summary>
+	/// <param name="world">The world transform of the object using this mesh</param>
+	/// <param name="frustumPlanes">The 6 world space frustum planes (see Camera::GetFrustumPlanes)</param>
+	/// <param name="cameraPos">The world space position of the camera</param>
+	/// <param name="outIndices">Receives the indices of all visible triangles, this is cleared first</param>
+	/// <returns>The number of visible meshlets</returns>
+	uint32_t Cull(const glm::mat4& world, const glm::vec4* frustumPlanes, const glm::vec3& cameraPos, std::vector<uint32_t>& outIndices);
+
+	size_t GetMeshletCount() const { return _meshlets.size(); }
+	const std::vector<Meshlet>& GetMeshlets() const { return _meshlets; }
+	const std::vector<MeshletBounds>& GetBounds() const { return _bounds; }
+	uint32_t GetTriangleCount() const { return static_cast<uint32_t>(_triangles.size() / 3); }
+
+protected:
+	std::vector<Meshlet>       _meshlets;
+	std::vector<MeshletBounds> _bounds;
+	std::vector<uint32_t>      _vertices;  // Indices into the original vertices, for all meshlets
+	std::vector<uint8_t>       _triangles; // 3 indices per triangle, relative to the meshlet's VertexOffset
+
+	// Scratch space for culling, so we don't allocate every frame
+	std::vector<glm::vec4> _worldSpheres;
+	std::vector<uint8_t>   _visible;
+
+	// Calculates the bounds for the last meshlet that was added
+	void _CalculateBounds(const uint8_t* positions, size_t stride);
+};
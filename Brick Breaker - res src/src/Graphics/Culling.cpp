@@ -0,0 +1,79 @@
+#include "Graphics/Culling.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CULLING_HAS_SSE 1
+	#include <emmintrin.h>
+#endif
+
+glm::vec4 Culling::TransformSphere(const MeshBounds& bounds, const glm::mat4& world) {
+	if (!bounds.IsValid()) {
+		return glm::vec4(0.0f, 0.0f, 0.0f, FLT_MAX);
+	}
+	// Non-uniform scale stretches the sphere, so we need to use the largest axis to stay conservative
+	const float scaleSq = glm::max(
+		glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+		glm::max(glm::dot(glm::vec3(world[1]), glm::vec3(world[1])), glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))));
+	const glm::vec3 center = glm::vec3(world * glm::vec4(bounds.Center, 1.0f));
+	return glm::vec4(center, bounds.Radius * glm::sqrt(scaleSq));
+}
+
+// Tests a single sphere against all the planes
+static inline bool IsSphereVisible(const glm::vec4* planes, const glm::vec4& sphere) {
+	for (int plane = 0; plane < 6; plane++) {
+		if (glm::dot(glm::vec3(planes[plane]), glm::vec3(sphere)) + planes[plane].w < -sphere.w) {
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t Culling::CullSpheres(const glm::vec4* planes, const glm::vec4* spheres, size_t count, uint8_t* outVisible) {
+	uint32_t visibleCount = 0;
+	size_t ix = 0;
+
+	#if CULLING_HAS_SSE
+	// Splat each plane component across a register, so we can test 4 spheres against a plane at once
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int plane = 0; plane < 6; plane++) {
+		planeX[plane] = _mm_set1_ps(planes[plane].x);
+		planeY[plane] = _mm_set1_ps(planes[plane].y);
+		planeZ[plane] = _mm_set1_ps(planes[plane].z);
+		planeW[plane] = _mm_set1_ps(planes[plane].w);
+	}
+
+	for (; ix + 4 <= count; ix += 4) {
+		// Load 4 spheres and transpose them, so each register holds one component for all 4 spheres
+		__m128 x = _mm_loadu_ps(&spheres[ix + 0].x);
+		__m128 y = _mm_loadu_ps(&spheres[ix + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[ix + 2].x);
+		__m128 r = _mm_loadu_ps(&spheres[ix + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+		const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+
+		// A sphere is outside the frustum if it is entirely behind any one of the planes
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int plane = 0; plane < 6; plane++) {
+			__m128 dist = _mm_mul_ps(planeX[plane], x);
+			dist = _mm_add_ps(dist, _mm_mul_ps(planeY[plane], y));
+			dist = _mm_add_ps(dist, _mm_mul_ps(planeZ[plane], z));
+			dist = _mm_add_ps(dist, planeW[plane]);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+		}
+
+		const int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++) {
+			const uint8_t visible = (mask >> lane) & 1;
+			outVisible[ix + lane] = visible;
+			visibleCount += visible;
+		}
+	}
+	#endif
+
+	// Handle whatever is left over (or everything, if we don't have SSE)
+	for (; ix < count; ix++) {
+		outVisible[ix] = IsSphereVisible(planes, spheres[ix]) ? 1 : 0;
+		visibleCount += outVisible[ix];
+	}
+
+	return visibleCount;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+#include "Graphics/MeshBounds.h"
+
+/// <summary>
+/// Helpers for view frustum culling with bounding spheres. Spheres are stored as a vec4 of (center, radius),
+/// and planes as (normal, distance) with normals facing into the frustum (see Camera::GetFrustumPlanes)
+/// </summary>
+class Culling {
+public:
+	Culling() = delete;
+
+	/// <summary>
+	/// Transforms a mesh's model space bounding sphere into world space. Meshes without valid bounds get
+	/// an infinite sphere, so they will never be culled
+	/// </summary>
+	/// <param name="bounds">The mesh's bounds</param>
+	/// <param name="world">The world transform of the object using the mesh</param>
+	/// <returns>The world space bounding sphere, as (center, radius)</returns>
+	static glm::vec4 TransformSphere(const MeshBounds& bounds, const glm::mat4& world);
+
+	/// <summary>
+	/// Tests a batch of spheres against the 6 planes of a view frustum, 4 spheres at a time when SSE is available
+	/// </summary>
+	/// <param name="planes">The 6 frustum planes to test against</param>
+	/// <param name="spheres">The spheres to test, as (center, radius)</param>
+	/// <param name="count">The number of spheres to test</param>
+	/// <param name="outVisible">Array that receives 1 for every sphere that is at least partially inside the frustum, and 0 otherwise</param>
+	/// <returns>The number of visible spheres</returns>
+	static uint32_t CullSpheres(const glm::vec4* planes, const glm::vec4* spheres, size_t count, uint8_t* outVisible);
+};
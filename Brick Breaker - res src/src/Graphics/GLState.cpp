@@ -0,0 +1,149 @@
+#include "Graphics/GLState.h"
+#include "Logging.h"
+
+// A new context starts with nothing bound, so we can start the cache off as all zeroes
+GLuint GLState::_program = 0;
+GLuint GLState::_textures[GLState::MAX_TRACKED_TEXTURE_UNITS] = { 0 };
+GLenum GLState::_textureTargets[GLState::MAX_TRACKED_TEXTURE_UNITS] = { 0 }; // Unknown targets are validated as 2D
+GLuint GLState::_vertexArray = 0;
+#ifdef _DEBUG
+bool GLState::_isValidating = true;
+#else
+bool GLState::_isValidating = false;
+#endif
+GLState::Stats GLState::_stats = GLState::Stats();
+
+void GLState::UseProgram(GLuint program) {
+	_stats.Requested++;
+	if (_isValidating) {
+		_ValidateProgram();
+	}
+	if (_program != program) {
+		glUseProgram(program);
+		_program = program;
+		_stats.Issued++;
+		_stats.ProgramBinds++;
+	}
+}
+
+void GLState::BindTextureUnit(uint32_t unit, GLuint texture, GLenum target) {
+	_stats.Requested++;
+	if (unit >= MAX_TRACKED_TEXTURE_UNITS) {
+		glBindTextureUnit(unit, texture);
+		_stats.Issued++;
+		_stats.TextureBinds++;
+		return;
+	}
+	if (_isValidating) {
+		_ValidateTexture(unit);
+	}
+	if (_textures[unit] != texture) {
+		glBindTextureUnit(unit, texture);
+		_textures[unit] = texture;
+		_stats.Issued++;
+		_stats.TextureBinds++;
+	}
+	_textureTargets[unit] = target;
+}
+
+void GLState::BindVertexArray(GLuint vao) {
+	_stats.Requested++;
+	if (_isValidating) {
+		_ValidateVertexArray();
+	}
+	if (_vertexArray != vao) {
+		glBindVertexArray(vao);
+		_vertexArray = vao;
+		_stats.Issued++;
+		_stats.VertexArrayBinds++;
+	}
+}
+
+void GLState::OnTextureDeleted(GLuint texture) {
+	for (uint32_t ix = 0; ix < MAX_TRACKED_TEXTURE_UNITS; ix++) {
+		if (_textures[ix] == texture) {
+			_textures[ix] = 0;
+		}
+	}
+}
+
+void GLState::OnVertexArrayDeleted(GLuint vao) {
+	if (_vertexArray == vao) {
+		_vertexArray = 0;
+	}
+}
+
+void GLState::Invalidate() {
+	_program = UNKNOWN;
+	_vertexArray = UNKNOWN;
+	for (uint32_t ix = 0; ix < MAX_TRACKED_TEXTURE_UNITS; ix++) {
+		_textures[ix] = UNKNOWN;
+		_textureTargets[ix] = GL_TEXTURE_2D;
+	}
+}
+
+bool GLState::Validate() {
+	bool result = _ValidateProgram();
+	result &= _ValidateVertexArray();
+	for (uint32_t ix = 0; ix < MAX_TRACKED_TEXTURE_UNITS; ix++) {
+		result &= _ValidateTexture(ix);
+	}
+	return result;
+}
+
+void GLState::ResetStats() {
+	_stats = Stats();
+}
+
+bool GLState::_ValidateProgram() {
+	if (_program == UNKNOWN) return true;
+	GLint actual = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &actual);
+	if ((GLuint)actual != _program) {
+		LOG_ERROR("GL state mismatch: expected program {} but {} is bound", _program, actual);
+		_program = actual;
+		return false;
+	}
+	return true;
+}
+
+bool GLState::_ValidateTexture(uint32_t unit) {
+	if (_textures[unit] == UNKNOWN) return true;
+
+	// Texture bindings are per target, so we need to query the one we last bound
+	GLenum binding;
+	switch (_textureTargets[unit]) {
+		case GL_TEXTURE_1D:             binding = GL_TEXTURE_BINDING_1D; break;
+		case GL_TEXTURE_3D:             binding = GL_TEXTURE_BINDING_3D; break;
+		case GL_TEXTURE_CUBE_MAP:       binding = GL_TEXTURE_BINDING_CUBE_MAP; break;
+		case GL_TEXTURE_2D_MULTISAMPLE: binding = GL_TEXTURE_BINDING_2D_MULTISAMPLE; break;
+		default:                        binding = GL_TEXTURE_BINDING_2D; break;
+	}
+
+	// Querying a unit's binding requires making it active, so we need to restore the active unit afterwards
+	GLint activeUnit = 0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeUnit);
+	glActiveTexture(GL_TEXTURE0 + unit);
+	GLint actual = 0;
+	glGetIntegerv(binding, &actual);
+	glActiveTexture(activeUnit);
+
+	if ((GLuint)actual != _textures[unit]) {
+		LOG_ERROR("GL state mismatch: expected texture {} on unit {} but {} is bound", _textures[unit], unit, actual);
+		_textures[unit] = actual;
+		return false;
+	}
+	return true;
+}
+
+bool GLState::_ValidateVertexArray() {
+	if (_vertexArray == UNKNOWN) return true;
+	GLint actual = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &actual);
+	if ((GLuint)actual != _vertexArray) {
+		LOG_ERROR("GL state mismatch: expected vertex array {} but {} is bound", _vertexArray, actual);
+		_vertexArray = actual;
+		return false;
+	}
+	return true;
+}
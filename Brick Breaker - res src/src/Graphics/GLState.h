@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <glad/glad.h>
+
+/// <summary>
+/// Tracks the OpenGL state that our wrapper classes bind (the current program, the texture bound to each unit
+/// and the current vertex array), so that binding something that is already bound does not make a driver call
+///
+/// All binds of these objects should go through this class, otherwise the cache will fall out of sync with
+/// OpenGL. If some outside code changes the state without restoring it, call Invalidate afterwards
+///
+/// When validation is enabled, every bind checks the cached state against OpenGL with glGet*, and logs an
+/// error when they don't match. This is slow, so it's off by default outside of debug builds
+/// </summary>
+class GLState {
+public:
+	GLState() = delete;
+
+	/// <summary>
+	/// Counts of the binds made since the last call to ResetStats
+	/// </summary>
+	struct Stats {
+		// Binds that were requested through this class
+		uint32_t Requested;
+		// Binds that actually made it to OpenGL
+		uint32_t Issued;
+		// Issued binds, by type
+		uint32_t ProgramBinds;
+		uint32_t TextureBinds;
+		uint32_t VertexArrayBinds;
+	};
+
+	/// <summary>
+	/// The number of texture units that we cache, binds to units past this always go to OpenGL
+	/// </summary>
+	static const uint32_t MAX_TRACKED_TEXTURE_UNITS = 32;
+
+	/// <summary>
+	/// Makes the given shader program current, if it is not already
+	/// </summary>
+	/// <param name="program">The handle of the program, or 0 to unbind</param>
+	static void UseProgram(GLuint program);
+	/// <summary>
+	/// Binds a texture to the given texture unit, if it is not already bound there
+	/// </summary>
+	/// <param name="unit">The texture unit to bind to</param>
+	/// <param name="texture">The handle of the texture, or 0 to unbind</param>
+	/// <param name="target">The type of the texture, only used for validation</param>
+	static void BindTextureUnit(uint32_t unit, GLuint texture, GLenum target = GL_TEXTURE_2D);
+	/// <summary>
+	/// Binds the given vertex array, if it is not already bound
+	/// </summary>
+	/// <param name="vao">The handle of the vertex array, or 0 to unbind</param>
+	static void BindVertexArray(GLuint vao);
+
+	/// <summary>
+	/// Should be called when a texture is deleted. OpenGL unbinds deleted textures, and the handle may be
+	/// reused for a new texture, so we need to forget about it
+	/// </summary>
+	static void OnTextureDeleted(GLuint texture);
+	/// <summary>
+	/// Should be called when a vertex array is deleted, see OnTextureDeleted
+	/// </summary>
+	static void OnVertexArrayDeleted(GLuint vao);
+
+	static GLuint GetProgram() { return _program; }
+	static GLuint GetTexture(uint32_t unit) { return unit < MAX_TRACKED_TEXTURE_UNITS ? _textures[unit] : UNKNOWN; }
+	static GLuint GetVertexArray() { return _vertexArray; }
+
+	/// <summary>
+	/// Forgets all cached state, so the next bind of everything goes to OpenGL
+	/// </summary>
+	static void Invalidate();
+
+	/// <summary>
+	/// Checks all of the cached state against OpenGL, logging an error for anything that does not match
+	/// </summary>
+	/// <returns>True if the cache matches OpenGL</returns>
+	static bool Validate();
+	/// <summary>
+	/// Enables or disables checking the cache against OpenGL on every bind
+	/// </summary>
+	static void SetValidationEnabled(bool enabled) { _isValidating = enabled; }
+	static bool IsValidationEnabled() { return _isValidating; }
+
+	/// <summary>
+	/// Gets the bind counts since the last call to ResetStats
+	/// </summary>
+	static const Stats& GetStats() { return _stats; }
+	/// <summary>
+	/// Resets the bind counts, should be called once per frame
+	/// </summary>
+	static void ResetStats();
+
+protected:
+	// Marks state that we don't know, since 0 is a valid value to have bound
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+	static GLuint _program;
+	static GLuint _textures[MAX_TRACKED_TEXTURE_UNITS];
+	static GLenum _textureTargets[MAX_TRACKED_TEXTURE_UNITS];
+	static GLuint _vertexArray;
+
+	static bool  _isValidating;
+	static Stats _stats;
+
+	// Checks a single cached value against OpenGL
+	static bool _ValidateProgram();
+	static bool _ValidateTexture(uint32_t unit);
+	static bool _ValidateVertexArray();
+};
@@ -0,0 +1,331 @@
+#include "Graphics/GeometryPool.h"
+#include "Graphics/GLState.h"
+#include "Logging.h"
+
+#include <algorithm>
+
+// Reads a mesh's indices back from the GPU, widening them to 32 bit. Leaves the indices empty if the mesh is not indexed
+static void ReadIndices(const VertexArrayObject& mesh, std::vector<uint32_t>& indices) {
+	const IndexBuffer::Sptr& indexBuffer = mesh.GetIndexBuffer();
+	indices.clear();
+	if (indexBuffer == nullptr) {
+		return;
+	}
+	std::vector<uint8_t> data(indexBuffer->GetTotalSize());
+	glGetNamedBufferSubData(indexBuffer->GetHandle(), 0, data.size(), data.data());
+	indices.resize(indexBuffer->GetElementCount());
+	for (size_t ix = 0; ix < indices.size(); ix++) {
+		switch (indexBuffer->GetElementType()) {
+			case IndexType::UByte:  indices[ix] = data[ix]; break;
+			case IndexType::UShort: indices[ix] = reinterpret_cast<const uint16_t*>(data.data())[ix]; break;
+			default:                indices[ix] = reinterpret_cast<const uint32_t*>(data.data())[ix]; break;
+		}
+	}
+}
+
+GeometryPool::GeometryPool(size_t vertexCapacity, size_t indexCapacity) :
+	_vertexBuffer(0),
+	_indexBuffer(0),
+	_drawIndexBuffer(0),
+	_drawIndexCapacity(0),
+	_vertexSpace(BufferAllocator(vertexCapacity)),
+	_indexSpace(BufferAllocator(indexCapacity)),
+	_layouts(std::vector<Layout>()),
+	_allocations(std::unordered_set<GeometryAllocation*>())
+{
+	glCreateBuffers(1, &_vertexBuffer);
+	glNamedBufferData(_vertexBuffer, vertexCapacity, nullptr, GL_STATIC_DRAW);
+	glCreateBuffers(1, &_indexBuffer);
+	glNamedBufferData(_indexBuffer, indexCapacity, nullptr, GL_STATIC_DRAW);
+	glCreateBuffers(1, &_drawIndexBuffer);
+	ReserveDrawIndices(1);
+}
+
+GeometryPool::~GeometryPool() {
+	if (_allocations.size() > 0) {
+		LOG_WARN("Geometry pool destroyed with {} meshes still allocated", _allocations.size());
+	}
+	for (GeometryAllocation* allocation : _allocations) {
+		delete allocation;
+	}
+	_allocations.clear();
+
+	for (Layout& layout : _layouts) {
+		GLState::OnVertexArrayDeleted(layout.VertexArray);
+		glDeleteVertexArrays(1, &layout.VertexArray);
+	}
+	_layouts.clear();
+	glDeleteBuffers(1, &_vertexBuffer);
+	glDeleteBuffers(1, &_indexBuffer);
+	glDeleteBuffers(1, &_drawIndexBuffer);
+}
+
+GeometryAllocation* GeometryPool::Allocate(const void* vertices, uint32_t vertexCount, const std::vector<BufferAttribute>& attributes, const uint32_t* indices, uint32_t indexCount) {
+	if (vertexCount == 0 || attributes.size() == 0) {
+		return nullptr;
+	}
+	const GLsizei stride = attributes[0].Stride;
+	for (const BufferAttribute& attrib : attributes) {
+		if (attrib.Stride != stride) {
+			LOG_WARN("Cannot pool a mesh whose attributes have different strides");
+			return nullptr;
+		}
+	}
+	const size_t vertexSize = (size_t)vertexCount * stride;
+
+	// Meshes without indices still get them, so every pooled mesh can be drawn the same way
+	std::vector<uint32_t> generatedIndices;
+	if (indices == nullptr || indexCount == 0) {
+		generatedIndices.resize(vertexCount);
+		for (uint32_t ix = 0; ix < vertexCount; ix++) {
+			generatedIndices[ix] = ix;
+		}
+		indices = generatedIndices.data();
+		indexCount = vertexCount;
+	}
+	const size_t indexSize = (size_t)indexCount * sizeof(uint32_t);
+
+	// If the free space is there but it's been split up too much to fit this mesh, pack the meshes together before resorting to growing
+	BufferAllocator::Stats vertexStats = _vertexSpace.GetStats();
+	BufferAllocator::Stats indexStats = _indexSpace.GetStats();
+	if ((vertexStats.LargestFreeBlock < vertexSize + stride && vertexStats.Free >= vertexSize + stride) ||
+		(indexStats.LargestFreeBlock < indexSize && indexStats.Free >= indexSize)) {
+		Defragment();
+	}
+
+	GeometryAllocation* result = new GeometryAllocation();
+	result->VertexArray = GetVertexArray(attributes);
+	result->VertexStride = stride;
+	result->VertexCount = vertexCount;
+	result->VertexOffset = _AllocateRange(_vertexSpace, _vertexBuffer, vertexSize, stride);
+	result->IndexCount = indexCount;
+	result->IndexOffset = _AllocateRange(_indexSpace, _indexBuffer, indexSize, sizeof(uint32_t));
+	_allocations.insert(result);
+
+	glNamedBufferSubData(_vertexBuffer, result->VertexOffset, vertexSize, vertices);
+	glNamedBufferSubData(_indexBuffer, result->IndexOffset, indexSize, indices);
+	return result;
+}
+
+GeometryAllocation* GeometryPool::Copy(const VertexArrayObject& mesh, const VertexArrayObject* vertexSource) {
+	const std::vector<VertexArrayObject::VertexBufferBinding>& buffers = mesh.GetVertexBuffers();
+	if (buffers.size() != 1 || buffers[0].Attributes.size() == 0) {
+		return nullptr;
+	}
+	const VertexBuffer::Sptr& vertexBuffer = buffers[0].Buffer;
+
+	// We store everything as 32 bit indices, so smaller types need to be widened
+	std::vector<uint32_t> indices;
+	ReadIndices(mesh, indices);
+
+	// If the source's copy came from the same vertex buffer, we only need to add our indices
+	GeometryAllocation* source = vertexSource != nullptr ? vertexSource->GetPoolAllocation() : nullptr;
+	if (source != nullptr && source->VertexSource != nullptr) {
+		source = source->VertexSource;
+	}
+	if (source != nullptr && indices.size() > 0 && _allocations.count(source) > 0 &&
+		vertexSource->GetVertexBuffers().size() == 1 && vertexSource->GetVertexBuffers()[0].Buffer == vertexBuffer &&
+		source->VertexCount == vertexBuffer->GetElementCount()) {
+		const size_t indexSize = indices.size() * sizeof(uint32_t);
+		BufferAllocator::Stats indexStats = _indexSpace.GetStats();
+		if (indexStats.LargestFreeBlock < indexSize && indexStats.Free >= indexSize) {
+			Defragment();
+		}
+
+		GeometryAllocation* result = new GeometryAllocation();
+		result->VertexArray = source->VertexArray;
+		result->VertexStride = source->VertexStride;
+		result->VertexCount = source->VertexCount;
+		result->VertexOffset = source->VertexOffset;
+		result->VertexSource = source;
+		result->IndexCount = static_cast<uint32_t>(indices.size());
+		result->IndexOffset = _AllocateRange(_indexSpace, _indexBuffer, indexSize, sizeof(uint32_t));
+		source->VertexUsers++;
+		_allocations.insert(result);
+
+		glNamedBufferSubData(_indexBuffer, result->IndexOffset, indexSize, indices.data());
+		return result;
+	}
+
+	// Copy the vertices straight out of the mesh's buffer
+	std::vector<uint8_t> vertices(vertexBuffer->GetTotalSize());
+	glGetNamedBufferSubData(vertexBuffer->GetHandle(), 0, vertices.size(), vertices.data());
+	return Allocate(vertices.data(), static_cast<uint32_t>(vertexBuffer->GetElementCount()), buffers[0].Attributes,
+					indices.data(), static_cast<uint32_t>(indices.size()));
+}
+
+void GeometryPool::Free(GeometryAllocation* allocation) {
+	if (allocation == nullptr) {
+		return;
+	}
+	auto it = _allocations.find(allocation);
+	LOG_ASSERT(it != _allocations.end(), "Tried to free a mesh that is not in this geometry pool!");
+	LOG_ASSERT(!allocation->Released, "Tried to free a mesh that was already freed!");
+	_indexSpace.Free(allocation->IndexOffset);
+	allocation->IndexOffset = BufferAllocator::INVALID_OFFSET;
+	allocation->IndexCount = 0;
+
+	// Meshes using another mesh's vertices may be the last thing keeping them alive
+	GeometryAllocation* source = allocation->VertexSource;
+	if (source != nullptr) {
+		_allocations.erase(it);
+		delete allocation;
+		source->VertexUsers--;
+		if (source->Released && source->VertexUsers == 0) {
+			_vertexSpace.Free(source->VertexOffset);
+			_allocations.erase(source);
+			delete source;
+		}
+	} else if (allocation->VertexUsers > 0) {
+		allocation->Released = true;
+	} else {
+		_vertexSpace.Free(allocation->VertexOffset);
+		_allocations.erase(it);
+		delete allocation;
+	}
+}
+
+uint32_t GeometryPool::Defragment() {
+	// Visit the meshes in the order they are stored, so packing them keeps them in roughly the same order. Meshes
+	// using another mesh's vertices come after it, so it will already have been moved when we get to them
+	std::vector<GeometryAllocation*> sorted(_allocations.begin(), _allocations.end());
+	std::sort(sorted.begin(), sorted.end(), [](const GeometryAllocation* a, const GeometryAllocation* b) {
+		if (a->VertexOffset != b->VertexOffset) {
+			return a->VertexOffset < b->VertexOffset;
+		}
+		return a->VertexSource == nullptr && b->VertexSource != nullptr;
+	});
+
+	// We copy into new buffers, since copying between overlapping ranges of the same buffer is not allowed
+	GLuint vertexBuffer = 0, indexBuffer = 0;
+	glCreateBuffers(1, &vertexBuffer);
+	glNamedBufferData(vertexBuffer, _vertexSpace.GetCapacity(), nullptr, GL_STATIC_DRAW);
+	glCreateBuffers(1, &indexBuffer);
+	glNamedBufferData(indexBuffer, _indexSpace.GetCapacity(), nullptr, GL_STATIC_DRAW);
+	_vertexSpace.Reset(_vertexSpace.GetCapacity());
+	_indexSpace.Reset(_indexSpace.GetCapacity());
+
+	uint32_t moved = 0;
+	for (GeometryAllocation* allocation : sorted) {
+		// Everything fit before, so everything will fit when packed
+		size_t vertexOffset = allocation->VertexSource != nullptr ? allocation->VertexSource->VertexOffset : allocation->VertexOffset;
+		if (allocation->VertexSource == nullptr) {
+			const size_t vertexSize = (size_t)allocation->VertexCount * allocation->VertexStride;
+			vertexOffset = _vertexSpace.Allocate(vertexSize, allocation->VertexStride);
+			glCopyNamedBufferSubData(_vertexBuffer, vertexBuffer, allocation->VertexOffset, vertexOffset, vertexSize);
+		}
+		// Released meshes only have their vertices left
+		size_t indexOffset = allocation->IndexOffset;
+		if (!allocation->Released) {
+			const size_t indexSize = (size_t)allocation->IndexCount * sizeof(uint32_t);
+			indexOffset = _indexSpace.Allocate(indexSize, sizeof(uint32_t));
+			glCopyNamedBufferSubData(_indexBuffer, indexBuffer, allocation->IndexOffset, indexOffset, indexSize);
+		}
+
+		if (vertexOffset != allocation->VertexOffset || indexOffset != allocation->IndexOffset) {
+			moved++;
+		}
+		allocation->VertexOffset = vertexOffset;
+		allocation->IndexOffset = indexOffset;
+	}
+
+	glDeleteBuffers(1, &_vertexBuffer);
+	glDeleteBuffers(1, &_indexBuffer);
+	_vertexBuffer = vertexBuffer;
+	_indexBuffer = indexBuffer;
+	_BindLayouts();
+	return moved;
+}
+
+void GeometryPool::ReserveDrawIndices(uint32_t count) {
+	if (count <= _drawIndexCapacity) {
+		return;
+	}
+	// Grow to the next power of 2, so we don't need to re-upload every time a few objects are added
+	uint32_t capacity = _drawIndexCapacity > 0 ? _drawIndexCapacity : 64;
+	while (capacity < count) {
+		capacity *= 2;
+	}
+
+	std::vector<uint32_t> drawIndices(capacity);
+	for (uint32_t ix = 0; ix < capacity; ix++) {
+		drawIndices[ix] = ix;
+	}
+	// The buffer keeps it's handle when it's data is reloaded, so the VAOs do not need to be updated
+	glNamedBufferData(_drawIndexBuffer, capacity * sizeof(uint32_t), drawIndices.data(), GL_STATIC_DRAW);
+	_drawIndexCapacity = capacity;
+}
+
+GLuint GeometryPool::GetVertexArray(const std::vector<BufferAttribute>& attributes) {
+	for (const Layout& layout : _layouts) {
+		if (layout.Attributes.size() != attributes.size() || layout.Stride != attributes[0].Stride) {
+			continue;
+		}
+		bool matches = true;
+		for (size_t ix = 0; ix < attributes.size() && matches; ix++) {
+			const BufferAttribute& a = layout.Attributes[ix];
+			const BufferAttribute& b = attributes[ix];
+			matches = a.Slot == b.Slot && a.Size == b.Size && a.Type == b.Type && a.Normalized == b.Normalized && a.Offset == b.Offset;
+		}
+		if (matches) {
+			return layout.VertexArray;
+		}
+	}
+
+	// We use the separate attribute format API, so the buffers can be swapped out later without respecifying the attributes
+	Layout layout;
+	layout.Attributes = attributes;
+	layout.Stride = attributes[0].Stride;
+	glCreateVertexArrays(1, &layout.VertexArray);
+	for (const BufferAttribute& attrib : attributes) {
+		glEnableVertexArrayAttrib(layout.VertexArray, attrib.Slot);
+		glVertexArrayAttribFormat(layout.VertexArray, attrib.Slot, attrib.Size, (GLenum)attrib.Type, attrib.Normalized, attrib.Offset);
+		glVertexArrayAttribBinding(layout.VertexArray, attrib.Slot, 0);
+	}
+	glVertexArrayVertexBuffer(layout.VertexArray, 0, _vertexBuffer, 0, layout.Stride);
+	glVertexArrayElementBuffer(layout.VertexArray, _indexBuffer);
+
+	// The draw index advances once per instance, so with an instance count of 1 it is just the command's base instance
+	const bool usesDrawIndexSlot = std::any_of(attributes.begin(), attributes.end(), [](const BufferAttribute& attrib) {
+		return attrib.Slot == DRAW_INDEX_SLOT;
+	});
+	if (!usesDrawIndexSlot) {
+		glEnableVertexArrayAttrib(layout.VertexArray, DRAW_INDEX_SLOT);
+		glVertexArrayAttribIFormat(layout.VertexArray, DRAW_INDEX_SLOT, 1, GL_UNSIGNED_INT, 0);
+		glVertexArrayAttribBinding(layout.VertexArray, DRAW_INDEX_SLOT, DRAW_INDEX_SLOT);
+		glVertexArrayBindingDivisor(layout.VertexArray, DRAW_INDEX_SLOT, 1);
+		glVertexArrayVertexBuffer(layout.VertexArray, DRAW_INDEX_SLOT, _drawIndexBuffer, 0, sizeof(uint32_t));
+	}
+	_layouts.push_back(layout);
+	return layout.VertexArray;
+}
+
+size_t GeometryPool::_AllocateRange(BufferAllocator& space, GLuint& buffer, size_t size, size_t alignment) {
+	size_t offset = space.Allocate(size, alignment);
+	while (offset == BufferAllocator::INVALID_OFFSET) {
+		// Grow geometrically, so adding lots of meshes one at a time doesn't copy the buffer every time
+		_GrowBuffer(space, buffer, std::max<size_t>(space.GetCapacity() * 2, size + alignment));
+		offset = space.Allocate(size, alignment);
+	}
+	return offset;
+}
+
+void GeometryPool::_GrowBuffer(BufferAllocator& space, GLuint& buffer, size_t capacity) {
+	GLuint newBuffer = 0;
+	glCreateBuffers(1, &newBuffer);
+	glNamedBufferData(newBuffer, capacity, nullptr, GL_STATIC_DRAW);
+	if (space.GetCapacity() > 0) {
+		glCopyNamedBufferSubData(buffer, newBuffer, 0, 0, space.GetCapacity());
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = newBuffer;
+	space.Grow(capacity);
+	_BindLayouts();
+}
+
+void GeometryPool::_BindLayouts() {
+	for (const Layout& layout : _layouts) {
+		glVertexArrayVertexBuffer(layout.VertexArray, 0, _vertexBuffer, 0, layout.Stride);
+		glVertexArrayElementBuffer(layout.VertexArray, _indexBuffer);
+	}
+}
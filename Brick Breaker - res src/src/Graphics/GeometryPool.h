@@ -0,0 +1,185 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/BufferAllocator.h"
+
+/// <summary>
+/// The range of the geometry pool's shared buffers that holds a single mesh. Owned by the pool, the offsets
+/// may change when the pool is defragmented, so they should be read at draw time rather than cached
+/// </summary>
+struct GeometryAllocation {
+	/// <summary>
+	/// The shared VAO for this mesh's vertex layout
+	/// </summary>
+	GLuint   VertexArray;
+	/// <summary>
+	/// The offset of the first vertex in the shared vertex buffer, in bytes
+	/// </summary>
+	size_t   VertexOffset;
+	GLsizei  VertexStride;
+	uint32_t VertexCount;
+	/// <summary>
+	/// The offset of the first index in the shared index buffer, in bytes
+	/// </summary>
+	size_t   IndexOffset;
+	uint32_t IndexCount;
+	/// <summary>
+	/// The allocation whose vertices this mesh uses, or nullptr if it has it's own (see GeometryPool::Copy)
+	/// </summary>
+	GeometryAllocation* VertexSource;
+	/// <summary>
+	/// The number of other allocations using this allocation's vertices
+	/// </summary>
+	uint32_t VertexUsers;
+	/// <summary>
+	/// True once the mesh has been freed, but it's vertices are kept around since other meshes are still using them
+	/// </summary>
+	bool     Released;
+
+	/// <summary>
+	/// Gets the value to pass as the base vertex when drawing, the indices are relative to the mesh's first vertex
+	/// </summary>
+	GLint GetBaseVertex() const { return static_cast<GLint>(VertexOffset / VertexStride); }
+	/// <summary>
+	/// Gets the index of the mesh's first index in the shared index buffer, for indirect draw commands
+	/// </summary>
+	uint32_t GetFirstIndex() const { return static_cast<uint32_t>(IndexOffset / sizeof(uint32_t)); }
+};
+
+/// <summary>
+/// Stores lots of small meshes in a couple of large shared GL buffers, rather than each mesh creating it's own
+/// vertex and index buffers and VAO. Each vertex layout gets one VAO that all meshes using that layout share,
+/// so drawing different pooled meshes does not need to bind a new VAO, only change the draw offsets
+///
+/// Ranges of the buffers are handed out with a BufferAllocator. Vertex ranges are aligned to their stride so
+/// they can be drawn with a base vertex, and indices are always stored as 32 bit. When meshes are freed the
+/// buffers will slowly fragment, Defragment packs all the live meshes back to the start of the buffers
+///
+/// Since every pooled mesh with the same layout is in the same VAO, they can all be drawn together with
+/// glMultiDrawElementsIndirect (see IndirectRenderer). Each shared VAO has a per-instance draw index attribute
+/// in slot 4 for this, and each indirect command sets it's base instance to the index of the object it is drawing,
+/// which the shader uses to look up the object's data
+/// </summary>
+class GeometryPool
+{
+public:
+	typedef std::shared_ptr<GeometryPool> Sptr;
+
+	/// <summary>
+	/// Generated meshes with more vertex data than this are not worth pooling, and will get their own buffers (see MeshBuilder::Bake)
+	/// </summary>
+	static const size_t MAX_POOLED_MESH_SIZE = 256 * 1024;
+	/// <summary>
+	/// The vertex attribute slot that receives the draw index
+	/// </summary>
+	static const uint32_t DRAW_INDEX_SLOT = 4;
+
+	static inline Sptr Create(size_t vertexCapacity = 4 * 1024 * 1024, size_t indexCapacity = 1024 * 1024) {
+		return std::make_shared<GeometryPool>(vertexCapacity, indexCapacity);
+	}
+
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	GeometryPool(const GeometryPool& other) = delete;
+	GeometryPool(GeometryPool&& other) = delete;
+	GeometryPool& operator=(const GeometryPool& other) = delete;
+	GeometryPool& operator=(GeometryPool&& other) = delete;
+
+	/// <summary>
+	/// Creates a new geometry pool
+	/// </summary>
+	/// <param name="vertexCapacity">The initial size of the shared vertex buffer, in bytes</param>
+	/// <param name="indexCapacity">The initial size of the shared index buffer, in bytes</param>
+	GeometryPool(size_t vertexCapacity, size_t indexCapacity);
+	~GeometryPool();
+
+	/// <summary>
+	/// Copies a mesh into the pool, growing the buffers if there is not enough space
+	/// </summary>
+	/// <param name="vertices">The interleaved vertex data</param>
+	/// <param name="vertexCount">The number of vertices in the data</param>
+	/// <param name="attributes">The attributes of the vertex data, must all use the same stride</param>
+	/// <param name="indices">The indices for the mesh, or nullptr if the mesh is not indexed</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <returns>The mesh's allocation, or nullptr if the mesh is empty or it's attributes can't share a buffer</returns>
+	GeometryAllocation* Allocate(const void* vertices, uint32_t vertexCount, const std::vector<BufferAttribute>& attributes, const uint32_t* indices, uint32_t indexCount);
+	/// <summary>
+	/// Copies a mesh that has it's own buffers into the pool, by reading it's data back from the GPU. The mesh keeps
+	/// it's own buffers, so this is for meshes that need them but should also be drawn with the rest of the pool
+	///
+	/// Meshes that share a vertex buffer with one that has already been copied (ex: LODs) can pass it as the vertex
+	/// source, and will use the source's vertices in the pool, only adding their own indices
+	/// </summary>
+	/// <param name="mesh">The mesh to copy, must have a single vertex buffer</param>
+	/// <param name="vertexSource">A mesh that was already copied to this pool, that may have the same vertex buffer as the mesh</param>
+	/// <returns>The copy's allocation (see VertexArrayObject::SetPoolCopy), or nullptr if the mesh's layout can't be pooled</returns>
+	GeometryAllocation* Copy(const VertexArrayObject& mesh, const VertexArrayObject* vertexSource = nullptr);
+	/// <summary>
+	/// Returns a mesh's ranges to the pool, the allocation is invalid afterwards. If other meshes are using the
+	/// mesh's vertices, they stay in the pool until those meshes are freed too
+	/// </summary>
+	void Free(GeometryAllocation* allocation);
+
+	/// <summary>
+	/// Gets the shared VAO for a vertex layout, creating it if no meshes with that layout have been pooled yet
+	/// </summary>
+	GLuint GetVertexArray(const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Makes sure there are at least the given number of draw indices available for base instances
+	/// </summary>
+	/// <param name="count">The number of objects that will be drawn</param>
+	void ReserveDrawIndices(uint32_t count);
+
+	/// <summary>
+	/// Moves all live meshes to the start of the buffers, so that all of the free space is in a single block
+	/// </summary>
+	/// <returns>The number of meshes that were moved</returns>
+	uint32_t Defragment();
+
+	/// <summary>
+	/// Gets how the shared vertex buffer is being used
+	/// </summary>
+	BufferAllocator::Stats GetVertexStats() const { return _vertexSpace.GetStats(); }
+	/// <summary>
+	/// Gets how the shared index buffer is being used
+	/// </summary>
+	BufferAllocator::Stats GetIndexStats() const { return _indexSpace.GetStats(); }
+	/// <summary>
+	/// Gets the number of meshes stored in this pool
+	/// </summary>
+	uint32_t GetAllocationCount() const { return static_cast<uint32_t>(_allocations.size()); }
+	/// <summary>
+	/// Gets the number of shared VAOs, one per unique vertex layout
+	/// </summary>
+	uint32_t GetLayoutCount() const { return static_cast<uint32_t>(_layouts.size()); }
+
+protected:
+	// Helper structure to store a shared VAO along with the layout it was created for
+	struct Layout {
+		std::vector<BufferAttribute> Attributes;
+		GLsizei Stride;
+		GLuint  VertexArray;
+	};
+
+	GLuint _vertexBuffer;
+	GLuint _indexBuffer;
+	// Holds 0, 1, 2... so an instance's draw index is it's command's base instance plus it's instance number
+	GLuint   _drawIndexBuffer;
+	uint32_t _drawIndexCapacity;
+	BufferAllocator _vertexSpace;
+	BufferAllocator _indexSpace;
+
+	std::vector<Layout> _layouts;
+	std::unordered_set<GeometryAllocation*> _allocations;
+
+	// Allocates a range from a space, growing the space and it's buffer until it fits
+	size_t _AllocateRange(BufferAllocator& space, GLuint& buffer, size_t size, size_t alignment);
+	// Replaces a buffer with a larger one, keeping it's contents
+	void _GrowBuffer(BufferAllocator& space, GLuint& buffer, size_t capacity);
+	// Points all of the shared VAOs at the current buffers
+	void _BindLayouts();
+};
@@ -1,8 +1,10 @@
 #include "IBuffer.h"
+#include "Logging.h"
 
 IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 	_elementCount(0),
 	_elementSize(0),
+	_capacity(0),
 	_handle(0)
 {
 	_type = type;
@@ -18,13 +20,55 @@ IBuffer::~IBuffer() {
 }
 
 void IBuffer::LoadData(const void* data, size_t elementSize, size_t elementCount) {
-	// Note, this is part of the bindless state access stuff added in 4.5
-	glNamedBufferData(_handle, elementSize * elementCount, data, (GLenum)_usage);
+	const size_t size = elementSize * elementCount;
+	const bool isStatic = _usage == BufferUsage::StaticDraw || _usage == BufferUsage::StaticRead || _usage == BufferUsage::StaticCopy;
+
+	if (size > _capacity || _capacity == 0) {
+		// Dynamic buffers get some room to grow, static buffers are usually only loaded once so we don't waste any space
+		size_t capacity = size;
+		if (!isStatic) {
+			capacity = _capacity > 0 ? _capacity : 256;
+			while (capacity < size) {
+				capacity *= 2;
+			}
+		}
+		// Note, this is part of the bindless state access stuff added in 4.5
+		// The handle stays the same, so VAOs and anything else referencing the buffer will still work
+		glNamedBufferData(_handle, capacity, capacity == size ? data : nullptr, (GLenum)_usage);
+		if (capacity != size && data != nullptr && size > 0) {
+			glNamedBufferSubData(_handle, 0, size, data);
+		}
+		_capacity = capacity;
+	}
+	else if (data != nullptr && size > 0) {
+		// The old storage is big enough, so we can just overwrite it. For buffers that get rewritten often,
+		// we orphan the old contents first so we don't have to wait on draws that are still using them
+		if (!isStatic) {
+			Invalidate();
+		}
+		glNamedBufferSubData(_handle, 0, size, data);
+	}
 
 	_elementCount = elementCount;
 	_elementSize = elementSize;
 }
 
+void IBuffer::LoadSubData(size_t offset, const void* data, size_t size) {
+	LOG_ASSERT(offset + size <= _capacity, "Sub data range is outside of the buffer's storage!");
+	glNamedBufferSubData(_handle, offset, size, data);
+
+	if (_elementSize > 0) {
+		const size_t endElement = (offset + size + _elementSize - 1) / _elementSize;
+		if (endElement > _elementCount) {
+			_elementCount = endElement;
+		}
+	}
+}
+
+void IBuffer::Invalidate() {
+	glInvalidateBufferData(_handle);
+}
+
 void IBuffer::Bind() {
 	glBindBuffer((GLenum)_type, _handle);
 }
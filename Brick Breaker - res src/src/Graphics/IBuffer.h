@@ -7,7 +7,9 @@
 /// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glBufferData.xhtml</see>
 enum class BufferType {
 	Vertex = GL_ARRAY_BUFFER,
-	Index = GL_ELEMENT_ARRAY_BUFFER
+	Index = GL_ELEMENT_ARRAY_BUFFER,
+	ShaderStorage = GL_SHADER_STORAGE_BUFFER,
+	DrawIndirect = GL_DRAW_INDIRECT_BUFFER
 };
 
 /// <summary>
@@ -55,13 +57,31 @@ public:
 	virtual ~IBuffer();
 
 	/// <summary>
-	/// Loads data into this buffer, using the bindless method glNamedBufferData
+	/// Loads data into this buffer, replacing it's contents. The buffer's storage is reused if it is big enough,
+	/// otherwise it is reallocated with glNamedBufferData. Static buffers are allocated to exactly the size needed,
+	/// while dynamic and stream buffers grow geometrically so that a slowly growing stream doesn't reallocate every time
 	/// </summary>
 	/// <param name="data">The data that you want to load into the buffer</param>
 	/// <param name="elementSize">The size of a single element, in bytes</param>
 	/// <param name="elementCount">The number of elements to upload</param>
 	virtual void LoadData(const void* data, size_t elementSize, size_t elementCount);
 
+	/// <summary>
+	/// Updates part of this buffer's contents with glNamedBufferSubData, without touching the rest of the buffer.
+	/// The range must fit in the buffer's current capacity. If it extends past the end of the current elements,
+	/// the element count grows to cover it
+	/// </summary>
+	/// <param name="offset">The offset into the buffer to start writing at, in bytes</param>
+	/// <param name="data">The data to write</param>
+	/// <param name="size">The number of bytes to write</param>
+	void LoadSubData(size_t offset, const void* data, size_t size);
+
+	/// <summary>
+	/// Tells OpenGL that we no longer care about the contents of this buffer (glInvalidateBufferData), so a following
+	/// write doesn't need to wait for the GPU to finish with the old contents (also known as orphaning)
+	/// </summary>
+	void Invalidate();
+
 	/// <summary>
 	/// Loads an array of data into this buffer, using the bindless method glNamedBufferData
 	/// </summary>
@@ -86,6 +106,10 @@ public:
 	/// </summary>
 	size_t GetTotalSize() const { return _elementCount * _elementSize; }
 	/// <summary>
+	/// Returns the size in bytes of the storage allocated for this buffer, which may be more than GetTotalSize
+	/// </summary>
+	size_t GetCapacity() const { return _capacity; }
+	/// <summary>
 	/// Returns the type of buffer (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER, etc...)
 	/// </summary>
 	BufferType GetType() const { return _type; }
@@ -118,6 +142,7 @@ protected:
 	
 	size_t _elementSize; // The size or stride of our elements
 	size_t _elementCount; // The number of elements in the buffer
+	size_t _capacity; // The size of the buffer's storage, in bytes
 	GLuint _handle; // The OpenGL handle for the underlying buffer
 	BufferUsage _usage; // The buffer usage mode (GL_STATIC_DRAW, GL_DYNAMIC_DRAW)
 	BufferType _type; // The buffer type (ex GL_ARRAY_BUFFER, GL_ARRAY_ELEMENT_BUFFER)
@@ -1,4 +1,5 @@
 #include "ITexture.h"
+#include "Graphics/GLState.h"
 
 ITexture::Limits ITexture::__limits = ITexture::Limits();
 bool ITexture::__isStaticInit = false;
@@ -21,6 +22,7 @@ void ITexture::_Recreate()
 
 ITexture::~ITexture() {
 	if (glIsTexture(_handle)) {
+		GLState::OnTextureDeleted(_handle);
 		glDeleteTextures(1, &_handle);
 		_handle = 0;
 	}
@@ -29,12 +31,12 @@ ITexture::~ITexture() {
 void ITexture::Bind(int slot) {
 	if (_handle != 0) {
 		// Instead of glActiveTexture + glBindTexture, we can one line it now :D
-		glBindTextureUnit(slot, _handle); 
+		GLState::BindTextureUnit(slot, _handle, (GLenum)_type);
 	}
 }
 
 void ITexture::Unbind(int slot) {
-	glBindTextureUnit(slot, 0);
+	GLState::BindTextureUnit(slot, 0);
 }
 
 void ITexture::Clear(const glm::vec4& color) {
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cfloat>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Stores the axis aligned bounding box and bounding sphere of a mesh in model space, for use in culling
+/// </summary>
+struct MeshBounds {
+	// The minimum corner of the bounding box
+	glm::vec3 Min;
+	// The maximum corner of the bounding box
+	glm::vec3 Max;
+	// The center of the bounding sphere (the center of the box)
+	glm::vec3 Center;
+	// The radius of the bounding sphere, negative if the bounds have not been calculated
+	float     Radius;
+
+	MeshBounds() :
+		Min(glm::vec3(0.0f)),
+		Max(glm::vec3(0.0f)),
+		Center(glm::vec3(0.0f)),
+		Radius(-1.0f) { }
+
+	/// <summary>
+	/// Returns true if these bounds were calculated from a mesh, meshes without bounds should never be culled
+	/// </summary>
+	bool IsValid() const { return Radius >= 0.0f; }
+
+	/// <summary>
+	/// Calculates the bounds for a set of positions stored in an array of vertices
+	/// </summary>
+	/// <param name="firstPosition">A pointer to the position of the first vertex</param>
+	/// <param name="count">The number of vertices</param>
+	/// <param name="stride">The size of a vertex in bytes (ex: sizeof(VertexPosNormTexCol))</param>
+	static MeshBounds FromPositions(const glm::vec3* firstPosition, size_t count, size_t stride = sizeof(glm::vec3)) {
+		MeshBounds result;
+		if (count == 0) {
+			return result;
+		}
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(firstPosition);
+
+		result.Min = glm::vec3(FLT_MAX);
+		result.Max = glm::vec3(-FLT_MAX);
+		for (size_t ix = 0; ix < count; ix++) {
+			const glm::vec3& pos = *reinterpret_cast<const glm::vec3*>(data + ix * stride);
+			result.Min = glm::min(result.Min, pos);
+			result.Max = glm::max(result.Max, pos);
+		}
+
+		// Centering the sphere on the box and measuring to the furthest point is tighter than using the box's diagonal
+		result.Center = (result.Min + result.Max) * 0.5f;
+		float radiusSq = 0.0f;
+		for (size_t ix = 0; ix < count; ix++) {
+			const glm::vec3 offset = *reinterpret_cast<const glm::vec3*>(data + ix * stride) - result.Center;
+			radiusSq = glm::max(radiusSq, glm::dot(offset, offset));
+		}
+		result.Radius = glm::sqrt(radiusSq);
+		return result;
+	}
+};
@@ -0,0 +1,135 @@
+#include "Graphics/RingBuffer.h"
+#include "Logging.h"
+
+#include <cstring>
+#include <algorithm>
+
+RingBuffer::RingBuffer(size_t regionSize, uint32_t regionCount) :
+	_handle(0),
+	_mapped(nullptr),
+	_regionSize(regionSize),
+	_regionCount(std::min(std::max(regionCount, 1u), MAX_REGIONS)),
+	_region(0),
+	_used(0),
+	_alignment(4),
+	_fences(),
+	_waitCount(0)
+{
+	// Both uniform and storage buffers have a minimum offset alignment for binding ranges, we default to the larger of the two
+	GLint uniformAlignment = 0, storageAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+	_alignment = std::max<size_t>(_alignment, std::max(uniformAlignment, storageAlignment));
+	// Keep the regions aligned as well, so that every region starts on an aligned offset
+	_regionSize = (_regionSize + _alignment - 1) / _alignment * _alignment;
+
+	_Create();
+}
+
+RingBuffer::~RingBuffer() {
+	_Destroy();
+}
+
+void RingBuffer::_Create() {
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr totalSize = static_cast<GLsizeiptr>(_regionSize * _regionCount);
+	glCreateBuffers(1, &_handle);
+	glNamedBufferStorage(_handle, totalSize, nullptr, flags);
+	_mapped = static_cast<uint8_t*>(glMapNamedBufferRange(_handle, 0, totalSize, flags));
+	LOG_ASSERT(_mapped != nullptr, "Failed to map ring buffer!");
+	_region = 0;
+	_used = 0;
+}
+
+void RingBuffer::_Destroy() {
+	// The GPU may still be reading from the buffer, so we need to wait for it before we free it
+	for (uint32_t ix = 0; ix < MAX_REGIONS; ix++) {
+		_WaitForRegion(ix);
+	}
+	if (_handle != 0) {
+		glUnmapNamedBuffer(_handle);
+		glDeleteBuffers(1, &_handle);
+		_handle = 0;
+		_mapped = nullptr;
+	}
+}
+
+void RingBuffer::_WaitForRegion(uint32_t region) {
+	if (_fences[region] == nullptr) {
+		return;
+	}
+	// Check without waiting first, so we can count how often we actually stall
+	GLenum result = glClientWaitSync(_fences[region], 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED) {
+		_waitCount++;
+		// Flush on the first wait, otherwise the fence might never be submitted. We wait in 1ms steps so we don't hang forever on a lost context
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do {
+			result = glClientWaitSync(_fences[region], waitFlags, 1000000);
+			waitFlags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	if (result == GL_WAIT_FAILED) {
+		LOG_WARN("Failed to wait on ring buffer fence");
+	}
+	glDeleteSync(_fences[region]);
+	_fences[region] = nullptr;
+}
+
+void RingBuffer::BeginFrame() {
+	_region = (_region + 1) % _regionCount;
+	_used = 0;
+	_WaitForRegion(_region);
+}
+
+void RingBuffer::EndFrame() {
+	if (_fences[_region] != nullptr) {
+		glDeleteSync(_fences[_region]);
+	}
+	_fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* RingBuffer::Allocate(size_t size, size_t& outOffset, size_t alignment) {
+	if (alignment == 0) {
+		alignment = _alignment;
+	}
+	const size_t start = (_used + alignment - 1) / alignment * alignment;
+	if (start + size > _regionSize) {
+		LOG_WARN("Ring buffer region is full, tried to allocate {} bytes with {} of {} used", size, _used, _regionSize);
+		return nullptr;
+	}
+	_used = start + size;
+	outOffset = _region * _regionSize + start;
+	return _mapped + outOffset;
+}
+
+bool RingBuffer::Write(const void* data, size_t size, size_t& outOffset, size_t alignment) {
+	void* dest = Allocate(size, outOffset, alignment);
+	if (dest == nullptr) {
+		return false;
+	}
+	memcpy(dest, data, size);
+	return true;
+}
+
+void RingBuffer::Reserve(size_t regionSize) {
+	if (regionSize <= _regionSize) {
+		return;
+	}
+	// Grow geometrically, so a slowly growing scene doesn't stall every frame
+	size_t newSize = std::max<size_t>(_regionSize, 1024) * 2;
+	while (newSize < regionSize) {
+		newSize *= 2;
+	}
+	_Destroy();
+	_regionSize = (newSize + _alignment - 1) / _alignment * _alignment;
+	_Create();
+}
+
+void RingBuffer::BindRange(GLenum target, uint32_t slot, size_t offset, size_t size) {
+	glBindBufferRange(target, slot, _handle, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
+
+void RingBuffer::Bind(GLenum target) {
+	glBindBuffer(target, _handle);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+/// <summary>
+/// A buffer for data that is rewritten every frame (ex: per-object data, draw commands)
+///
+/// The buffer is created once with immutable storage and stays persistently mapped, so writing to it is just
+/// a memcpy into the mapped pointer, and the driver never has to reallocate it. The buffer is split into
+/// several regions (3 by default), and each frame writes into the next region in turn. A fence is placed
+/// after the frame's draws, and we only wait on it when we wrap back around to that region, so the CPU can
+/// be writing one frame while the GPU is still reading the previous ones
+///
+/// Usage each frame is BeginFrame, any number of Allocate calls, draws that read from the buffer, then EndFrame.
+/// Requires OpenGL 4.4 for glNamedBufferStorage
+/// </summary>
+class RingBuffer
+{
+public:
+	typedef std::shared_ptr<RingBuffer> Sptr;
+
+	static inline Sptr Create(size_t regionSize, uint32_t regionCount = 3) {
+		return std::make_shared<RingBuffer>(regionSize, regionCount);
+	}
+
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	RingBuffer(const RingBuffer& other) = delete;
+	RingBuffer(RingBuffer&& other) = delete;
+	RingBuffer& operator=(const RingBuffer& other) = delete;
+	RingBuffer& operator=(RingBuffer&& other) = delete;
+
+	/// <summary>
+	/// Creates a new ring buffer
+	/// </summary>
+	/// <param name="regionSize">The number of bytes available to each frame</param>
+	/// <param name="regionCount">The number of frames that can be in flight at once</param>
+	RingBuffer(size_t regionSize, uint32_t regionCount = 3);
+	~RingBuffer();
+
+	/// <summary>
+	/// Moves on to the next region, waiting for the GPU to finish with it if needed
+	/// </summary>
+	void BeginFrame();
+	/// <summary>
+	/// Places a fence after all the commands that use this frame's region, must be called after the draws that use it
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Allocates some space in the current frame's region
+	/// </summary>
+	/// <param name="size">The number of bytes to allocate</param>
+	/// <param name="outOffset">Receives the offset of the allocation from the start of the buffer, for binding or indirect draws</param>
+	/// <param name="alignment">The alignment of the allocation, by default this is enough to bind it as a uniform or storage buffer</param>
+	/// <returns>A pointer to write the data to, or nullptr if there was not enough space left in the region</returns>
+	void* Allocate(size_t size, size_t& outOffset, size_t alignment = 0);
+	/// <summary>
+	/// Allocates space in the current frame's region and copies the given data into it
+	/// </summary>
+	/// <returns>True if the data was written, false if there was not enough space left in the region</returns>
+	bool Write(const void* data, size_t size, size_t& outOffset, size_t alignment = 0);
+
+	/// <summary>
+	/// Makes sure each region is at least the given size. If they are not, this waits for the GPU to finish with
+	/// the entire buffer and recreates it, so it should be called before anything is allocated for the frame
+	/// </summary>
+	/// <param name="regionSize">The number of bytes needed for a single frame</param>
+	void Reserve(size_t regionSize);
+
+	/// <summary>
+	/// Binds part of this buffer to an indexed binding point (ex: GL_SHADER_STORAGE_BUFFER or GL_UNIFORM_BUFFER)
+	/// </summary>
+	/// <param name="target">The indexed target to bind to</param>
+	/// <param name="slot">The binding point to bind to</param>
+	/// <param name="offset">The offset returned by Allocate</param>
+	/// <param name="size">The number of bytes to bind</param>
+	void BindRange(GLenum target, uint32_t slot, size_t offset, size_t size);
+	/// <summary>
+	/// Binds this buffer to a non-indexed target (ex: GL_DRAW_INDIRECT_BUFFER)
+	/// </summary>
+	void Bind(GLenum target);
+
+	/// <summary>
+	/// Gets the underlying OpenGL handle that this class is wrapping around
+	/// </summary>
+	GLuint GetHandle() const { return _handle; }
+	size_t GetRegionSize() const { return _regionSize; }
+	/// <summary>
+	/// Gets the default alignment used for allocations
+	/// </summary>
+	size_t GetAlignment() const { return _alignment; }
+	uint32_t GetRegionCount() const { return _regionCount; }
+	/// <summary>
+	/// Gets the number of bytes allocated so far in the current frame
+	/// </summary>
+	size_t GetUsedSize() const { return _used; }
+	/// <summary>
+	/// Gets the number of times BeginFrame had to wait for the GPU, which means the GPU is falling behind
+	/// </summary>
+	uint32_t GetWaitCount() const { return _waitCount; }
+
+protected:
+	static const uint32_t MAX_REGIONS = 4;
+
+	GLuint   _handle;
+	uint8_t* _mapped;     // Pointer to the start of the persistently mapped buffer
+	size_t   _regionSize;
+	uint32_t _regionCount;
+	uint32_t _region;     // The region that the current frame writes to
+	size_t   _used;       // Bytes used in the current region
+	size_t   _alignment;  // The default alignment for allocations
+	GLsync   _fences[MAX_REGIONS];
+	uint32_t _waitCount;
+
+	// Creates and maps the buffer storage
+	void _Create();
+	// Unmaps and deletes the buffer storage, waiting on any outstanding fences
+	void _Destroy();
+	// Waits for a region's fence, if it has one
+	void _WaitForRegion(uint32_t region);
+};
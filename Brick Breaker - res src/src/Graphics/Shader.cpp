@@ -1,5 +1,6 @@
 #include "Shader.h"
 #include "Logging.h"
+#include "Graphics/GLState.h"
 #include <fstream>
 #include <sstream>
 
@@ -7,6 +8,7 @@ Shader::Shader() :
 	// We zero out all of our members so we don't have garbage data in our class
 	_vs(0),
 	_fs(0),
+	_cs(0),
 	_handle(0)
 {
 	_handle = glCreateProgram();
@@ -59,6 +61,7 @@ bool Shader::LoadShaderPart(const char* source, ShaderPartType type)
 	switch (type) {
 		case ShaderPartType::Vertex: _vs = handle; break;
 		case ShaderPartType::Fragment: _fs = handle; break;
+		case ShaderPartType::Compute: _cs = handle; break;
 		default: LOG_WARN("Not implemented"); break;
 	}
 
@@ -91,20 +94,31 @@ bool Shader::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
 
 bool Shader::Link()
 {
-	LOG_ASSERT(_vs != 0 && _fs != 0, "Must attach both a vertex and fragment shader!");
+	if (_cs != 0) {
+		// Compute shaders can't be mixed with the other stages
+		LOG_ASSERT(_vs == 0 && _fs == 0, "A compute shader can't be linked with a vertex or fragment shader!");
+		glAttachShader(_handle, _cs);
+		glLinkProgram(_handle);
+		glDetachShader(_handle, _cs);
+		glDeleteShader(_cs);
+		_cs = 0;
+	}
+	else {
+		LOG_ASSERT(_vs != 0 && _fs != 0, "Must attach both a vertex and fragment shader!");
 
-	// Attach our two shaders
-	glAttachShader(_handle, _vs);
-	glAttachShader(_handle, _fs);
+		// Attach our two shaders
+		glAttachShader(_handle, _vs);
+		glAttachShader(_handle, _fs);
 
-	// Perform linking
-	glLinkProgram(_handle);
+		// Perform linking
+		glLinkProgram(_handle);
 
-	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
-	glDetachShader(_handle, _vs);
-	glDeleteShader(_vs);
-	glDetachShader(_handle, _fs);
-	glDeleteShader(_fs);
+		// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
+		glDetachShader(_handle, _vs);
+		glDeleteShader(_vs);
+		glDetachShader(_handle, _fs);
+		glDeleteShader(_fs);
+	}
 
 	GLint status = 0;
 	glGetProgramiv(_handle, GL_LINK_STATUS, &status);
@@ -129,13 +143,18 @@ bool Shader::Link()
 }
 
 void Shader::Bind() {
-	// Simply calls glUseProgram with our shader handle
-	glUseProgram(_handle);
+	// Goes through the state cache so we skip glUseProgram if we're already bound
+	GLState::UseProgram(_handle);
+}
+
+void Shader::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+	Bind();
+	glDispatchCompute(groupsX, groupsY, groupsZ);
 }
 
 void Shader::Unbind() {
 	// We unbind a shader program by using the default program (0)
-	glUseProgram(0);
+	GLState::UseProgram(0);
 }
 
 void Shader::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
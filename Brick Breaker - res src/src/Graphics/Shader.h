@@ -1,5 +1,6 @@
 #pragma once
 #include <glad/glad.h>
+#include <cstdint>
 #include <memory>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
@@ -13,6 +14,7 @@
 enum class ShaderPartType {
 	Vertex = GL_VERTEX_SHADER,
 	Fragment = GL_FRAGMENT_SHADER,
+	Compute = GL_COMPUTE_SHADER, // Requires OpenGL 4.3, and is linked on it's own
 	Unknown = GL_NONE // Usually good practice to have an "unknown" or "none" state for enums
 };
 
@@ -60,7 +62,7 @@ public:
 	bool LoadShaderPartFromFile(const char* path, ShaderPartType type);
 
 	/// <summary>
-	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// Links the vertex and fragment shader, or the compute shader, and allows this shader program to be used
 	/// </summary>
 	/// <returns>True if the linking was successful, false if otherwise</returns>
 	bool Link();
@@ -74,6 +76,11 @@ public:
 	/// </summary>
 	static void Unbind();
 
+	/// <summary>
+	/// Binds this compute shader and runs it with the given number of work groups
+	/// </summary>
+	void Dispatch(uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1);
+
 	/// <summary>
 	/// Gets the underlying OpenGL handle that this class is wrapping
 	/// </summary>
@@ -115,9 +122,10 @@ public:
 	}
 	
 protected:
-	// Stores the vertex and fragment shader handles
+	// Stores the vertex, fragment and compute shader handles
 	GLuint _vs;
 	GLuint _fs;
+	GLuint _cs;
 	
 	// Stores the shader program handle
 	GLuint _handle;
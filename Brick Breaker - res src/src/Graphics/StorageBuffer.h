@@ -0,0 +1,34 @@
+#pragma once
+#include "IBuffer.h"
+#include <cstdint>
+#include <memory>
+
+/// <summary>
+/// A shader storage buffer (SSBO), for passing large arrays of data to shaders (requires OpenGL 4.3)
+/// </summary>
+class StorageBuffer : public IBuffer
+{
+public:
+	typedef std::shared_ptr<StorageBuffer> Sptr;
+
+	static inline Sptr Create(BufferUsage usage = BufferUsage::DynamicDraw) {
+		return std::make_shared<StorageBuffer>(usage);
+	}
+
+	/// <summary>
+	/// Creates a new storage buffer, with the given usage. Data will still need to be uploaded before it can be used
+	/// </summary>
+	/// <param name="usage">The usage hint for the buffer, default is GL_DYNAMIC_DRAW</param>
+	StorageBuffer(BufferUsage usage = BufferUsage::DynamicDraw) : IBuffer(BufferType::ShaderStorage, usage) { }
+
+	/// <summary>
+	/// Binds this buffer to the given binding point, matching layout(binding = slot) in the shader
+	/// </summary>
+	/// <param name="slot">The binding point to bind to</param>
+	void BindBase(uint32_t slot) { glBindBufferBase(GL_SHADER_STORAGE_BUFFER, slot, _handle); }
+
+	/// <summary>
+	/// Unbinds the current storage buffer
+	/// </summary>
+	static void UnBind() { IBuffer::UnBind(BufferType::ShaderStorage); }
+};
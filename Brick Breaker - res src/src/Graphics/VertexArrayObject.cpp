@@ -2,19 +2,35 @@
 #include "IndexBuffer.h"
 #include "VertexBuffer.h"
 #include "Logging.h"
+#include "Graphics/GLState.h"
+#include "Graphics/GeometryPool.h"
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
 	_vertexCount(0),
-	_vertexBuffers(std::vector<VertexBufferBinding>())
+	_vertexBuffers(std::vector<VertexBufferBinding>()),
+	_pool(nullptr),
+	_poolAllocation(nullptr),
+	_bounds(MeshBounds()),
+	_clusters(nullptr),
+	_lods(std::vector<LodLevel>())
 {
 	glCreateVertexArrays(1, &_handle);
 }
 
 VertexArrayObject::~VertexArrayObject()
 {
+	// Pooled meshes use the pool's shared VAO, so we only give back our range
+	if (_poolAllocation != nullptr) {
+		if (IsPooled()) {
+			_handle = 0;
+		}
+		_pool->Free(_poolAllocation);
+		_poolAllocation = nullptr;
+	}
 	if (_handle != 0) {
+		GLState::OnVertexArrayDeleted(_handle);
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -23,10 +39,8 @@ VertexArrayObject::~VertexArrayObject()
 void VertexArrayObject::SetIndexBuffer(const IndexBuffer::Sptr& ibo) {
 	// TODO: What if we already have a buffer? should we delete it? who owns the buffer?
 	_indexBuffer = ibo;
-	Bind();
-	if (_indexBuffer != nullptr) _indexBuffer->Bind();
-	else IndexBuffer::Unbind();
-	Unbind();
+	// DSA lets us attach the buffer without binding the VAO, so whatever VAO is currently bound is left alone
+	glVertexArrayElementBuffer(_handle, _indexBuffer != nullptr ? _indexBuffer->GetHandle() : 0);
 }
 
 void VertexArrayObject::AddVertexBuffer(const VertexBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes)
@@ -37,36 +51,106 @@ void VertexArrayObject::AddVertexBuffer(const VertexBuffer::Sptr& buffer, const
 		LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 	}
 
+	// Each buffer gets the next binding point, in the order they were added
+	const GLuint bindingIndex = static_cast<GLuint>(_vertexBuffers.size());
+	const GLsizei stride = attributes.size() > 0 ? attributes[0].Stride : 0;
+
 	VertexBufferBinding binding;
 	binding.Buffer = buffer;
 	binding.Attributes = attributes;
 	_vertexBuffers.push_back(binding);
 
-
-	Bind();
-	buffer->Bind();
+	// The attribute formats only describe the layout of a vertex, the buffer is attached to the binding point
+	// separately, so it can be swapped out later without touching the attributes
 	for (const BufferAttribute& attrib : attributes) {
+		if (attrib.Stride != stride) {
+			LOG_WARN("All attributes in a vertex buffer should have the same stride, attribute in slot {} will use a stride of {}", attrib.Slot, stride);
+		}
 		glEnableVertexArrayAttrib(_handle, attrib.Slot);
-		glVertexAttribPointer(attrib.Slot, attrib.Size, (GLenum)attrib.Type, attrib.Normalized, attrib.Stride,
-							  (void*)attrib.Offset);
+		glVertexArrayAttribFormat(_handle, attrib.Slot, attrib.Size, (GLenum)attrib.Type, attrib.Normalized, attrib.Offset);
+		glVertexArrayAttribBinding(_handle, attrib.Slot, bindingIndex);
 	}
-	Unbind();
+	glVertexArrayVertexBuffer(_handle, bindingIndex, buffer->GetHandle(), 0, stride);
+}
+
+void VertexArrayObject::SetVertexBuffer(uint32_t bindingIndex, const VertexBuffer::Sptr& buffer) {
+	LOG_ASSERT(bindingIndex < _vertexBuffers.size(), "No vertex buffer has been added at binding {}!", bindingIndex);
+	VertexBufferBinding& binding = _vertexBuffers[bindingIndex];
+	binding.Buffer = buffer;
+	if (bindingIndex == 0) {
+		_vertexCount = buffer->GetElementCount();
+	}
+	const GLsizei stride = binding.Attributes.size() > 0 ? binding.Attributes[0].Stride : 0;
+	glVertexArrayVertexBuffer(_handle, bindingIndex, buffer->GetHandle(), 0, stride);
+}
+
+void VertexArrayObject::SetPooledGeometry(const std::shared_ptr<GeometryPool>& pool, GeometryAllocation* allocation) {
+	LOG_ASSERT(_vertexBuffers.size() == 0 && _indexBuffer == nullptr, "Cannot pool a VAO that already has buffers!");
+	LOG_ASSERT(_poolAllocation == nullptr, "VAO is already pooled!");
+	// We won't be using our own VAO anymore
+	if (_handle != 0) {
+		GLState::OnVertexArrayDeleted(_handle);
+		glDeleteVertexArrays(1, &_handle);
+	}
+	_pool = pool;
+	_poolAllocation = allocation;
+	_handle = allocation->VertexArray;
+	_vertexCount = allocation->VertexCount;
+}
+
+void VertexArrayObject::SetPoolCopy(const std::shared_ptr<GeometryPool>& pool, GeometryAllocation* allocation) {
+	LOG_ASSERT(_vertexBuffers.size() > 0, "Only VAOs with their own buffers can have a pooled copy!");
+	LOG_ASSERT(_poolAllocation == nullptr, "VAO is already pooled!");
+	_pool = pool;
+	_poolAllocation = allocation;
+}
+
+void VertexArrayObject::AddLod(const Sptr& mesh, float error) {
+	LodLevel level;
+	level.Mesh = mesh;
+	level.Error = error;
+	_lods.push_back(level);
+}
+
+VertexArrayObject* VertexArrayObject::SelectLod(float projectedSize, float threshold, uint32_t* outLevel) {
+	// The error is relative to the mesh's size, so scaling it by the mesh's size on screen tells us how big it looks
+	VertexArrayObject* result = this;
+	uint32_t level = 0;
+	for (size_t ix = 0; ix < _lods.size(); ix++) {
+		if (_lods[ix].Error * projectedSize > threshold) {
+			break;
+		}
+		result = _lods[ix].Mesh.get();
+		level = static_cast<uint32_t>(ix + 1);
+	}
+	if (outLevel != nullptr) {
+		*outLevel = level;
+	}
+	return result;
 }
 
 void VertexArrayObject::Draw(DrawMode mode) {
+	// We leave the VAO bound afterwards, so drawing the same mesh again won't need to rebind it
 	Bind();
-	if (_indexBuffer == nullptr) {
+	DrawWithoutBinding(mode);
+}
+
+void VertexArrayObject::DrawWithoutBinding(DrawMode mode) {
+	if (IsPooled()) {
+		// The offsets are read every draw, since they can change when the pool is defragmented
+		glDrawElementsBaseVertex((GLenum)mode, _poolAllocation->IndexCount, GL_UNSIGNED_INT,
+								 (void*)_poolAllocation->IndexOffset, _poolAllocation->GetBaseVertex());
+	} else if (_indexBuffer == nullptr) {
 		glDrawArrays((GLenum)mode, 0, _vertexCount);
 	} else {
 		glDrawElements((GLenum)mode, _indexBuffer->GetElementCount(), (GLenum)_indexBuffer->GetElementType(), nullptr);
 	}
-	Unbind();
 }
 
 void VertexArrayObject::Bind() {
-	glBindVertexArray(_handle);
+	GLState::BindVertexArray(_handle);
 }
 
 void VertexArrayObject::Unbind() {
-	glBindVertexArray(0);
+	GLState::BindVertexArray(0);
 }
@@ -7,9 +7,14 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "IResource.h"
+#include "MeshBounds.h"
+#include "ClusterMesh.h"
 
 #include <memory>
 
+class GeometryPool;
+struct GeometryAllocation;
+
 /// <summary>
 /// We'll use this just to make it more clear what the intended usage of an attribute is in our code!
 /// </summary>
@@ -37,7 +42,7 @@ enum class AttribUsage
 /// <summary>
 /// Represents the type that a VAO attribute can have
 /// </summary>
-/// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glVertexAttribPointer.xhtml</see>
+/// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glVertexAttribFormat.xhtml</see>
 enum class AttributeType {
 	Byte    = GL_BYTE,
 	UByte   = GL_UNSIGNED_BYTE,
@@ -65,7 +70,7 @@ enum class DrawMode {
 };
 
 /// <summary>
-/// This structure will represent the parameters passed to the glVertexAttribPointer commands
+/// This structure will represent the parameters passed to the glVertexArrayAttribFormat commands
 /// </summary>
 struct BufferAttribute
 {
@@ -135,13 +140,48 @@ public:
 	/// <param name="ibo">The index buffer to bind to this VAO</param>
 	void SetIndexBuffer(const IndexBuffer::Sptr& ibo);
 	/// <summary>
-	/// Adds a vertex buffer to this VAO, with the specified attributes
+	/// Adds a vertex buffer to this VAO, with the specified attributes. Each buffer is attached to it's own
+	/// binding point, numbered in the order the buffers were added
 	/// </summary>
 	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later)</param>
-	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
+	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer, all with the same stride</param>
 	void AddVertexBuffer(const VertexBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Replaces the buffer at one of this VAO's binding points, keeping the attributes that were set up by
+	/// AddVertexBuffer. This only changes which buffer is read from, so it is much cheaper than making a new VAO
+	/// </summary>
+	/// <param name="bindingIndex">The binding point to replace, the index of the buffer in the order they were added</param>
+	/// <param name="buffer">The new buffer, must have the same layout as the one it is replacing</param>
+	void SetVertexBuffer(uint32_t bindingIndex, const VertexBuffer::Sptr& buffer);
+	/// <summary>
+	/// Makes this VAO draw a mesh stored in a geometry pool instead of it's own buffers. The VAO will use the
+	/// pool's shared VAO for the mesh's layout, and will return the mesh to the pool when it is deleted
+	/// </summary>
+	/// <param name="pool">The pool that the mesh was allocated from</param>
+	/// <param name="allocation">The mesh's allocation, this VAO takes ownership of it</param>
+	void SetPooledGeometry(const std::shared_ptr<GeometryPool>& pool, GeometryAllocation* allocation);
+	/// <summary>
+	/// Records that a copy of this VAO's mesh is stored in a geometry pool (see GeometryPool::Copy), so it can be
+	/// drawn along with the rest of the pool. Unlike SetPooledGeometry, the VAO keeps drawing from it's own buffers
+	/// </summary>
+	/// <param name="pool">The pool that the copy was allocated from</param>
+	/// <param name="allocation">The copy's allocation, this VAO takes ownership of it</param>
+	void SetPoolCopy(const std::shared_ptr<GeometryPool>& pool, GeometryAllocation* allocation);
+	/// <summary>
+	/// Returns true if this VAO draws a mesh stored in a geometry pool, rather than from it's own buffers
+	/// </summary>
+	bool IsPooled() const { return _poolAllocation != nullptr && _vertexBuffers.empty(); }
+	/// <summary>
+	/// Gets where this VAO's mesh is stored in it's geometry pool, or nullptr if it has not been pooled or copied to a pool
+	/// </summary>
+	GeometryAllocation* GetPoolAllocation() const { return _poolAllocation; }
 
 	void Draw(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Issues the draw call for this VAO, assuming that it is already bound. Used by code that keeps
+	/// track of the bound VAO itself (ex: the render queue) to avoid redundant binds
+	/// </summary>
+	void DrawWithoutBinding(DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -153,19 +193,76 @@ public:
 	/// </summary>
 	static void Unbind();
 
+	/// <summary>
+	/// Sets the model space bounds of this mesh, used for culling
+	/// </summary>
+	void SetBounds(const MeshBounds& bounds) { _bounds = bounds; }
+	/// <summary>
+	/// Gets the model space bounds of this mesh. Meshes that were not given bounds will have invalid bounds
+	/// </summary>
+	const MeshBounds& GetBounds() const { return _bounds; }
+
+	/// <summary>
+	/// Sets the meshlets for this mesh, so that parts of it can be culled separately (see ClusterCuller)
+	/// </summary>
+	void SetClusters(const ClusterMesh::Sptr& clusters) { _clusters = clusters; }
+	/// <summary>
+	/// Gets the meshlets for this mesh, or nullptr if it has not been split into meshlets
+	/// </summary>
+	const ClusterMesh::Sptr& GetClusters() const { return _clusters; }
+
+	// Helper structure to store a simplified version of this mesh
+	struct LodLevel {
+		Sptr  Mesh;
+		// How far the simplified surface is from the original, relative to the size of the mesh
+		float Error;
+	};
+
+	/// <summary>
+	/// Adds a simplified version of this mesh, levels should be added from most to least detailed
+	/// </summary>
+	/// <param name="mesh">The simplified mesh</param>
+	/// <param name="error">How far the simplified surface is from the original, relative to the size of the mesh</param>
+	void AddLod(const Sptr& mesh, float error);
+	/// <summary>
+	/// Gets the simplified versions of this mesh, not including the mesh itself
+	/// </summary>
+	const std::vector<LodLevel>& GetLods() const { return _lods; }
+	/// <summary>
+	/// Picks the least detailed version of this mesh whose error would not be noticeable at the given size
+	/// </summary>
+	/// <param name="projectedSize">The size of the mesh on screen, as a fraction of the screen height (see Camera::GetProjectedSize)</param>
+	/// <param name="threshold">The largest error allowed, as a fraction of the screen height</param>
+	/// <param name="outLevel">If not null, receives the level that was picked, 0 being this mesh</param>
+	/// <returns>The mesh to draw</returns>
+	VertexArrayObject* SelectLod(float projectedSize, float threshold, uint32_t* outLevel = nullptr);
+
 	/// <summary>
 	/// Returns the underlying OpenGL handle that this class is wrapping around
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
-	
-protected:
+
 	// Helper structure to store a buffer and the attributes
 	struct VertexBufferBinding
 	{
 		VertexBuffer::Sptr Buffer;
 		std::vector<BufferAttribute> Attributes;
 	};
+
+	/// <summary>
+	/// Gets the vertex buffers that have been added to this VAO, along with their attributes
+	/// </summary>
+	const std::vector<VertexBufferBinding>& GetVertexBuffers() const { return _vertexBuffers; }
+	/// <summary>
+	/// Gets the index buffer for this VAO, or nullptr if it is not indexed
+	/// </summary>
+	const IndexBuffer::Sptr& GetIndexBuffer() const { return _indexBuffer; }
+	/// <summary>
+	/// Gets the number of vertices in this VAO
+	/// </summary>
+	uint32_t GetVertexCount() const { return _vertexCount; }
 	
+protected:
 	// The index buffer bound to this VAO
 	IndexBuffer::Sptr _indexBuffer;
 	// The vertex buffers bound to this VAO
@@ -173,6 +270,17 @@ protected:
 
 	uint32_t _vertexCount;
 
+	// The pool that our mesh (or a copy of it) is stored in, if it is pooled
+	std::shared_ptr<GeometryPool> _pool;
+	GeometryAllocation*           _poolAllocation;
+
+	// The model space bounds of the mesh
+	MeshBounds _bounds;
+	// The meshlets for the mesh, if it has been split up
+	ClusterMesh::Sptr _clusters;
+	// Simplified versions of the mesh, from most to least detailed
+	std::vector<LodLevel> _lods;
+
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
 };
@@ -0,0 +1,44 @@
+#include "Scene/ClusterCuller.h"
+
+ClusterCuller::ClusterCuller() :
+	_instances(std::unordered_map<uint32_t, Instance>()),
+	_indices(std::vector<uint32_t>()),
+	_stats(Stats()) { }
+
+VertexArrayObject* ClusterCuller::Cull(uint32_t objectIndex, const VertexArrayObject::Sptr& mesh, const glm::mat4& world, const glm::vec4* frustumPlanes, const glm::vec3& cameraPos) {
+	const ClusterMesh::Sptr& clusters = mesh->GetClusters();
+	if (clusters == nullptr || mesh->IsPooled()) {
+		return mesh.get();
+	}
+
+	// Make a VAO that reads the same vertices, but from our own index buffer
+	Instance& instance = _instances[objectIndex];
+	if (instance.Source != mesh) {
+		instance.Source = mesh;
+		instance.Indices = IndexBuffer::Create(BufferUsage::StreamDraw);
+		instance.Mesh = VertexArrayObject::Create();
+		for (const VertexArrayObject::VertexBufferBinding& binding : mesh->GetVertexBuffers()) {
+			instance.Mesh->AddVertexBuffer(binding.Buffer, binding.Attributes);
+		}
+		instance.Mesh->SetIndexBuffer(instance.Indices);
+		instance.Mesh->SetBounds(mesh->GetBounds());
+	}
+
+	const uint32_t visible = clusters->Cull(world, frustumPlanes, cameraPos, _indices);
+	_stats.Objects++;
+	_stats.MeshletsTested += static_cast<uint32_t>(clusters->GetMeshletCount());
+	_stats.MeshletsVisible += visible;
+	_stats.TrianglesTotal += clusters->GetTriangleCount();
+	_stats.TrianglesDrawn += static_cast<uint32_t>(_indices.size() / 3);
+	if (_indices.size() == 0) {
+		return nullptr;
+	}
+
+	// The buffer keeps it's storage between frames, so this is usually just a sub data upload
+	instance.Indices->LoadData(_indices.data(), _indices.size());
+	return instance.Mesh.get();
+}
+
+void ClusterCuller::Clear() {
+	_instances.clear();
+}
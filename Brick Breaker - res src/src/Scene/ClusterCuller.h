@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+
+/// <summary>
+/// Culls the meshlets of clustered meshes (see ClusterMesh) each frame, and packs the indices of the visible
+/// triangles into an index buffer for each object, so only the visible parts of large meshes get drawn
+///
+/// Each object gets it's own VAO that shares the mesh's vertex buffers, but has it's own index buffer, since
+/// objects using the same mesh will see different parts of it
+/// </summary>
+class ClusterCuller {
+public:
+	/// <summary>
+	/// Counts of the work done since the last call to ResetStats
+	/// </summary>
+	struct Stats {
+		uint32_t Objects;
+		uint32_t MeshletsTested;
+		uint32_t MeshletsVisible;
+		uint32_t TrianglesTotal;
+		uint32_t TrianglesDrawn;
+	};
+
+	ClusterCuller();
+	~ClusterCuller() = default;
+
+	/// <summary>
+	/// Culls an object's meshlets, and returns the mesh to draw for it
+	/// </summary>
+	/// <param name="objectIndex">A unique ID for the object, used to keep it's index buffer between frames</param>
+	/// <param name="mesh">The object's mesh, should have meshlets</param>
+	/// <param name="world">The object's world transform</param>
+	/// <param name="frustumPlanes">The 6 world space frustum planes (see Camera::GetFrustumPlanes)</param>
+	/// <param name="cameraPos">The world space position of the camera</param>
+	/// <returns>The mesh to draw, which will be the original mesh if it has no meshlets, or nullptr if nothing is visible</returns>
+	VertexArrayObject* Cull(uint32_t objectIndex, const VertexArrayObject::Sptr& mesh, const glm::mat4& world, const glm::vec4* frustumPlanes, const glm::vec3& cameraPos);
+
+	/// <summary>
+	/// Removes all of the per-object meshes, should be called when the scene changes
+	/// </summary>
+	void Clear();
+
+	const Stats& GetStats() const { return _stats; }
+	void ResetStats() { _stats = Stats(); }
+
+protected:
+	// Helper structure to store the mesh we draw for an object
+	struct Instance {
+		VertexArrayObject::Sptr Source;
+		VertexArrayObject::Sptr Mesh;
+		IndexBuffer::Sptr       Indices;
+	};
+
+	std::unordered_map<uint32_t, Instance> _instances;
+	std::vector<uint32_t> _indices; // Scratch space for the visible indices
+	Stats _stats;
+};
@@ -0,0 +1,124 @@
+#include "Scene/IndirectRenderer.h"
+#include "Graphics/GLState.h"
+
+IndirectRenderer::IndirectRenderer(const GeometryPool::Sptr& pool) :
+	_pool(pool),
+	_vertexArray(pool->GetVertexArray(VertexPosNormTexCol::V_DECL)),
+	_objects(std::vector<ObjectData>()),
+	_commands(std::vector<DrawElementsIndirectCommand>()),
+	_commandMaterials(std::vector<uint32_t>()),
+	_sortedCommands(std::vector<DrawElementsIndirectCommand>()),
+	_materialOffsets(std::vector<uint32_t>()),
+	_materialCursors(std::vector<uint32_t>()),
+	_materials(std::vector<MaterialInfo*>()),
+	_materialIds(std::unordered_map<MaterialInfo*, uint32_t>()),
+	_frameData(RingBuffer::Create(64 * 1024)),
+	_stats(Stats()) { }
+
+bool IndirectRenderer::IsSupported() {
+	// Multi-draw indirect and storage buffers became core in 4.3, and the ring buffer needs buffer storage from 4.4
+	return GLAD_GL_VERSION_4_4 != 0;
+}
+
+void IndirectRenderer::Clear() {
+	_objects.clear();
+	_commands.clear();
+	_commandMaterials.clear();
+	_materials.clear();
+	_materialIds.clear();
+}
+
+bool IndirectRenderer::Submit(MaterialInfo* material, const VertexArrayObject* mesh, const glm::mat4& model, const glm::mat4& modelViewProjection, const glm::mat3& normalMatrix) {
+	const ObjectData object = { model, modelViewProjection, glm::mat4(normalMatrix) };
+	return SubmitInstances(material, mesh, &object, 1);
+}
+
+bool IndirectRenderer::SubmitInstances(MaterialInfo* material, const VertexArrayObject* mesh, const ObjectData* instances, uint32_t count) {
+	// The allocation may belong to another pool, which would have a different VAO
+	const GeometryAllocation* allocation = mesh->GetPoolAllocation();
+	if (allocation == nullptr || allocation->VertexArray != _vertexArray) {
+		return false;
+	}
+	if (count == 0) {
+		return true;
+	}
+
+	// Materials get IDs in the order we first see them, which we use to group the commands
+	auto it = _materialIds.find(material);
+	uint32_t materialId;
+	if (it == _materialIds.end()) {
+		materialId = static_cast<uint32_t>(_materials.size());
+		_materialIds[material] = materialId;
+		_materials.push_back(material);
+	} else {
+		materialId = it->second;
+	}
+
+	DrawElementsIndirectCommand command;
+	command.Count         = allocation->IndexCount;
+	// The draw index advances once per instance, so the instances read consecutive entries starting at the base instance
+	command.InstanceCount = count;
+	command.FirstIndex    = allocation->GetFirstIndex();
+	command.BaseVertex    = allocation->GetBaseVertex();
+	command.BaseInstance  = static_cast<uint32_t>(_objects.size());
+	_commands.push_back(command);
+	_commandMaterials.push_back(materialId);
+
+	_objects.insert(_objects.end(), instances, instances + count);
+	return true;
+}
+
+void IndirectRenderer::Execute(Shader& shader) {
+	_stats = Stats();
+	_stats.Objects = static_cast<uint32_t>(_objects.size());
+	if (_objects.empty()) {
+		return;
+	}
+
+	// Counting sort the commands by material, so each material's commands are contiguous
+	const uint32_t materialCount = static_cast<uint32_t>(_materials.size());
+	_materialOffsets.assign(materialCount + 1, 0);
+	for (uint32_t materialId : _commandMaterials) {
+		_materialOffsets[materialId + 1]++;
+	}
+	for (uint32_t ix = 0; ix < materialCount; ix++) {
+		_materialOffsets[ix + 1] += _materialOffsets[ix];
+	}
+	_sortedCommands.resize(_commands.size());
+	_materialCursors.assign(_materialOffsets.begin(), _materialOffsets.end() - 1);
+	for (size_t ix = 0; ix < _commands.size(); ix++) {
+		_sortedCommands[_materialCursors[_commandMaterials[ix]]++] = _commands[ix];
+	}
+
+	// Copy everything for this frame into the ring buffer, leaving room for the padding used to align each block
+	const size_t objectBytes = _objects.size() * sizeof(ObjectData);
+	const size_t commandBytes = _sortedCommands.size() * sizeof(DrawElementsIndirectCommand);
+	_frameData->BeginFrame();
+	_frameData->Reserve(objectBytes + commandBytes + 2 * _frameData->GetAlignment());
+	size_t objectOffset = 0, commandOffset = 0;
+	_frameData->Write(_objects.data(), objectBytes, objectOffset);
+	_frameData->Write(_sortedCommands.data(), commandBytes, commandOffset);
+	_pool->ReserveDrawIndices(static_cast<uint32_t>(_objects.size()));
+
+	shader.Bind();
+	GLState::BindVertexArray(_vertexArray);
+	_frameData->BindRange(GL_SHADER_STORAGE_BUFFER, OBJECT_BUFFER_BINDING, objectOffset, objectBytes);
+	_frameData->Bind(GL_DRAW_INDIRECT_BUFFER);
+
+	for (uint32_t ix = 0; ix < materialCount; ix++) {
+		MaterialInfo* material = _materials[ix];
+		material->ApplyUniforms(shader);
+		if (material->Texture != nullptr) {
+			material->Texture->Bind(0);
+		}
+
+		// The offset is a byte offset into the bound indirect buffer
+		const size_t offset = commandOffset + _materialOffsets[ix] * sizeof(DrawElementsIndirectCommand);
+		const GLsizei count = static_cast<GLsizei>(_materialOffsets[ix + 1] - _materialOffsets[ix]);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset), count, 0);
+		_stats.DrawCalls++;
+	}
+
+	// Fence off this frame's region so we don't overwrite it before the GPU is done with it
+	_frameData->EndFrame();
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Shader.h"
+#include "Graphics/GeometryPool.h"
+#include "Graphics/VertexTypes.h"
+#include "Graphics/RingBuffer.h"
+#include "Graphics/IndirectBuffer.h"
+#include "Scene/MaterialInfo.h"
+
+/// <summary>
+/// Draws objects whose meshes live in a GeometryPool with one glMultiDrawElementsIndirect call per material.
+/// Only meshes with the VertexPosNormTexCol layout are drawn, since they all share one of the pool's VAOs
+///
+/// Each submitted object gets an entry in a storage buffer holding it's matrices, and an indirect command
+/// whose base instance is the index of that entry. Commands are grouped by material, so the number of
+/// GL calls made by Execute depends on the number of materials, not the number of objects
+///
+/// Both the object data and the commands are streamed through a persistently mapped ring buffer, so
+/// uploading them each frame never reallocates any buffers
+///
+/// Requires OpenGL 4.3, and a shader that reads it's matrices from the storage buffer (see vertex_shader_indirect.glsl)
+/// </summary>
+class IndirectRenderer {
+public:
+	/// <summary>
+	/// The binding point of the per-object storage buffer, must match the shader
+	/// </summary>
+	static const uint32_t OBJECT_BUFFER_BINDING = 0;
+
+	/// <summary>
+	/// The per-object data stored in the storage buffer, must match the std430 layout in the shader.
+	/// The normal matrix is stored as a mat4 since std430 pads the columns of a mat3 to vec4s anyways
+	/// </summary>
+	struct ObjectData {
+		glm::mat4 Model;
+		glm::mat4 ModelViewProjection;
+		glm::mat4 NormalMatrix;
+	};
+
+	/// <summary>
+	/// Counts of the work done by the last call to Execute
+	/// </summary>
+	struct Stats {
+		uint32_t Objects;
+		uint32_t DrawCalls;
+	};
+
+	IndirectRenderer(const GeometryPool::Sptr& pool);
+	~IndirectRenderer() = default;
+
+	/// <summary>
+	/// Returns true if the current OpenGL context supports multi-draw indirect and storage buffers
+	/// </summary>
+	static bool IsSupported();
+
+	/// <summary>
+	/// Removes all objects, should be called at the start of each frame
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Adds an object to be drawn
+	/// </summary>
+	/// <param name="material">The material to draw the object with</param>
+	/// <param name="mesh">The mesh to draw, must have been pooled or copied to the pool</param>
+	/// <param name="model">The world matrix for the object</param>
+	/// <param name="modelViewProjection">The MVP matrix for the object</param>
+	/// <param name="normalMatrix">The normal matrix for the object</param>
+	/// <returns>True if the object will be drawn, false if it's mesh is not in the pool and needs to be drawn another way</returns>
+	bool Submit(MaterialInfo* material, const VertexArrayObject* mesh, const glm::mat4& model, const glm::mat4& modelViewProjection, const glm::mat3& normalMatrix);
+	/// <summary>
+	/// Adds many copies of the same mesh, drawn by a single instanced command
+	/// </summary>
+	/// <param name="material">The material to draw the instances with</param>
+	/// <param name="mesh">The mesh to draw, must have been pooled or copied to the pool</param>
+	/// <param name="instances">The matrices for each instance</param>
+	/// <param name="count">The number of instances</param>
+	/// <returns>True if the instances will be drawn, false if the mesh is not in the pool and needs to be drawn another way</returns>
+	bool SubmitInstances(MaterialInfo* material, const VertexArrayObject* mesh, const ObjectData* instances, uint32_t count);
+
+	/// <summary>
+	/// Uploads the object data and draw commands, and draws everything that was submitted
+	/// </summary>
+	/// <param name="shader">The shader to draw with, should read it's per-object data from the storage buffer</param>
+	void Execute(Shader& shader);
+
+	/// <summary>
+	/// Gets the stats from the last call to Execute
+	/// </summary>
+	const Stats& GetStats() const { return _stats; }
+
+protected:
+	GeometryPool::Sptr _pool;
+	// The pool's shared VAO for VertexPosNormTexCol, the only layout we can draw
+	GLuint             _vertexArray;
+
+	std::vector<ObjectData>                  _objects;
+	std::vector<DrawElementsIndirectCommand> _commands;         // In submission order
+	std::vector<uint32_t>                    _commandMaterials; // The material ID for each command
+	std::vector<DrawElementsIndirectCommand> _sortedCommands;   // Grouped by material
+	std::vector<uint32_t>                    _materialOffsets;  // Where each material's commands start in _sortedCommands
+	std::vector<uint32_t>                    _materialCursors;  // Scratch space for the sort, where each material's next command goes
+
+	// The materials seen so far this frame, in order of their IDs
+	std::vector<MaterialInfo*>                  _materials;
+	std::unordered_map<MaterialInfo*, uint32_t> _materialIds;
+
+	// Holds both the object data and the commands for the last few frames
+	RingBuffer::Sptr _frameData;
+
+	Stats _stats;
+};
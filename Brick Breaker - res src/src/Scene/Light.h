@@ -0,0 +1,39 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <json.hpp>
+
+#include "Utils/JsonGlmHelpers.h"
+
+// Helper structure for our light data
+struct Light {
+	glm::vec3 Position;
+	glm::vec3 Color;
+	// Basically inverse of how far our light goes (1/dist, approx)
+	float Attenuation = 1.0f / 5.0f;
+	// The approximate range of our light
+	float Range = 4.0f;
+
+	/// <summary>
+	/// Loads a light from a JSON blob
+	/// </summary>
+	static Light FromJson(const nlohmann::json& data) {
+		Light result;
+		result.Position = ParseJsonVec3(data["position"]);
+		result.Color = ParseJsonVec3(data["color"]);
+		result.Range = data["range"].get<float>();
+		result.Attenuation = 1.0f / (1.0f + result.Range);
+		return result;
+	}
+
+	/// <summary>
+	/// Converts this object into it's JSON representation for storage
+	/// </summary>
+	nlohmann::json ToJson() const {
+		return {
+			{ "position", GlmToJson(Position) },
+			{ "color", GlmToJson(Color) },
+			{ "range", Range },
+		};
+	}
+
+};
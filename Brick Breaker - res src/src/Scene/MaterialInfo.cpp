@@ -0,0 +1,45 @@
+#include "Scene/MaterialInfo.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+void MaterialInfo::Apply() {
+	ApplyUniforms();
+
+	// Bind the texture
+	if (Texture != nullptr) {
+		Texture->Bind(0);
+	}
+}
+
+void MaterialInfo::ApplyUniforms() {
+	ApplyUniforms(*Shader);
+}
+
+void MaterialInfo::ApplyUniforms(::Shader& shader) {
+	// Material properties
+	shader.SetUniform("u_Material.Shininess", Shininess);
+
+	// For textures, we pass the *slot* that the texture sure draw from
+	shader.SetUniform("u_Material.Diffuse", 0);
+}
+
+MaterialInfo::Sptr MaterialInfo::FromJson(const nlohmann::json& data) {
+	MaterialInfo::Sptr result = std::make_shared<MaterialInfo>();
+	result->OverrideGUID(Guid(data["guid"]));
+	result->Name = data["name"].get<std::string>();
+	result->Shader = ResourceManager::GetShader(Guid(data["shader"]));
+
+	// material specific parameters
+	result->Texture = ResourceManager::GetTexture(Guid(data["texture"]));
+	result->Shininess = data["shininess"].get<float>();
+	return result;
+}
+
+nlohmann::json MaterialInfo::ToJson() const {
+	return {
+		{ "guid", GetGUID().str() },
+		{ "name", Name },
+		{ "shader", Shader ? Shader->GetGUID().str() : "" },
+		{ "texture", Texture ? Texture->GetGUID().str() : "" },
+		{ "shininess", Shininess },
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <json.hpp>
+
+#include "Graphics/IResource.h"
+#include "Graphics/Shader.h"
+#include "Graphics/Texture2D.h"
+
+// Helper structure for material parameters
+// to our shader
+struct MaterialInfo : IResource {
+	typedef std::shared_ptr<MaterialInfo> Sptr;
+	// A human readable name for the material
+	std::string     Name;
+	// The shader that the material is using
+	Shader::Sptr    Shader;
+
+	// Material shader parameters
+	Texture2D::Sptr Texture;
+	float           Shininess;
+
+	/// <summary>
+	/// Handles applying this material's state to the OpenGL pipeline
+	/// Will bind the shader, update material uniforms, and bind textures
+	/// </summary>
+	virtual void Apply();
+	/// <summary>
+	/// Updates this material's uniforms on it's shader, without binding the shader or any textures.
+	/// Used by the render queue, which handles binding textures itself
+	/// </summary>
+	virtual void ApplyUniforms();
+	/// <summary>
+	/// Updates this material's uniforms on another shader with the same material uniforms, for
+	/// renderers that draw the material with a variant of it's shader (ex: the indirect renderer)
+	/// </summary>
+	/// <param name="shader">The shader to update the uniforms on</param>
+	virtual void ApplyUniforms(::Shader& shader);
+
+	/// <summary>
+	/// Loads a material from a JSON blob
+	/// </summary>
+	static MaterialInfo::Sptr FromJson(const nlohmann::json& data);
+
+	/// <summary>
+	/// Converts this material into it's JSON representation for storage
+	/// </summary>
+	nlohmann::json ToJson() const;
+};
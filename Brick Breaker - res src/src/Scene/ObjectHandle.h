@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// A stable reference to an object in a scene. Unlike a pointer or index into Scene::Objects, a handle
+/// stays valid when other objects are added or removed. Each slot has a generation that is bumped
+/// whenever it's object is removed, so a handle to a removed object resolves to nullptr instead of
+/// pointing at whatever object ends up reusing the slot
+/// Note that handles belong to the scene that created them, and need to be looked up again after loading a new scene
+/// </summary>
+struct ObjectHandle {
+	static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFF;
+
+	// The index of the scene's slot for the object
+	uint32_t Slot;
+	// The generation of the slot when this handle was created
+	uint32_t Generation;
+
+	ObjectHandle() : Slot(INVALID_SLOT), Generation(0) { }
+	ObjectHandle(uint32_t slot, uint32_t generation) : Slot(slot), Generation(generation) { }
+
+	/// <summary>
+	/// Returns true if this handle was ever assigned an object. Note that the object may still have
+	/// been removed since, use Scene::GetObjectByHandle to check that
+	/// </summary>
+	bool IsValid() const { return Slot != INVALID_SLOT; }
+
+	bool operator ==(const ObjectHandle& other) const { return Slot == other.Slot && Generation == other.Generation; }
+	bool operator !=(const ObjectHandle& other) const { return !(*this == other); }
+};
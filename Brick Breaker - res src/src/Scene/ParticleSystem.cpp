@@ -0,0 +1,116 @@
+#include "Scene/ParticleSystem.h"
+
+#include <algorithm>
+#include <Logging.h>
+
+ParticleSystem::ParticleSystem(uint32_t capacity, const Shader::Sptr& updateShader, const Shader::Sptr& drawShader) :
+	_capacity(capacity),
+	_updateShader(updateShader),
+	_drawShader(drawShader),
+	_particles(StorageBuffer::Create(BufferUsage::DynamicCopy)),
+	_emitters(StorageBuffer::Create(BufferUsage::DynamicDraw)),
+	_emptyVao(VertexArrayObject::Create()),
+	_pending(std::vector<EmitterData>()),
+	_head(0),
+	_time(0.0f),
+	_aliveUntil(0.0f),
+	_stats(Stats())
+{
+	LOG_ASSERT(capacity > 0, "Particle capacity must be greater than zero!");
+	LOG_ASSERT(updateShader != nullptr && drawShader != nullptr, "Particle system needs both an update and a draw shader!");
+
+	// Every particle starts off dead. This is the only time particle data goes from the CPU to the GPU
+	std::vector<Particle> particles(capacity, Particle{ glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f) });
+	_particles->LoadData(particles.data(), particles.size());
+
+	// The emitter buffer always holds the most emitters we allow, so re-uploading it never reallocates
+	_pending.resize(MAX_EMITTERS_PER_UPDATE);
+	_emitters->LoadData(_pending.data(), _pending.size());
+	_pending.clear();
+}
+
+bool ParticleSystem::IsSupported() {
+	return GLAD_GL_VERSION_4_3 != 0;
+}
+
+bool ParticleSystem::Emit(ParticleEmitter emitter) {
+	if (_pending.size() >= MAX_EMITTERS_PER_UPDATE) {
+		_stats.DroppedEmitters++;
+		return false;
+	}
+	emitter.Count = std::min(emitter.Count, _capacity);
+	emitter.FirstIndex = _head;
+	_head = (_head + emitter.Count) % _capacity;
+	// Matches the longest lifetime ParticleSim::Spawn can pick
+	_aliveUntil = std::max(_aliveUntil, _time + emitter.Life * 1.25f);
+
+	EmitterData data;
+	data.PositionSpeed = glm::vec4(emitter.Position, emitter.Speed);
+	data.ColorLife = glm::vec4(emitter.Color, emitter.Life);
+	data.Size = glm::vec4(emitter.Size, 0.0f, 0.0f, 0.0f);
+	data.Range = glm::uvec4(emitter.FirstIndex, emitter.Count, emitter.Seed, 0);
+	_pending.push_back(data);
+	return true;
+}
+
+void ParticleSystem::Update(float deltaTime, const ParticleSettings& settings) {
+	const uint32_t dropped = _stats.DroppedEmitters;
+	_stats = Stats();
+	_stats.DroppedEmitters = dropped;
+	_stats.Emitters = static_cast<uint32_t>(_pending.size());
+	for (const EmitterData& emitter : _pending) {
+		_stats.Spawned += emitter.Range.y;
+	}
+
+	// Once everything is dead there's no point in touching the buffer until something new is emitted
+	_time += deltaTime;
+	_stats.IsActive = !_pending.empty() || _time <= _aliveUntil;
+	if (!_stats.IsActive) {
+		return;
+	}
+
+	if (!_pending.empty()) {
+		_emitters->LoadData(_pending.data(), _pending.size());
+	}
+	_particles->BindBase(PARTICLE_BUFFER_BINDING);
+	_emitters->BindBase(EMITTER_BUFFER_BINDING);
+
+	_updateShader->SetUniform("u_DeltaTime", deltaTime);
+	_updateShader->SetUniform("u_Gravity", settings.Gravity);
+	_updateShader->SetUniform("u_Drag", settings.Drag);
+	_updateShader->SetUniform("u_Capacity", static_cast<int>(_capacity));
+	_updateShader->SetUniform("u_EmitterCount", static_cast<int>(_pending.size()));
+
+	_stats.WorkGroups = (_capacity + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+	_updateShader->Dispatch(_stats.WorkGroups);
+	// The draw reads the particles that the compute shader just wrote
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	_pending.clear();
+}
+
+void ParticleSystem::Draw(const glm::mat4& viewProjection, float viewportHeight, float projectionScaleY) {
+	if (!_stats.IsActive) {
+		return;
+	}
+
+	_drawShader->Bind();
+	_drawShader->SetUniformMatrix("u_ViewProjection", viewProjection);
+	// A particle of size 1 at a distance of 1 covers this many pixels
+	_drawShader->SetUniform("u_PointScale", viewportHeight * projectionScaleY * 0.5f);
+	_particles->BindBase(PARTICLE_BUFFER_BINDING);
+	_emptyVao->Bind();
+
+	// Debris glows, so it's added on top of whatever is behind it, and doesn't hide other particles
+	glEnable(GL_PROGRAM_POINT_SIZE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	glDepthMask(GL_FALSE);
+
+	// Dead particles are moved outside of the view in the vertex shader, so they get clipped before rasterizing
+	glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_capacity));
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	glDisable(GL_PROGRAM_POINT_SIZE);
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Shader.h"
+#include "Graphics/StorageBuffer.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Game/ParticleSim.h"
+
+/// <summary>
+/// Particles that are simulated and drawn entirely on the GPU. The particles live in a storage buffer that is
+/// only ever written by a compute shader, the CPU just uploads the emitters that were added each frame (a few
+/// bytes each), so the number of particles costs no CPU time at all, and nothing is ever read back
+///
+/// Emitters claim a range of the buffer like a ring buffer, replacing the oldest particles once it fills up.
+/// The compute shader spawns the particles in those ranges and integrates the rest, and then the particles are
+/// drawn as point sprites straight from the same buffer. See ParticleSim for the CPU version of the same math
+///
+/// Requires OpenGL 4.3 for compute shaders and storage buffers
+/// </summary>
+class ParticleSystem
+{
+public:
+	typedef std::shared_ptr<ParticleSystem> Sptr;
+
+	// The binding points of the storage buffers, must match the shaders
+	static constexpr uint32_t PARTICLE_BUFFER_BINDING = 1;
+	static constexpr uint32_t EMITTER_BUFFER_BINDING = 2;
+	// Must match local_size_x in particles_update.glsl
+	static constexpr uint32_t WORKGROUP_SIZE = 256;
+	// The most emitters that can be added between updates, any more are dropped
+	static constexpr uint32_t MAX_EMITTERS_PER_UPDATE = 64;
+
+	/// <summary>
+	/// Counts of the work done by the last call to Update
+	/// </summary>
+	struct Stats {
+		uint32_t Emitters;
+		uint32_t Spawned;
+		uint32_t DroppedEmitters;
+		uint32_t WorkGroups;
+		// False if every particle was already dead, so nothing was simulated or drawn
+		bool     IsActive;
+	};
+
+	static inline Sptr Create(uint32_t capacity, const Shader::Sptr& updateShader, const Shader::Sptr& drawShader) {
+		return std::make_shared<ParticleSystem>(capacity, updateShader, drawShader);
+	}
+
+	/// <summary>
+	/// Creates a new particle system, with all of it's particles dead
+	/// </summary>
+	/// <param name="capacity">The most particles that can be alive at once</param>
+	/// <param name="updateShader">The compute shader that spawns and integrates the particles (particles_update.glsl)</param>
+	/// <param name="drawShader">The shader that draws the particles as point sprites (particles_vert.glsl and particles_frag.glsl)</param>
+	ParticleSystem(uint32_t capacity, const Shader::Sptr& updateShader, const Shader::Sptr& drawShader);
+	~ParticleSystem() = default;
+
+	/// <summary>
+	/// Returns true if the current OpenGL context supports compute shaders and storage buffers
+	/// </summary>
+	static bool IsSupported();
+
+	/// <summary>
+	/// Adds a burst of particles, which get spawned on the next Update
+	/// </summary>
+	/// <returns>True if the emitter was added, false if too many have been added since the last update</returns>
+	bool Emit(ParticleEmitter emitter);
+	/// <summary>
+	/// Spawns the particles from the emitters that were added, and moves every particle forward in time
+	/// </summary>
+	void Update(float deltaTime, const ParticleSettings& settings);
+	/// <summary>
+	/// Draws every particle that's alive, should be called after the opaque objects since particles don't write depth
+	/// </summary>
+	/// <param name="viewProjection">The camera's view projection matrix</param>
+	/// <param name="viewportHeight">The height of the viewport in pixels, for sizing the point sprites</param>
+	/// <param name="projectionScaleY">Element [1][1] of the camera's projection matrix, for sizing the point sprites</param>
+	void Draw(const glm::mat4& viewProjection, float viewportHeight, float projectionScaleY);
+
+	uint32_t GetCapacity() const { return _capacity; }
+	const Stats& GetStats() const { return _stats; }
+
+protected:
+	/// <summary>
+	/// An emitter, laid out to match the std430 struct in particles_update.glsl
+	/// </summary>
+	struct EmitterData {
+		glm::vec4  PositionSpeed;
+		glm::vec4  ColorLife;
+		glm::vec4  Size;
+		// X is the first index, Y is the count and Z is the seed
+		glm::uvec4 Range;
+	};
+
+	uint32_t                 _capacity;
+	Shader::Sptr             _updateShader;
+	Shader::Sptr             _drawShader;
+	StorageBuffer::Sptr      _particles;
+	StorageBuffer::Sptr      _emitters;
+	// Core profile needs a VAO bound to draw, even though the vertex shader reads everything from the storage buffer
+	VertexArrayObject::Sptr  _emptyVao;
+
+	std::vector<EmitterData> _pending;
+	// Where the next emitter will start spawning
+	uint32_t                 _head;
+	// Seconds since the system was created, and the time the last particle that was spawned dies
+	float                    _time;
+	float                    _aliveUntil;
+
+	Stats _stats;
+};
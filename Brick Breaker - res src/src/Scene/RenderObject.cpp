@@ -0,0 +1,73 @@
+#include "Scene/RenderObject.h"
+
+#include "Utils/MeshBuilder.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+RenderObject::RenderObject(TransformStore* transforms) :
+	Name("Unknown"),
+	GUID(Guid::New()),
+	Handle(ObjectHandle()),
+	Mesh(nullptr),
+	Material(nullptr),
+	MeshBuilderParams(std::vector<MeshBuilderParam>()),
+	Transforms(transforms),
+	TransformIndex(transforms->Allocate()) {}
+
+void RenderObject::GenerateMesh() {
+	if (MeshBuilderParams.size() > 0) {
+		if (Mesh != nullptr) {
+			LOG_WARN("Overriding existing mesh!");
+		}
+		MeshBuilder<VertexPosNormTexCol> mesh;
+		for (int ix = 0; ix < MeshBuilderParams.size(); ix++) {
+			MeshFactory::AddParameterized(mesh, MeshBuilderParams[ix]);
+		}
+		Mesh = mesh.Bake(ResourceManager::GetGeometryPool());
+	}
+}
+
+RenderObject RenderObject::FromJson(const nlohmann::json& data, TransformStore* transforms) {
+	RenderObject result = RenderObject(transforms);
+	result.Name = data["name"];
+	result.GUID = Guid(data["guid"]);
+	result.Mesh = ResourceManager::GetMesh(Guid(data["mesh"]));
+	// TODO material is not in resource manager
+	//objects[ix]["material"] = obj.Material->GetGUID().str();
+	result.SetPosition(ParseJsonVec3(data["position"]));
+	result.SetRotation(ParseJsonVec3(data["rotation"]));
+	result.SetScale(ParseJsonVec3(data["scale"]));
+	// If we have mesh parameters, we'll use that instead of the existing mesh
+	if (data.contains("mesh_params") && data["mesh_params"].is_array()) {
+		std::vector<nlohmann::json> meshbuilderParams = data["mesh_params"].get<std::vector<nlohmann::json>>();
+		MeshBuilder<VertexPosNormTexCol> mesh;
+		for (int ix = 0; ix < meshbuilderParams.size(); ix++) {
+			MeshBuilderParam p = MeshBuilderParam::FromJson(meshbuilderParams[ix]);
+			result.MeshBuilderParams.push_back(p);
+			MeshFactory::AddParameterized(mesh, p);
+		}
+		result.Mesh = mesh.Bake(ResourceManager::GetGeometryPool());
+	}
+	return result;
+}
+
+nlohmann::json RenderObject::ToJson() const {
+	nlohmann::json result = {
+		{ "name", Name },
+		{ "guid", GUID.str() },
+		{ "mesh", Mesh->GetGUID().str() },
+		{ "material", Material->GetGUID().str() },
+		{ "position", GlmToJson(GetPosition()) },
+		{ "rotation", GlmToJson(GetRotation()) },
+		{ "scale", GlmToJson(GetScale()) },
+	};
+	if (MeshBuilderParams.size() > 0) {
+		std::vector<nlohmann::json> params = std::vector<nlohmann::json>();
+		params.resize(MeshBuilderParams.size());
+		for (int ix = 0; ix < MeshBuilderParams.size(); ix++) {
+			params[ix] = MeshBuilderParams[ix].ToJson();
+		}
+		result["mesh_params"] = params;
+	}
+	return result;
+}
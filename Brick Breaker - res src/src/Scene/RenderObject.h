@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Scene/MaterialInfo.h"
+#include "Scene/ObjectHandle.h"
+#include "Scene/TransformStore.h"
+#include "Utils/MeshFactory.h"
+#include "Utils/GUID.hpp"
+
+// Helper structure to represent an object 
+// with a transform, mesh, and material
+struct RenderObject {
+	// Human readable name for the object
+	std::string             Name;
+	// Unique ID for the object
+	Guid                    GUID;
+	// The handle for this object in it's scene, assigned when the object is added to a scene
+	ObjectHandle            Handle;
+	// The object's mesh
+	VertexArrayObject::Sptr Mesh;
+	// The object's material
+	MaterialInfo::Sptr      Material;
+
+	// If we want to use MeshFactory, we can populate this list
+	std::vector<MeshBuilderParam> MeshBuilderParams;
+
+	// The store that holds this object's position, rotation, scale and world transform
+	TransformStore*         Transforms;
+	// The index of this object's transform within Transforms
+	uint32_t                TransformIndex;
+
+	/// <summary>
+	/// Creates a new render object, allocating it's transform from the given store
+	/// </summary>
+	/// <param name="transforms">The store to allocate the object's transform from (usually the scene's)</param>
+	RenderObject(TransformStore* transforms);
+
+	// Position of the object
+	const glm::vec3& GetPosition() const { return Transforms->GetPosition(TransformIndex); }
+	void SetPosition(const glm::vec3& value) { Transforms->SetPosition(TransformIndex, value); }
+	// Rotation of the object in Euler angles
+	const glm::vec3& GetRotation() const { return Transforms->GetRotation(TransformIndex); }
+	void SetRotation(const glm::vec3& value) { Transforms->SetRotation(TransformIndex, value); }
+	// The scale of the object
+	const glm::vec3& GetScale() const { return Transforms->GetScale(TransformIndex); }
+	void SetScale(const glm::vec3& value) { Transforms->SetScale(TransformIndex, value); }
+	// Attaches this object to a parent, after which it's position, rotation and scale are relative to
+	// the parent. Pass nullptr to detach the object. Returns false if the parent is one of our children
+	bool SetParent(const RenderObject* parent) {
+		return Transforms->SetParent(TransformIndex, parent != nullptr ? parent->TransformIndex : TransformStore::NO_PARENT);
+	}
+	// The index of the parent's transform, or TransformStore::NO_PARENT if the object has no parent
+	uint32_t GetParentTransform() const { return Transforms->GetParent(TransformIndex); }
+	// The object's world transform, as of the last time it was recalculated
+	const glm::mat4& GetTransform() const { return Transforms->GetWorldMatrix(TransformIndex); }
+	// The object's normal matrix, as of the last time it's transform was recalculated
+	const glm::mat3& GetNormalMatrix() const { return Transforms->GetNormalMatrix(TransformIndex); }
+
+	// Recalculates the Transform from the parameters (pos, rot, scale), as well as the transforms of any children
+	void RecalcTransform() { Transforms->Recalc(TransformIndex); }
+
+	// Regenerates this object's mesh if it is using the MeshFactory
+	void GenerateMesh();
+
+	/// <summary>
+	/// Loads a render object from a JSON blob
+	/// </summary>
+	/// <param name="data">The JSON blob to load the object from</param>
+	/// <param name="transforms">The store to allocate the object's transform from</param>
+	static RenderObject FromJson(const nlohmann::json& data, TransformStore* transforms);
+
+	/// <summary>
+	/// Converts this object into it's JSON representation for storage
+	/// Note that the parent is stored by the scene, since the object doesn't know it's parent's GUID
+	/// </summary>
+	nlohmann::json ToJson() const;
+};
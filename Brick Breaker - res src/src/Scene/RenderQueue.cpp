@@ -0,0 +1,158 @@
+#include "Scene/RenderQueue.h"
+#include "Graphics/GLState.h"
+
+#include <cstring>
+
+// Bit layout of the sort keys, see RenderQueue.h
+static const int      PASS_SHIFT     = 62;
+static const int      SHADER_SHIFT   = 52;
+static const int      MATERIAL_SHIFT = 38;
+static const int      MESH_SHIFT     = 24;
+static const uint32_t SHADER_MAX     = (1u << 10) - 1;
+static const uint32_t MATERIAL_MAX   = (1u << 14) - 1;
+static const uint32_t MESH_MAX       = (1u << 14) - 1;
+static const uint32_t DEPTH_MAX      = (1u << 24) - 1;
+
+RenderQueue::RenderQueue() :
+	_items(std::vector<Item>()),
+	_order(std::vector<uint32_t>()),
+	_keys(std::vector<uint64_t>()),
+	_keyScratch(std::vector<uint64_t>()),
+	_orderScratch(std::vector<uint32_t>()),
+	_shaderIds(std::unordered_map<const void*, uint32_t>()),
+	_materialIds(std::unordered_map<const void*, uint32_t>()),
+	_meshIds(std::unordered_map<const void*, uint32_t>()),
+	_stats(Stats()) { }
+
+void RenderQueue::Clear() {
+	_items.clear();
+	_order.clear();
+	_keys.clear();
+	_shaderIds.clear();
+	_materialIds.clear();
+	_meshIds.clear();
+}
+
+uint32_t RenderQueue::_GetId(std::unordered_map<const void*, uint32_t>& ids, const void* resource, uint32_t maxId) {
+	auto it = ids.find(resource);
+	if (it != ids.end()) {
+		return it->second;
+	}
+	// If we run out of IDs, everything else shares the last one. Draws still work, they just won't be grouped as well
+	uint32_t id = static_cast<uint32_t>(ids.size());
+	if (id > maxId) {
+		id = maxId;
+	}
+	ids[resource] = id;
+	return id;
+}
+
+void RenderQueue::Submit(Shader* shader, MaterialInfo* material, VertexArrayObject* mesh, uint32_t objectIndex, float viewDepth, RenderPass pass) {
+	// For positive floats the bit pattern increases with the value, so the top bits make a good depth key
+	uint32_t depth = 0;
+	if (viewDepth > 0.0f) {
+		uint32_t bits;
+		memcpy(&bits, &viewDepth, sizeof(float));
+		depth = bits >> 7; // Sign bit is 0, so this leaves the top 24 bits
+	}
+	// Transparent objects need to be drawn back to front
+	if (pass == RenderPass::Transparent) {
+		depth = DEPTH_MAX - depth;
+	}
+
+	uint64_t key = 0;
+	key |= static_cast<uint64_t>(pass) << PASS_SHIFT;
+	key |= static_cast<uint64_t>(_GetId(_shaderIds, shader, SHADER_MAX)) << SHADER_SHIFT;
+	key |= static_cast<uint64_t>(_GetId(_materialIds, material, MATERIAL_MAX)) << MATERIAL_SHIFT;
+	key |= static_cast<uint64_t>(_GetId(_meshIds, mesh, MESH_MAX)) << MESH_SHIFT;
+	key |= static_cast<uint64_t>(depth & DEPTH_MAX);
+
+	_order.push_back(static_cast<uint32_t>(_items.size()));
+	_keys.push_back(key);
+	_items.push_back({ shader, material, mesh, objectIndex });
+}
+
+void RenderQueue::Sort() {
+	const size_t count = _keys.size();
+	if (count < 2) {
+		return;
+	}
+
+	// LSD radix sort, one byte at a time. The keys are sorted along with the item indices, bouncing between the
+	// arrays and their scratch buffers, which keep their capacity from frame to frame so sorting never allocates
+	_keyScratch.resize(count);
+	_orderScratch.resize(count);
+	uint64_t* keysIn  = _keys.data();
+	uint64_t* keysOut = _keyScratch.data();
+	uint32_t* orderIn  = _order.data();
+	uint32_t* orderOut = _orderScratch.data();
+
+	for (int shift = 0; shift < 64; shift += 8) {
+		uint32_t histogram[256] = { 0 };
+		for (size_t ix = 0; ix < count; ix++) {
+			histogram[(keysIn[ix] >> shift) & 0xFF]++;
+		}
+		// If every key has the same value for this byte (common for the pass and upper ID bits), the pass would do nothing
+		if (histogram[(keysIn[0] >> shift) & 0xFF] == count) {
+			continue;
+		}
+
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			const uint32_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+		for (size_t ix = 0; ix < count; ix++) {
+			const uint32_t dest = histogram[(keysIn[ix] >> shift) & 0xFF]++;
+			keysOut[dest] = keysIn[ix];
+			orderOut[dest] = orderIn[ix];
+		}
+		std::swap(keysIn, keysOut);
+		std::swap(orderIn, orderOut);
+	}
+
+	// Make sure the sorted keys and order end up back in _keys and _order
+	if (orderIn != _order.data()) {
+		_keys.swap(_keyScratch);
+		_order.swap(_orderScratch);
+	}
+}
+
+void RenderQueue::Execute(const ObjectCallback& setObjectUniforms) {
+	_stats = Stats();
+	_stats.Items = static_cast<uint32_t>(_items.size());
+
+	MaterialInfo* currentMaterial = nullptr;
+
+	// If Sort was never called, _order is still in submission order
+	for (uint32_t index : _order) {
+		const Item& item = _items[index];
+
+		// The binds themselves are filtered by GLState, we only check here so we can count them
+		if (item.Shader->GetHandle() != GLState::GetProgram()) {
+			item.Shader->Bind();
+			_stats.ShaderBinds++;
+		}
+
+		if (item.Material != currentMaterial) {
+			item.Material->ApplyUniforms();
+			currentMaterial = item.Material;
+			_stats.MaterialChanges++;
+
+			if (item.Material->Texture != nullptr && item.Material->Texture->GetHandle() != GLState::GetTexture(0)) {
+				item.Material->Texture->Bind(0);
+				_stats.TextureBinds++;
+			}
+		}
+
+		setObjectUniforms(*item.Shader, item);
+
+		if (item.Mesh->GetHandle() != GLState::GetVertexArray()) {
+			item.Mesh->Bind();
+			_stats.MeshBinds++;
+		}
+		item.Mesh->DrawWithoutBinding();
+		_stats.DrawCalls++;
+	}
+}
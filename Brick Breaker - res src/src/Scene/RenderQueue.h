@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+#include "Graphics/Shader.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Scene/MaterialInfo.h"
+
+/// <summary>
+/// Collects all the draws for a frame, sorts them to group together draws that share state, then submits
+/// them while skipping any binds that would not change anything
+///
+/// Each draw gets a 64 bit sort key, from most to least significant bits:
+///    [63-62] render pass
+///    [61-52] shader
+///    [51-38] material
+///    [37-24] mesh
+///    [23-0]  depth (front to back for opaque, back to front for transparent)
+/// Shader, material and mesh IDs are handed out in the order they are first submitted each frame
+/// </summary>
+class RenderQueue {
+public:
+	/// <summary>
+	/// The passes that draws can be submitted to, passes are drawn in order
+	/// </summary>
+	enum class RenderPass : uint8_t {
+		Opaque      = 0,
+		Transparent = 1
+	};
+
+	/// <summary>
+	/// A single draw in the queue
+	/// </summary>
+	struct Item {
+		Shader*            Shader;
+		MaterialInfo*      Material;
+		VertexArrayObject* Mesh;
+		// Identifies the object being drawn to the per-object callback (ex: the index into Scene::Objects)
+		uint32_t           ObjectIndex;
+	};
+
+	/// <summary>
+	/// Counts of the work done by the last call to Execute
+	/// </summary>
+	struct Stats {
+		uint32_t Items;
+		uint32_t DrawCalls;
+		uint32_t ShaderBinds;
+		uint32_t MaterialChanges;
+		uint32_t TextureBinds;
+		uint32_t MeshBinds;
+
+		// The total number of state changes that were made
+		uint32_t GetStateChanges() const { return ShaderBinds + MaterialChanges + TextureBinds + MeshBinds; }
+	};
+
+	/// <summary>
+	/// Invoked before each item is drawn, after it's shader has been bound, to upload per-object uniforms
+	/// </summary>
+	typedef std::function<void(Shader& shader, const Item& item)> ObjectCallback;
+
+	RenderQueue();
+	~RenderQueue() = default;
+
+	/// <summary>
+	/// Removes all items from the queue, should be called at the start of each frame
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Adds a draw to the queue
+	/// </summary>
+	/// <param name="shader">The shader to draw with</param>
+	/// <param name="material">The material to draw with</param>
+	/// <param name="mesh">The mesh to draw</param>
+	/// <param name="objectIndex">User data identifying the object, passed back to the per-object callback</param>
+	/// <param name="viewDepth">The distance of the object along the camera's forward axis</param>
+	/// <param name="pass">The render pass to draw the object in</param>
+	void Submit(Shader* shader, MaterialInfo* material, VertexArrayObject* mesh, uint32_t objectIndex, float viewDepth, RenderPass pass = RenderPass::Opaque);
+
+	/// <summary>
+	/// Sorts all the items in the queue by their keys
+	/// </summary>
+	void Sort();
+
+	/// <summary>
+	/// Draws all items in the queue in sorted order, only binding shaders, materials, textures and meshes when they change
+	/// </summary>
+	/// <param name="setObjectUniforms">The callback to upload each item's per-object uniforms</param>
+	void Execute(const ObjectCallback& setObjectUniforms);
+
+	/// <summary>
+	/// Gets the number of items in the queue
+	/// </summary>
+	size_t GetCount() const { return _items.size(); }
+	/// <summary>
+	/// Gets the stats from the last call to Execute
+	/// </summary>
+	const Stats& GetStats() const { return _stats; }
+
+protected:
+	std::vector<Item>     _items;
+	std::vector<uint32_t> _order;      // Item indices, in submission order until Sort is called
+	std::vector<uint64_t> _keys;       // Sort key for the item at the same position in _order, so they get sorted together
+	std::vector<uint64_t> _keyScratch; // Ping-pong buffers for the radix sort, swapped with the arrays above
+	std::vector<uint32_t> _orderScratch;
+
+	// Compact IDs for the resources seen so far this frame, so they fit in their bits of the key
+	std::unordered_map<const void*, uint32_t> _shaderIds;
+	std::unordered_map<const void*, uint32_t> _materialIds;
+	std::unordered_map<const void*, uint32_t> _meshIds;
+
+	Stats _stats;
+
+	// Gets the ID for a resource, assigning the next ID if it's new this frame
+	static uint32_t _GetId(std::unordered_map<const void*, uint32_t>& ids, const void* resource, uint32_t maxId);
+};
@@ -0,0 +1,293 @@
+#include "Scene/Scene.h"
+
+#include <Logging.h>
+
+#include "Utils/FileHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/JsonStreamReader.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+/// <summary>
+/// Attaches objects to their parents once all the objects in a scene have been loaded, since
+/// children may be stored before their parents
+/// </summary>
+/// <param name="scene">The scene to resolve the parents in</param>
+/// <param name="parents">Pairs of object indices and the GUIDs of their parents</param>
+static void ResolveParents(Scene& scene, const std::vector<std::pair<size_t, Guid>>& parents) {
+	if (parents.empty()) {
+		return;
+	}
+	for (auto& [index, parentId] : parents) {
+		RenderObject* parent = scene.FindObjectByGuid(parentId);
+		if (parent != nullptr) {
+			scene.Objects[index].SetParent(parent);
+		} else {
+			LOG_WARN("Parent {} of object \"{}\" not found in scene", parentId.str(), scene.Objects[index].Name);
+		}
+	}
+}
+
+Scene::Scene() :
+	Materials(std::unordered_map<Guid, MaterialInfo::Sptr>()),
+	Transforms(TransformStore()),
+	Objects(std::vector<RenderObject>()),
+	Lights(std::vector<Light>()),
+	Camera(nullptr),
+	BaseShader(nullptr),
+	_handleSlots(std::vector<HandleSlot>()),
+	_freeHandleSlots(std::vector<uint32_t>()),
+	_objectSlots(std::vector<uint32_t>()),
+	_nameLookup(std::unordered_map<std::string, ObjectHandle>()),
+	_guidLookup(std::unordered_map<Guid, ObjectHandle>()) {}
+
+RenderObject& Scene::CreateObject(const std::string& name) {
+	RenderObject object = RenderObject(&Transforms);
+	object.Name = name;
+	AddObject(object);
+	return Objects.back();
+}
+
+ObjectHandle Scene::AddObject(const RenderObject& object) {
+	// Grab a free slot if we have one, otherwise make a new one
+	uint32_t slot;
+	if (!_freeHandleSlots.empty()) {
+		slot = _freeHandleSlots.back();
+		_freeHandleSlots.pop_back();
+	} else {
+		slot = static_cast<uint32_t>(_handleSlots.size());
+		_handleSlots.push_back({ 0, 0 });
+	}
+	_handleSlots[slot].ObjectIndex = static_cast<uint32_t>(Objects.size());
+	ObjectHandle handle = ObjectHandle(slot, _handleSlots[slot].Generation);
+
+	Objects.push_back(object);
+	Objects.back().Handle = handle;
+	_objectSlots.push_back(slot);
+
+	// emplace won't replace an existing entry, so the first object with a given name wins
+	_nameLookup.emplace(object.Name, handle);
+	_guidLookup[object.GUID] = handle;
+	return handle;
+}
+
+bool Scene::RemoveObject(ObjectHandle handle) {
+	RenderObject* object = GetObjectByHandle(handle);
+	if (object == nullptr) {
+		return false;
+	}
+
+	_RemoveNameLookup(*object);
+	auto guidIt = _guidLookup.find(object->GUID);
+	if (guidIt != _guidLookup.end() && guidIt->second == handle) {
+		_guidLookup.erase(guidIt);
+	}
+	Transforms.Free(object->TransformIndex);
+
+	// Swap the last object into the removed object's place, so that Objects stays tightly packed
+	const uint32_t index = _handleSlots[handle.Slot].ObjectIndex;
+	const uint32_t last = static_cast<uint32_t>(Objects.size() - 1);
+	if (index != last) {
+		Objects[index] = std::move(Objects[last]);
+		_objectSlots[index] = _objectSlots[last];
+		_handleSlots[_objectSlots[index]].ObjectIndex = index;
+	}
+	Objects.pop_back();
+	_objectSlots.pop_back();
+
+	// Bumping the generation invalidates any handles still referring to the removed object
+	_handleSlots[handle.Slot].Generation++;
+	_freeHandleSlots.push_back(handle.Slot);
+	return true;
+}
+
+bool Scene::RenameObject(ObjectHandle handle, const std::string& name) {
+	RenderObject* object = GetObjectByHandle(handle);
+	if (object == nullptr) {
+		return false;
+	}
+	_RemoveNameLookup(*object);
+	object->Name = name;
+	_nameLookup.emplace(name, handle);
+	return true;
+}
+
+RenderObject* Scene::GetObjectByHandle(ObjectHandle handle) {
+	if (handle.Slot >= _handleSlots.size() || _handleSlots[handle.Slot].Generation != handle.Generation) {
+		return nullptr;
+	}
+	return &Objects[_handleSlots[handle.Slot].ObjectIndex];
+}
+
+ObjectHandle Scene::FindHandleByName(const std::string& name) const {
+	auto it = _nameLookup.find(name);
+	return it == _nameLookup.end() ? ObjectHandle() : it->second;
+}
+
+RenderObject* Scene::FindObjectByName(const std::string& name) {
+	return GetObjectByHandle(FindHandleByName(name));
+}
+
+RenderObject* Scene::FindObjectByGuid(const Guid& id) {
+	auto it = _guidLookup.find(id);
+	return it == _guidLookup.end() ? nullptr : GetObjectByHandle(it->second);
+}
+
+void Scene::_RemoveNameLookup(const RenderObject& object) {
+	auto it = _nameLookup.find(object.Name);
+	if (it == _nameLookup.end() || it->second != object.Handle) {
+		return;
+	}
+	_nameLookup.erase(it);
+	// Names aren't unique, so we need to check if any other object can take over the name. This is
+	// a linear search, but it only happens when removing or renaming an object whose name is in the lookup
+	for (const RenderObject& other : Objects) {
+		if (other.Handle != object.Handle && other.Name == object.Name) {
+			_nameLookup.emplace(other.Name, other.Handle);
+			break;
+		}
+	}
+}
+
+Scene::Sptr Scene::FromJson(const nlohmann::json& data) {
+	Scene::Sptr result = std::make_shared<Scene>();
+	result->BaseShader = ResourceManager::GetShader(Guid(data["default_shader"]));
+
+	LOG_ASSERT(data["materials"].is_array(), "Materials not present in scene!");
+	for (auto& material : data["materials"]) {
+		MaterialInfo::Sptr mat = MaterialInfo::FromJson(material);
+		result->Materials[mat->GetGUID()] = mat;
+	}
+
+	LOG_ASSERT(data["objects"].is_array(), "Objects not present in scene!");
+	std::vector<std::pair<size_t, Guid>> parents;
+	for (auto& object : data["objects"]) {
+		RenderObject obj = RenderObject::FromJson(object, &result->Transforms);
+		obj.Material = result->Materials[Guid(object["material"])];
+		if (object.contains("parent")) {
+			parents.push_back({ result->Objects.size(), Guid(object["parent"].get<std::string>()) });
+		}
+		result->AddObject(obj);
+	}
+	ResolveParents(*result, parents);
+
+	LOG_ASSERT(data["lights"].is_array(), "Lights not present in scene!");
+	for (auto& light : data["lights"]) {
+		result->Lights.push_back(Light::FromJson(light));
+	}
+
+	// Create and load camera config
+	result->Camera = Camera::Create();
+	result->Camera->SetPosition(ParseJsonVec3(data["camera"]["position"]));
+	result->Camera->SetForward(ParseJsonVec3(data["camera"]["normal"]));
+
+	return result;
+}
+
+nlohmann::json Scene::ToJson() const {
+	nlohmann::json blob;
+	// Save the default shader (really need a material class)
+	blob["default_shader"] = BaseShader->GetGUID().str();
+
+	// Save materials (TODO: this should be managed by the ResourceManager)
+	std::vector<nlohmann::json> materials;
+	materials.resize(Materials.size());
+	int ix = 0;
+	for (auto& [key, value] : Materials) {
+		materials[ix] = value->ToJson();
+		ix++;
+	}
+	blob["materials"] = materials;
+
+	// Save renderables
+	std::vector<const RenderObject*> objectsByTransform(Transforms.GetCount(), nullptr);
+	for (const RenderObject& object : Objects) {
+		objectsByTransform[object.TransformIndex] = &object;
+	}
+	std::vector<nlohmann::json> objects;
+	objects.resize(Objects.size());
+	for (int ix = 0; ix < Objects.size(); ix++) {
+		objects[ix] = Objects[ix].ToJson();
+		// Parents are stored by GUID, since transform indices aren't stable between runs
+		uint32_t parent = Objects[ix].GetParentTransform();
+		if (parent != TransformStore::NO_PARENT && objectsByTransform[parent] != nullptr) {
+			objects[ix]["parent"] = objectsByTransform[parent]->GUID.str();
+		}
+	}
+	blob["objects"] = objects;
+
+	// Save lights
+	std::vector<nlohmann::json> lights;
+	lights.resize(Lights.size());
+	for (int ix = 0; ix < Lights.size(); ix++) {
+		lights[ix] = Lights[ix].ToJson();
+	}
+	blob["lights"] = lights;
+
+	// Save camera info
+	blob["camera"] = {
+		{"position", GlmToJson(Camera->GetPosition()) },
+		{"normal",   GlmToJson(Camera->GetForward()) }
+	};
+
+	return blob;
+}
+
+void Scene::Save(const std::string& path) {
+	// Save data to file
+	FileHelpers::WriteContentsToFile(path, ToJson().dump());
+	LOG_INFO("Saved scene to \"{}\"", path);
+}
+
+Scene::Sptr Scene::Load(const std::string& path) {
+	LOG_INFO("Loading scene from \"{}\"", path);
+	Scene::Sptr result = std::make_shared<Scene>();
+	result->Camera = Camera::Create();
+
+	// Objects may be read before the material or parent they reference, so we
+	// resolve those once the whole file has been streamed in
+	std::vector<std::pair<size_t, Guid>> unresolvedMaterials;
+	std::vector<std::pair<size_t, Guid>> parents;
+
+	bool success = JsonStreamReader::ParseFile(path, [&](const std::string& key, const nlohmann::json& entry) {
+		if (key == "materials") {
+			MaterialInfo::Sptr mat = MaterialInfo::FromJson(entry);
+			result->Materials[mat->GetGUID()] = mat;
+		}
+		else if (key == "objects") {
+			RenderObject obj = RenderObject::FromJson(entry, &result->Transforms);
+			Guid materialId = Guid(entry["material"].get<std::string>());
+			auto it = result->Materials.find(materialId);
+			if (it != result->Materials.end()) {
+				obj.Material = it->second;
+			} else {
+				unresolvedMaterials.push_back({ result->Objects.size(), materialId });
+			}
+			if (entry.contains("parent")) {
+				parents.push_back({ result->Objects.size(), Guid(entry["parent"].get<std::string>()) });
+			}
+			result->AddObject(obj);
+		}
+		else if (key == "lights") {
+			result->Lights.push_back(Light::FromJson(entry));
+		}
+		else if (key == "camera") {
+			result->Camera->SetPosition(ParseJsonVec3(entry["position"]));
+			result->Camera->SetForward(ParseJsonVec3(entry["normal"]));
+		}
+		else if (key == "default_shader") {
+			result->BaseShader = ResourceManager::GetShader(Guid(entry.get<std::string>()));
+		}
+	});
+
+	if (!success) {
+		LOG_ERROR("Failed to load scene from \"{}\"", path);
+		return nullptr;
+	}
+
+	for (auto& [index, materialId] : unresolvedMaterials) {
+		result->Objects[index].Material = result->Materials[materialId];
+	}
+	ResolveParents(*result, parents);
+
+	return result;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <json.hpp>
+
+#include "Camera.h"
+#include "Graphics/Shader.h"
+#include "Scene/MaterialInfo.h"
+#include "Scene/ObjectHandle.h"
+#include "Scene/RenderObject.h"
+#include "Scene/Light.h"
+#include "Scene/TransformStore.h"
+#include "Utils/GUID.hpp"
+
+// Temporary structure for storing all our scene stuffs
+struct Scene {
+	typedef std::shared_ptr<Scene> Sptr;
+
+	std::unordered_map<Guid, MaterialInfo::Sptr> Materials; // Really should be in resources but meh
+
+	// Stores the transforms for all the objects in our scene
+	TransformStore             Transforms;
+	// Stores all the objects in our scene. Objects should be added and removed through the scene (ex: CreateObject)
+	// so that their handles and lookups stay up to date, and may move around within this list when objects are removed
+	std::vector<RenderObject>  Objects;
+	// Stores all the lights in our scene
+	std::vector<Light>         Lights;
+	// The camera for our scene
+	Camera::Sptr               Camera;
+
+	Shader::Sptr               BaseShader; // Should think of more elegant ways of handling this
+
+	Scene();
+
+	// The scene owns the transform store that it's objects point into
+	Scene(const Scene& other) = delete;
+	Scene& operator=(const Scene& other) = delete;
+
+	/// <summary>
+	/// Creates a new render object in this scene, with it's transform allocated from the scene's store
+	/// Note that the returned reference is only valid until the next object is added or removed, use the
+	/// object's Handle to refer to it for longer than that
+	/// </summary>
+	/// <param name="name">The human readable name for the object</param>
+	RenderObject& CreateObject(const std::string& name);
+	/// <summary>
+	/// Adds a copy of an existing object to this scene. The object's transform must have been allocated from this scene's store
+	/// </summary>
+	/// <param name="object">The object to add</param>
+	/// <returns>The handle for the newly added object</returns>
+	ObjectHandle AddObject(const RenderObject& object);
+	/// <summary>
+	/// Removes an object from this scene, freeing it's transform. The last object in Objects is moved into it's place
+	/// </summary>
+	/// <param name="handle">The handle of the object to remove</param>
+	/// <returns>True if the object was removed, false if the handle did not refer to an object</returns>
+	bool RemoveObject(ObjectHandle handle);
+	/// <summary>
+	/// Changes the name of an object, keeping the name lookup up to date
+	/// </summary>
+	/// <param name="handle">The handle of the object to rename</param>
+	/// <param name="name">The new name for the object</param>
+	/// <returns>True if the object was renamed, false if the handle did not refer to an object</returns>
+	bool RenameObject(ObjectHandle handle, const std::string& name);
+
+	/// <summary>
+	/// Gets the object that a handle refers to, or nullptr if the object has been removed
+	/// Note that the returned pointer is only valid until the next object is added or removed
+	/// </summary>
+	/// <param name="handle">The handle of the object to get</param>
+	RenderObject* GetObjectByHandle(ObjectHandle handle);
+	/// <summary>
+	/// Gets the handle of the first object added with the given name, or an invalid handle if no object is found
+	/// </summary>
+	/// <param name="name">The name of the object to find</param>
+	ObjectHandle FindHandleByName(const std::string& name) const;
+	/// <summary>
+	/// Gets the first object added to the scene with the given name, or nullptr if no object is found
+	/// </summary>
+	/// <param name="name">The name of the object to find</param>
+	RenderObject* FindObjectByName(const std::string& name);
+	/// <summary>
+	/// Gets the object with the given GUID, or nullptr if no object is found
+	/// </summary>
+	/// <param name="id">The GUID of the object to find</param>
+	RenderObject* FindObjectByGuid(const Guid& id);
+
+	/// <summary>
+	/// Loads a scene from a JSON blob
+	/// </summary>
+	static Scene::Sptr FromJson(const nlohmann::json& data);
+
+	/// <summary>
+	/// Converts this object into it's JSON representation for storage
+	/// </summary>
+	nlohmann::json ToJson() const;
+
+	/// <summary>
+	/// Saves this scene to an output JSON file
+	/// </summary>
+	/// <param name="path">The path of the file to write to</param>
+	void Save(const std::string& path);
+
+	/// <summary>
+	/// Loads a scene from an input JSON file. The file is streamed, so materials, objects and lights
+	/// are created as they are read, and the full JSON document is never held in memory
+	/// </summary>
+	/// <param name="path">The path of the file to read from</param>
+	/// <returns>A new scene loaded from the file, or nullptr if the file could not be parsed</returns>
+	static Scene::Sptr Load(const std::string& path);
+
+protected:
+	// Maps a handle's slot to the object's position in Objects
+	struct HandleSlot {
+		uint32_t ObjectIndex;
+		uint32_t Generation;
+	};
+	std::vector<HandleSlot> _handleSlots;
+	std::vector<uint32_t>   _freeHandleSlots;
+	// The handle slot for each entry in Objects, so we can fix up slots when objects move
+	std::vector<uint32_t>   _objectSlots;
+
+	std::unordered_map<std::string, ObjectHandle> _nameLookup;
+	std::unordered_map<Guid, ObjectHandle>        _guidLookup;
+
+	// Removes an object's name from the name lookup, replacing it with the next object that has the same name
+	void _RemoveNameLookup(const RenderObject& object);
+};
@@ -0,0 +1,285 @@
+#include "Scene/TransformStore.h"
+
+#include <algorithm>
+#include <Logging.h>
+#include "Utils/TransformKernels.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/common.hpp> // for fmod (floating modulus)
+
+static const glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
+static const glm::mat3 MAT3_IDENTITY = glm::mat3(1.0f);
+
+TransformStore::TransformStore() :
+	_positions(std::vector<glm::vec3>()),
+	_rotations(std::vector<glm::vec3>()),
+	_scales(std::vector<glm::vec3>()),
+	_localMatrices(std::vector<glm::mat4>()),
+	_localNormalMatrices(std::vector<glm::mat3>()),
+	_worldMatrices(std::vector<glm::mat4>()),
+	_normalMatrices(std::vector<glm::mat3>()),
+	_dirty(std::vector<uint8_t>()),
+	_dirtyList(std::vector<uint32_t>()),
+	_freeList(std::vector<uint32_t>()),
+	_parents(std::vector<uint32_t>()),
+	_firstChildren(std::vector<uint32_t>()),
+	_nextSiblings(std::vector<uint32_t>()),
+	_order(std::vector<uint32_t>()),
+	_ranks(std::vector<uint32_t>()),
+	_subtreeSizes(std::vector<uint32_t>()),
+	_isOrderDirty(false),
+	_orderStack(std::vector<uint32_t>()),
+	_lastRecalcCount(0) { }
+
+uint32_t TransformStore::Allocate() {
+	// Freed transforms have already been reset and are still in the order as roots, so they can be handed right back out
+	if (!_freeList.empty()) {
+		const uint32_t index = _freeList.back();
+		_freeList.pop_back();
+		return index;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(_positions.size());
+	_positions.push_back(glm::vec3(0.0f));
+	_rotations.push_back(glm::vec3(0.0f));
+	_scales.push_back(glm::vec3(1.0f));
+	// The default transform is the identity, so the new transform starts out clean
+	_localMatrices.push_back(MAT4_IDENTITY);
+	_localNormalMatrices.push_back(MAT3_IDENTITY);
+	_worldMatrices.push_back(MAT4_IDENTITY);
+	_normalMatrices.push_back(MAT3_IDENTITY);
+	_dirty.push_back(0);
+	// New transforms are roots, so they can go at the end of the order without disturbing it
+	_parents.push_back(NO_PARENT);
+	_firstChildren.push_back(NO_PARENT);
+	_nextSiblings.push_back(NO_PARENT);
+	_ranks.push_back(static_cast<uint32_t>(_order.size()));
+	_order.push_back(index);
+	_subtreeSizes.push_back(1);
+	return index;
+}
+
+void TransformStore::Clear() {
+	_positions.clear();
+	_rotations.clear();
+	_scales.clear();
+	_localMatrices.clear();
+	_localNormalMatrices.clear();
+	_worldMatrices.clear();
+	_normalMatrices.clear();
+	_dirty.clear();
+	_dirtyList.clear();
+	_freeList.clear();
+	_parents.clear();
+	_firstChildren.clear();
+	_nextSiblings.clear();
+	_order.clear();
+	_ranks.clear();
+	_subtreeSizes.clear();
+	_isOrderDirty = false;
+}
+
+void TransformStore::Reserve(size_t count) {
+	_positions.reserve(count);
+	_rotations.reserve(count);
+	_scales.reserve(count);
+	_localMatrices.reserve(count);
+	_localNormalMatrices.reserve(count);
+	_worldMatrices.reserve(count);
+	_normalMatrices.reserve(count);
+	_dirty.reserve(count);
+	_parents.reserve(count);
+	_firstChildren.reserve(count);
+	_nextSiblings.reserve(count);
+	_order.reserve(count);
+	_ranks.reserve(count);
+	_subtreeSizes.reserve(count);
+}
+
+void TransformStore::SetPosition(uint32_t index, const glm::vec3& value) {
+	_positions[index] = value;
+	_MarkDirty(index);
+}
+
+void TransformStore::SetRotation(uint32_t index, const glm::vec3& value) {
+	_rotations[index] = glm::fmod(value, glm::vec3(360.0f)); // Wrap all our angles into the 0-360 degree range
+	_MarkDirty(index);
+}
+
+void TransformStore::SetScale(uint32_t index, const glm::vec3& value) {
+	_scales[index] = value;
+	_MarkDirty(index);
+}
+
+void TransformStore::Free(uint32_t index) {
+	while (_firstChildren[index] != NO_PARENT) {
+		SetParent(_firstChildren[index], NO_PARENT);
+	}
+	SetParent(index, NO_PARENT);
+
+	// Reset to the default transform, so that the next object to get this index starts out at the origin
+	_positions[index] = glm::vec3(0.0f);
+	_rotations[index] = glm::vec3(0.0f);
+	_scales[index] = glm::vec3(1.0f);
+	_MarkDirty(index);
+	_freeList.push_back(index);
+}
+
+bool TransformStore::SetParent(uint32_t index, uint32_t parent) {
+	if (_parents[index] == parent) {
+		return true;
+	}
+	// Make sure we're not trying to parent a transform to itself or one of it's children
+	for (uint32_t ancestor = parent; ancestor != NO_PARENT; ancestor = _parents[ancestor]) {
+		if (ancestor == index) {
+			LOG_WARN("Cannot parent transform {} to {}, it would create a cycle", index, parent);
+			return false;
+		}
+	}
+
+	// Unlink from our old parent's list of children
+	const uint32_t oldParent = _parents[index];
+	if (oldParent != NO_PARENT) {
+		uint32_t* link = &_firstChildren[oldParent];
+		while (*link != index) {
+			link = &_nextSiblings[*link];
+		}
+		*link = _nextSiblings[index];
+	}
+	_nextSiblings[index] = NO_PARENT;
+
+	// Add to the end of the new parent's children, so siblings keep the order they were attached in
+	if (parent != NO_PARENT) {
+		uint32_t* link = &_firstChildren[parent];
+		while (*link != NO_PARENT) {
+			link = &_nextSiblings[*link];
+		}
+		*link = index;
+	}
+	_parents[index] = parent;
+
+	// Our world transform (and our children's) changes with the parent
+	_isOrderDirty = true;
+	_MarkDirty(index);
+	return true;
+}
+
+void TransformStore::Recalc(uint32_t index) {
+	TransformKernels::ComputeModelMatrices(
+		_positions.data(), _rotations.data(), _scales.data(),
+		&index, 1,
+		_localMatrices.data(), _localNormalMatrices.data());
+	if (_isOrderDirty) {
+		_RebuildOrder();
+	}
+	_PropagateRange(_ranks[index], _ranks[index] + _subtreeSizes[index]);
+	_dirty[index] = 0;
+}
+
+void TransformStore::RecalcAll() {
+	const uint32_t count = static_cast<uint32_t>(_positions.size());
+	TransformKernels::ComputeModelMatrices(
+		_positions.data(), _rotations.data(), _scales.data(),
+		nullptr, count,
+		_localMatrices.data(), _localNormalMatrices.data());
+	if (_isOrderDirty) {
+		_RebuildOrder();
+	}
+	_PropagateRange(0, count);
+	std::fill(_dirty.begin(), _dirty.end(), static_cast<uint8_t>(0));
+	_dirtyList.clear();
+	_lastRecalcCount = count;
+}
+
+uint32_t TransformStore::RecalcDirty() {
+	if (_dirtyList.empty()) {
+		_lastRecalcCount = 0;
+		return 0;
+	}
+
+	// The dirty list doubles as the gather list for the batched kernel
+	TransformKernels::ComputeModelMatrices(
+		_positions.data(), _rotations.data(), _scales.data(),
+		_dirtyList.data(), _dirtyList.size(),
+		_localMatrices.data(), _localNormalMatrices.data());
+
+	if (_isOrderDirty) {
+		_RebuildOrder();
+	}
+
+	// Visit dirty transforms in hierarchy order, so that if a transform and one of it's
+	// children are both dirty, the child is already covered by the parent's range
+	std::sort(_dirtyList.begin(), _dirtyList.end(), [&](uint32_t a, uint32_t b) {
+		return _ranks[a] < _ranks[b];
+	});
+	uint32_t recalculated = 0;
+	uint32_t coveredEnd = 0;
+	for (uint32_t index : _dirtyList) {
+		_dirty[index] = 0;
+		const uint32_t begin = _ranks[index];
+		if (begin < coveredEnd) {
+			continue;
+		}
+		coveredEnd = begin + _subtreeSizes[index];
+		_PropagateRange(begin, coveredEnd);
+		recalculated += coveredEnd - begin;
+	}
+	_dirtyList.clear();
+	_lastRecalcCount = recalculated;
+	return _lastRecalcCount;
+}
+
+void TransformStore::_MarkDirty(uint32_t index) {
+	if (_dirty[index] == 0) {
+		_dirty[index] = 1;
+		_dirtyList.push_back(index);
+	}
+}
+
+void TransformStore::_RebuildOrder() {
+	const uint32_t count = static_cast<uint32_t>(_positions.size());
+	_order.clear();
+
+	// Depth first walk from each root, so every subtree ends up contiguous
+	for (uint32_t root = 0; root < count; root++) {
+		if (_parents[root] != NO_PARENT) {
+			continue;
+		}
+		_orderStack.push_back(root);
+		while (!_orderStack.empty()) {
+			const uint32_t index = _orderStack.back();
+			_orderStack.pop_back();
+			_ranks[index] = static_cast<uint32_t>(_order.size());
+			_order.push_back(index);
+			for (uint32_t child = _firstChildren[index]; child != NO_PARENT; child = _nextSiblings[child]) {
+				_orderStack.push_back(child);
+			}
+		}
+	}
+
+	// Children always come after their parents, so walking backwards lets us sum up subtree sizes
+	std::fill(_subtreeSizes.begin(), _subtreeSizes.end(), 1u);
+	for (uint32_t rank = count; rank > 0; rank--) {
+		const uint32_t index = _order[rank - 1];
+		if (_parents[index] != NO_PARENT) {
+			_subtreeSizes[_parents[index]] += _subtreeSizes[index];
+		}
+	}
+
+	_isOrderDirty = false;
+}
+
+void TransformStore::_PropagateRange(uint32_t begin, uint32_t end) {
+	for (uint32_t rank = begin; rank < end; rank++) {
+		const uint32_t index = _order[rank];
+		const uint32_t parent = _parents[index];
+		if (parent == NO_PARENT) {
+			_worldMatrices[index] = _localMatrices[index];
+			_normalMatrices[index] = _localNormalMatrices[index];
+		} else {
+			// The parent comes earlier in the order, so it's world matrix is already up to date.
+			// Inverse transposes compose the same way as the matrices they came from
+			_worldMatrices[index] = _worldMatrices[parent] * _localMatrices[index];
+			_normalMatrices[index] = _normalMatrices[parent] * _localNormalMatrices[index];
+		}
+	}
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Stores the transforms for all the objects in a scene as a structure of arrays, so that
+/// updating transforms only ever walks the data it needs, rather than the rest of the object
+/// Objects refer to their transform by the index returned from Allocate
+///
+/// Setters only mark a transform as dirty, world and normal matrices are only recalculated for
+/// transforms that have actually changed since the last call to RecalcDirty
+///
+/// Transforms can be parented to one another, in which case their position, rotation and scale are
+/// relative to their parent. The store keeps a depth-first ordering of the hierarchy where every parent
+/// comes before it's children and every subtree is a contiguous range, so world matrices can be
+/// propagated in a single linear pass, and a dirty transform only updates the range covering it's subtree
+/// </summary>
+class TransformStore
+{
+public:
+	/// <summary>
+	/// Parent index for transforms that are not attached to another transform
+	/// </summary>
+	static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+	TransformStore();
+	~TransformStore() = default;
+
+	/// <summary>
+	/// Allocates a new root transform at the origin with no rotation and unit scale, reusing a freed transform if there is one
+	/// </summary>
+	/// <returns>The index of the new transform</returns>
+	uint32_t Allocate();
+	/// <summary>
+	/// Returns a transform to the store so it's index can be reused by Allocate. Any children
+	/// of the transform are detached and become roots
+	/// </summary>
+	/// <param name="index">The index of the transform to free</param>
+	void Free(uint32_t index);
+	/// <summary>
+	/// Removes all transforms from the store, invalidating all indices
+	/// </summary>
+	void Clear();
+	/// <summary>
+	/// Reserves space for the given number of transforms, can improve performance
+	/// when adding a large number of objects of a known size
+	/// </summary>
+	/// <param name="count">The total number of transforms to reserve space for</param>
+	void Reserve(size_t count);
+
+	/// <summary>
+	/// Gets the number of transforms in this store
+	/// </summary>
+	size_t GetCount() const { return _positions.size(); }
+
+	// Position, rotation and scale are relative to the transform's parent, if it has one
+	const glm::vec3& GetPosition(uint32_t index) const { return _positions[index]; }
+	const glm::vec3& GetRotation(uint32_t index) const { return _rotations[index]; }
+	const glm::vec3& GetScale(uint32_t index) const { return _scales[index]; }
+	/// <summary>
+	/// Gets the matrix transforming from the given transform's space into it's parent's space, as of the last recalculation
+	/// </summary>
+	const glm::mat4& GetLocalMatrix(uint32_t index) const { return _localMatrices[index]; }
+	/// <summary>
+	/// Gets the world matrix for the given transform, as of the last recalculation
+	/// </summary>
+	const glm::mat4& GetWorldMatrix(uint32_t index) const { return _worldMatrices[index]; }
+	/// <summary>
+	/// Gets the normal matrix (inverse transpose of the world matrix) for the given transform, as of the last recalculation
+	/// </summary>
+	const glm::mat3& GetNormalMatrix(uint32_t index) const { return _normalMatrices[index]; }
+	/// <summary>
+	/// Gets whether the given transform has changed since it's world matrix was last calculated
+	/// </summary>
+	bool IsDirty(uint32_t index) const { return _dirty[index] != 0; }
+
+	void SetPosition(uint32_t index, const glm::vec3& value);
+	/// <summary>
+	/// Sets the rotation of the given transform, in Euler angles (degrees). Angles are wrapped into the 0-360 range
+	/// </summary>
+	void SetRotation(uint32_t index, const glm::vec3& value);
+	void SetScale(uint32_t index, const glm::vec3& value);
+
+	/// <summary>
+	/// Attaches a transform to a parent, or detaches it if parent is NO_PARENT. The transform keeps it's
+	/// local position, rotation and scale, which are now relative to the new parent
+	/// </summary>
+	/// <param name="index">The index of the transform to re-parent</param>
+	/// <param name="parent">The index of the new parent, or NO_PARENT to make the transform a root</param>
+	/// <returns>True if the parent was set, false if it would have created a cycle</returns>
+	bool SetParent(uint32_t index, uint32_t parent);
+	/// <summary>
+	/// Gets the index of the given transform's parent, or NO_PARENT if it is a root
+	/// </summary>
+	uint32_t GetParent(uint32_t index) const { return _parents[index]; }
+	/// <summary>
+	/// Gets the first child of the given transform, or NO_PARENT if it has no children. The rest of the
+	/// children can be visited with GetNextSibling
+	/// </summary>
+	uint32_t GetFirstChild(uint32_t index) const { return _firstChildren[index]; }
+	/// <summary>
+	/// Gets the next child of the given transform's parent, or NO_PARENT if it is the last child
+	/// </summary>
+	uint32_t GetNextSibling(uint32_t index) const { return _nextSiblings[index]; }
+
+	/// <summary>
+	/// Recalculates the matrices for a single transform and all of it's children
+	/// </summary>
+	/// <param name="index">The index of the transform to recalculate</param>
+	void Recalc(uint32_t index);
+	/// <summary>
+	/// Recalculates the world matrix for every transform in the store in a single pass
+	/// </summary>
+	void RecalcAll();
+	/// <summary>
+	/// Recalculates the world matrix only for transforms that have changed since they were last calculated,
+	/// as well as their children
+	/// </summary>
+	/// <returns>The number of world matrices that were recalculated</returns>
+	uint32_t RecalcDirty();
+
+	/// <summary>
+	/// Gets the number of transforms that were recalculated by the last call to RecalcDirty or RecalcAll
+	/// </summary>
+	uint32_t GetLastRecalcCount() const { return _lastRecalcCount; }
+
+	/// <summary>
+	/// Gets the underlying arrays, for systems that want to process transforms in bulk
+	/// </summary>
+	const glm::vec3* GetPositions() const { return _positions.data(); }
+	const glm::vec3* GetRotations() const { return _rotations.data(); }
+	const glm::vec3* GetScales() const { return _scales.data(); }
+	const glm::mat4* GetWorldMatrices() const { return _worldMatrices.data(); }
+	/// <summary>
+	/// Gets the transform indices in hierarchy order, where every parent comes before all of it's children
+	/// </summary>
+	const uint32_t* GetHierarchyOrder() const { return _order.data(); }
+
+protected:
+	std::vector<glm::vec3> _positions;
+	std::vector<glm::vec3> _rotations; // Euler angles, in degrees
+	std::vector<glm::vec3> _scales;
+	std::vector<glm::mat4> _localMatrices;
+	std::vector<glm::mat3> _localNormalMatrices;
+	std::vector<glm::mat4> _worldMatrices;
+	std::vector<glm::mat3> _normalMatrices;
+	std::vector<uint8_t>   _dirty;     // Non-zero if the transform has changed since it's last recalculation
+	std::vector<uint32_t>  _dirtyList; // The indices of all dirty transforms, so we don't need to scan for them
+	std::vector<uint32_t>  _freeList;  // Transforms that have been freed and can be reused
+
+	// Hierarchy links, NO_PARENT marks the end of a list
+	std::vector<uint32_t>  _parents;
+	std::vector<uint32_t>  _firstChildren;
+	std::vector<uint32_t>  _nextSiblings;
+
+	// Depth first ordering of the hierarchy. _ranks maps a transform to it's position in _order, and
+	// the subtree of a transform covers the next _subtreeSizes entries of _order starting at it's rank
+	std::vector<uint32_t>  _order;
+	std::vector<uint32_t>  _ranks;
+	std::vector<uint32_t>  _subtreeSizes;
+	bool                   _isOrderDirty;
+	std::vector<uint32_t>  _orderStack; // Scratch space for rebuilding the order
+
+	uint32_t _lastRecalcCount;
+
+	// Flags a transform as dirty, adding it to the dirty list if it isn't already in it
+	void _MarkDirty(uint32_t index);
+	// Rebuilds the depth first ordering of the hierarchy after parents have changed
+	void _RebuildOrder();
+	// Recalculates the world matrices for the given range of the hierarchy order
+	void _PropagateRange(uint32_t begin, uint32_t end);
+};
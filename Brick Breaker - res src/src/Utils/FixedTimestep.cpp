@@ -0,0 +1,30 @@
+#include "Utils/FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(double stepSeconds, uint32_t maxStepsPerFrame) :
+	_step(stepSeconds),
+	_accumulator(0.0),
+	_maxStepsPerFrame(maxStepsPerFrame),
+	_stepCount(0),
+	_droppedSteps(0) { }
+
+uint32_t FixedTimestep::Advance(double frameSeconds) {
+	// Guard against the clock going backwards
+	if (frameSeconds > 0.0) {
+		_accumulator += frameSeconds;
+	}
+
+	uint32_t steps = 0;
+	while (_accumulator >= _step && steps < _maxStepsPerFrame) {
+		_accumulator -= _step;
+		steps++;
+	}
+	// If we're still behind after the max number of steps, drop the rest rather than trying to catch up next frame
+	if (_accumulator >= _step) {
+		uint64_t dropped = static_cast<uint64_t>(_accumulator / _step);
+		_droppedSteps += dropped;
+		_accumulator -= dropped * _step;
+	}
+
+	_stepCount += steps;
+	return steps;
+}
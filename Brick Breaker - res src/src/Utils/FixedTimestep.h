@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// Runs a simulation at a fixed rate, no matter how fast frames are being rendered
+///
+/// Each frame, the time since the last frame is added to an accumulator, and Advance returns how many whole
+/// steps fit into it. The time left over is used to blend between the previous and current simulation states
+/// when rendering (see GetAlpha), so motion stays smooth when the render rate doesn't match the step rate.
+/// If a frame takes too long (ex: dragging the window), the number of steps is capped and the extra time is
+/// dropped, so the simulation can't fall further and further behind trying to catch up
+/// </summary>
+class FixedTimestep
+{
+public:
+	/// <summary>
+	/// Creates a new fixed timestep
+	/// </summary>
+	/// <param name="stepSeconds">The length of a single simulation step, in seconds</param>
+	/// <param name="maxStepsPerFrame">The most steps that will be run in a single frame</param>
+	FixedTimestep(double stepSeconds = 1.0 / 60.0, uint32_t maxStepsPerFrame = 8);
+	~FixedTimestep() = default;
+
+	/// <summary>
+	/// Adds the time for a frame to the accumulator
+	/// </summary>
+	/// <param name="frameSeconds">The time since the last frame, in seconds</param>
+	/// <returns>The number of simulation steps to run this frame</returns>
+	uint32_t Advance(double frameSeconds);
+
+	/// <summary>
+	/// Gets how far we are between the previous step and the next one, from 0 to 1. Rendering should use
+	/// mix(previous, current, alpha) for anything the simulation moves
+	/// </summary>
+	float GetAlpha() const { return static_cast<float>(_accumulator / _step); }
+	/// <summary>
+	/// Gets the length of a single step, in seconds
+	/// </summary>
+	double GetStep() const { return _step; }
+	/// <summary>
+	/// Gets the total number of steps that have been run
+	/// </summary>
+	uint64_t GetStepCount() const { return _stepCount; }
+	/// <summary>
+	/// Gets the total number of steps that were skipped because a frame took too long
+	/// </summary>
+	uint64_t GetDroppedSteps() const { return _droppedSteps; }
+
+	/// <summary>
+	/// Clears the accumulator, ex: after loading a new scene
+	/// </summary>
+	void Reset() { _accumulator = 0.0; }
+
+protected:
+	double   _step;
+	double   _accumulator;
+	uint32_t _maxStepsPerFrame;
+	uint64_t _stepCount;
+	uint64_t _droppedSteps;
+};
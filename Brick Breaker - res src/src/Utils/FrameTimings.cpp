@@ -0,0 +1,52 @@
+#include "Utils/FrameTimings.h"
+
+#include <algorithm>
+#include <sstream>
+#include <Logging.h>
+
+#include "Utils/FileHelpers.h"
+
+FrameTimings::Summary FrameTimings::GetSummary() const {
+	Summary result = { 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	if (_frameMs.empty()) {
+		return result;
+	}
+
+	std::vector<float> sorted = _frameMs;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](float fraction) {
+		return sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()))];
+	};
+
+	double total = 0.0;
+	for (float ms : sorted) {
+		total += ms;
+	}
+	result.Frames = sorted.size();
+	result.AverageMs = static_cast<float>(total / sorted.size());
+	result.MedianMs = percentile(0.5f);
+	result.P95Ms = percentile(0.95f);
+	result.P99Ms = percentile(0.99f);
+	result.MaxMs = sorted.back();
+	return result;
+}
+
+void FrameTimings::LogSummary(const std::string& name) const {
+	const Summary summary = GetSummary();
+	LOG_INFO("==== Frame Timings: {} ====", name);
+	LOG_INFO("\tFrames:  {}", summary.Frames);
+	LOG_INFO("\tAverage: {:.3f} ms", summary.AverageMs);
+	LOG_INFO("\tMedian:  {:.3f} ms", summary.MedianMs);
+	LOG_INFO("\t95%:     {:.3f} ms", summary.P95Ms);
+	LOG_INFO("\t99%:     {:.3f} ms", summary.P99Ms);
+	LOG_INFO("\tMax:     {:.3f} ms", summary.MaxMs);
+}
+
+void FrameTimings::SaveCsv(const std::string& path) const {
+	std::stringstream stream;
+	stream << "frame,ms\n";
+	for (size_t ix = 0; ix < _frameMs.size(); ix++) {
+		stream << ix << "," << _frameMs[ix] << "\n";
+	}
+	FileHelpers::WriteContentsToFile(path, stream.str());
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Collects how long each frame took, for benchmarking a replayed session. Averages hide hitches, so the summary
+/// also includes percentiles and the slowest frame
+/// </summary>
+class FrameTimings
+{
+public:
+	struct Summary {
+		size_t Frames;
+		float  AverageMs;
+		float  MedianMs;
+		float  P95Ms;
+		float  P99Ms;
+		float  MaxMs;
+	};
+
+	FrameTimings() : _frameMs(std::vector<float>()) { }
+	~FrameTimings() = default;
+
+	/// <summary>
+	/// Adds the time for a frame
+	/// </summary>
+	/// <param name="frameSeconds">The length of the frame in seconds</param>
+	void Add(double frameSeconds) { _frameMs.push_back(static_cast<float>(frameSeconds * 1000.0)); }
+	void Clear() { _frameMs.clear(); }
+	size_t GetFrameCount() const { return _frameMs.size(); }
+
+	/// <summary>
+	/// Works out the average, percentiles and worst case of the frames so far
+	/// </summary>
+	Summary GetSummary() const;
+	/// <summary>
+	/// Logs the summary, along with a name for what was being timed
+	/// </summary>
+	void LogSummary(const std::string& name) const;
+	/// <summary>
+	/// Saves the time of every frame to a CSV file, for graphing
+	/// </summary>
+	void SaveCsv(const std::string& path) const;
+
+protected:
+	std::vector<float> _frameMs;
+};
@@ -0,0 +1,151 @@
+#include "Utils/JsonStreamReader.h"
+#include <fstream>
+#include <vector>
+#include <Logging.h>
+
+/// <summary>
+/// SAX handler that only ever builds a DOM for the entry it is currently reading
+/// Depth 0 is the root object, depth 1 is either a value directly under the root, or a
+/// root level array who's elements are emitted one by one
+/// </summary>
+class EntrySaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+	EntrySaxHandler(const JsonStreamReader::EntryCallback& callback, const JsonStreamReader::ArrayCallback& onArray) :
+		_callback(callback),
+		_onArray(onArray),
+		_depth(0),
+		_rootKey(""),
+		_memberKey(""),
+		_entry(nullptr),
+		_stack(std::vector<nlohmann::json*>()) { }
+
+	bool null() override { return _Value(nlohmann::json(nullptr)); }
+	bool boolean(bool val) override { return _Value(nlohmann::json(val)); }
+	bool number_integer(number_integer_t val) override { return _Value(nlohmann::json(val)); }
+	bool number_unsigned(number_unsigned_t val) override { return _Value(nlohmann::json(val)); }
+	bool number_float(number_float_t val, const string_t&) override { return _Value(nlohmann::json(val)); }
+	bool string(string_t& val) override { return _Value(nlohmann::json(std::move(val))); }
+	bool binary(binary_t& val) override { return _Value(nlohmann::json::binary(std::move(val))); }
+
+	bool start_object(std::size_t elements) override {
+		// The root object is structural only, we never store it
+		if (_depth == 0) {
+			_depth++;
+			return true;
+		}
+		_depth++;
+		return _Push(nlohmann::json::object());
+	}
+
+	bool key(string_t& val) override {
+		// Keys directly under the root tell us what kind of entries are coming
+		if (_depth == 1 && _stack.empty()) {
+			_rootKey = val;
+		} else {
+			_memberKey = val;
+		}
+		return true;
+	}
+
+	bool end_object() override {
+		_depth--;
+		return _Pop();
+	}
+
+	bool start_array(std::size_t elements) override {
+		// A root level array is structural, it's elements will be emitted individually
+		if (_depth == 1 && _stack.empty()) {
+			_depth++;
+			if (_onArray) {
+				_onArray(_rootKey);
+			}
+			return true;
+		}
+		_depth++;
+		return _Push(nlohmann::json::array());
+	}
+
+	bool end_array() override {
+		_depth--;
+		return _Pop();
+	}
+
+	bool parse_error(std::size_t position, const std::string& lastToken, const nlohmann::detail::exception& ex) override {
+		LOG_ERROR("JSON parse error at byte {}: {}", position, ex.what());
+		return false;
+	}
+
+protected:
+	const JsonStreamReader::EntryCallback& _callback;
+	const JsonStreamReader::ArrayCallback& _onArray;
+	int         _depth;     // The number of containers we are currently nested in
+	std::string _rootKey;   // The last key read directly under the root object
+	std::string _memberKey; // The last key read inside of the entry being built
+	nlohmann::json _entry;  // The entry currently being built
+
+	// The containers we are currently building, innermost at the back. Note that the pointers stay
+	// valid, since a parent container can't grow until the child on top of it has been closed
+	std::vector<nlohmann::json*> _stack;
+
+	// Stores a completed value into the innermost container, or emits it if it's a whole entry
+	bool _Value(nlohmann::json&& value) {
+		if (_stack.empty()) {
+			_callback(_rootKey, value);
+		} else {
+			_Insert(std::move(value));
+		}
+		return true;
+	}
+
+	// Adds a value to the innermost container and returns where it ended up
+	nlohmann::json* _Insert(nlohmann::json&& value) {
+		nlohmann::json* parent = _stack.back();
+		if (parent->is_object()) {
+			nlohmann::json& slot = (*parent)[_memberKey];
+			slot = std::move(value);
+			return &slot;
+		} else {
+			parent->push_back(std::move(value));
+			return &parent->back();
+		}
+	}
+
+	// Starts building a new container, either as the root of a new entry or inside the current one
+	bool _Push(nlohmann::json&& container) {
+		if (_stack.empty()) {
+			_entry = std::move(container);
+			_stack.push_back(&_entry);
+		} else {
+			_stack.push_back(_Insert(std::move(container)));
+		}
+		return true;
+	}
+
+	// Finishes the innermost container, emitting the entry once it's outermost container closes
+	bool _Pop() {
+		if (!_stack.empty()) {
+			_stack.pop_back();
+			if (_stack.empty()) {
+				_callback(_rootKey, _entry);
+				// Release the entry's memory before we start on the next one
+				_entry = nullptr;
+			}
+		}
+		return true;
+	}
+};
+
+bool JsonStreamReader::Parse(std::istream& stream, const EntryCallback& callback, const ArrayCallback& onArray) {
+	EntrySaxHandler handler(callback, onArray);
+	return nlohmann::json::sax_parse(stream, &handler);
+}
+
+bool JsonStreamReader::ParseFile(const std::string& path, const EntryCallback& callback, const ArrayCallback& onArray) {
+	// We read straight from the file, so we never have to hold the entire contents in a string
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		LOG_ERROR("Could not open file '{0}'", path);
+		return false;
+	}
+	return Parse(file, callback, onArray);
+}
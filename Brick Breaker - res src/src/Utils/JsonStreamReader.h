@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <functional>
+#include <istream>
+#include <json.hpp>
+
+/// <summary>
+/// Streams a JSON document through nlohmann's SAX interface instead of parsing it into a full DOM.
+/// The document's root must be an object. Each value under the root is handed to a callback as soon
+/// as its closing token arrives, and if the value is an array, each element is handed over on it's own.
+/// Only the entry currently being read is ever held in memory, so peak memory stays around the size
+/// of the largest single entry (ex: one object or material in a scene) rather than the whole file
+/// </summary>
+class JsonStreamReader {
+public:
+	/// <summary>
+	/// Callback invoked for every entry read from the stream
+	/// </summary>
+	/// <param name="key">The key in the root object that the entry belongs to (ex: "objects")</param>
+	/// <param name="entry">The entry, or a single element if the root value was an array</param>
+	typedef std::function<void(const std::string& key, const nlohmann::json& entry)> EntryCallback;
+	/// <summary>
+	/// Callback invoked when an array directly under the root starts, before any of it's elements.
+	/// Empty arrays never produce entries, so this is the only way to tell that they were there
+	/// </summary>
+	/// <param name="key">The key in the root object that the array belongs to (ex: "objects")</param>
+	typedef std::function<void(const std::string& key)> ArrayCallback;
+
+	JsonStreamReader() = delete;
+
+	/// <summary>
+	/// Streams the JSON document from the given input stream, invoking the callback for each entry
+	/// </summary>
+	/// <param name="stream">The stream to read the document from</param>
+	/// <param name="callback">The function to invoke for each entry in the document</param>
+	/// <param name="onArray">An optional function to invoke when each array under the root starts</param>
+	/// <returns>True if the document was parsed successfully, false if there was a syntax error</returns>
+	static bool Parse(std::istream& stream, const EntryCallback& callback, const ArrayCallback& onArray = nullptr);
+	/// <summary>
+	/// Streams the JSON document from the file at the given path, invoking the callback for each entry
+	/// </summary>
+	/// <param name="path">The path of the file to read from</param>
+	/// <param name="callback">The function to invoke for each entry in the document</param>
+	/// <param name="onArray">An optional function to invoke when each array under the root starts</param>
+	/// <returns>True if the document was parsed successfully, false if the file could not be read</returns>
+	static bool ParseFile(const std::string& path, const EntryCallback& callback, const ArrayCallback& onArray = nullptr);
+};
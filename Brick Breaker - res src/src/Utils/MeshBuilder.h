@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/GeometryPool.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -119,8 +120,20 @@ public:
 	/// <summary>
 	/// Creates and returns a VertexArraybject from the current data
 	/// </summary>
+	/// <param name="pool">If set, the mesh will be stored in this pool rather than getting it's own buffers (if it is small enough)</param>
 	/// <returns>A VertexArrayObject</returns>
-	VertexArrayObject::Sptr Bake() {
+	VertexArrayObject::Sptr Bake(const GeometryPool::Sptr& pool = nullptr) {
+		if (pool != nullptr && _vertices.size() > 0 && _vertices.size() * sizeof(VertType) <= GeometryPool::MAX_POOLED_MESH_SIZE) {
+			GeometryAllocation* allocation = pool->Allocate(GetVertexDataPtr(), static_cast<uint32_t>(_vertices.size()), VertType::V_DECL,
+															GetIndexDataPtr(), static_cast<uint32_t>(_indices.size()));
+			if (allocation != nullptr) {
+				VertexArrayObject::Sptr result = VertexArrayObject::Create();
+				result->SetPooledGeometry(pool, allocation);
+				result->SetBounds(MeshBounds::FromPositions(&_vertices[0].Position, _vertices.size(), sizeof(VertType)));
+				return result;
+			}
+		}
+
 		VertexBuffer::Sptr vbo = VertexBuffer::Create();
 		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
 
@@ -133,6 +146,9 @@ public:
 		VertexArrayObject::Sptr result = VertexArrayObject::Create();
 		result->AddVertexBuffer(vbo, VertType::V_DECL);
 		result->SetIndexBuffer(ebo);
+		if (_vertices.size() > 0) {
+			result->SetBounds(MeshBounds::FromPositions(&_vertices[0].Position, _vertices.size(), sizeof(VertType)));
+		}
 
 		return result;
 	}
@@ -0,0 +1,246 @@
+#include "Utils/MeshSimplifier.h"
+#include "Graphics/MeshBounds.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+
+namespace {
+	// The sum of the squared distances to a set of planes, stored as the upper half of the symmetric 3x3 part,
+	// the linear part and the constant of the 4x4 quadric, along with the total weight of the planes
+	struct Quadric {
+		double A00, A01, A02, A11, A12, A22;
+		double B0, B1, B2;
+		double C;
+		double Weight;
+
+		Quadric() : A00(0.0), A01(0.0), A02(0.0), A11(0.0), A12(0.0), A22(0.0), B0(0.0), B1(0.0), B2(0.0), C(0.0), Weight(0.0) { }
+
+		void AddPlane(const glm::dvec3& normal, double distance, double weight) {
+			A00 += weight * normal.x * normal.x;
+			A01 += weight * normal.x * normal.y;
+			A02 += weight * normal.x * normal.z;
+			A11 += weight * normal.y * normal.y;
+			A12 += weight * normal.y * normal.z;
+			A22 += weight * normal.z * normal.z;
+			B0 += weight * normal.x * distance;
+			B1 += weight * normal.y * distance;
+			B2 += weight * normal.z * distance;
+			C += weight * distance * distance;
+			Weight += weight;
+		}
+
+		void Add(const Quadric& other) {
+			A00 += other.A00; A01 += other.A01; A02 += other.A02;
+			A11 += other.A11; A12 += other.A12; A22 += other.A22;
+			B0 += other.B0; B1 += other.B1; B2 += other.B2;
+			C += other.C;
+			Weight += other.Weight;
+		}
+
+		double Evaluate(const glm::vec3& point) const {
+			const double x = point.x, y = point.y, z = point.z;
+			return A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+				2.0 * (B0 * x + B1 * y + B2 * z) + C;
+		}
+	};
+
+	// Moving the From vertex onto the To vertex
+	struct Collapse {
+		uint32_t From;
+		uint32_t To;
+		float    Cost;
+	};
+
+	struct PositionHash {
+		size_t operator()(const glm::vec3& position) const {
+			uint32_t bits[3];
+			memcpy(bits, &position, sizeof(bits));
+			return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		}
+	};
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const glm::vec3* firstPosition, size_t stride, uint32_t vertexCount,
+											   const uint32_t* indices, uint32_t indexCount, uint32_t targetIndexCount, float* outError) {
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(firstPosition);
+	auto position = [&](uint32_t vertex) -> const glm::vec3& {
+		return *reinterpret_cast<const glm::vec3*>(data + vertex * stride);
+	};
+
+	std::vector<uint32_t> result(indices, indices + indexCount);
+	if (outError != nullptr) {
+		*outError = 0.0f;
+	}
+	if (indexCount <= targetIndexCount || vertexCount == 0) {
+		return result;
+	}
+
+	// Vertices that share a position are the same point on the surface, each group is represented by it's first vertex
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<uint32_t> groupSize(vertexCount, 0);
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> positionIds;
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		// Adding 0 turns -0 into +0, so they hash the same
+		const glm::vec3 key = position(ix) + glm::vec3(0.0f);
+		remap[ix] = positionIds.emplace(key, ix).first->second;
+		groupSize[remap[ix]]++;
+	}
+
+	// Split vertices are on a seam, and edges that only belong to one triangle are on a border, neither can move
+	std::vector<uint8_t> locked(vertexCount, 0);
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		locked[ix] = groupSize[remap[ix]] > 1;
+	}
+	std::unordered_map<uint64_t, uint32_t> edgeUses;
+	for (uint32_t ix = 0; ix < indexCount; ix += 3) {
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t a = remap[indices[ix + corner]], b = remap[indices[ix + (corner + 1) % 3]];
+			if (a != b) {
+				edgeUses[((uint64_t)std::min(a, b) << 32) | std::max(a, b)]++;
+			}
+		}
+	}
+	for (const auto& edge : edgeUses) {
+		if (edge.second == 1) {
+			locked[edge.first >> 32] = 1;
+			locked[edge.first & 0xFFFFFFFF] = 1;
+		}
+	}
+	// Borders were found using the group representatives, so copy them to the rest of each group
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		locked[ix] = locked[remap[ix]];
+	}
+
+	// Each position starts with the planes of the triangles around it, weighted by area so small triangles matter less
+	std::vector<Quadric> quadrics(vertexCount);
+	for (uint32_t ix = 0; ix < indexCount; ix += 3) {
+		const glm::dvec3 p0 = glm::dvec3(position(indices[ix]));
+		const glm::dvec3 p1 = glm::dvec3(position(indices[ix + 1]));
+		const glm::dvec3 p2 = glm::dvec3(position(indices[ix + 2]));
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		const double length = glm::length(normal);
+		if (length == 0.0) {
+			continue;
+		}
+		normal /= length;
+		const double distance = -glm::dot(normal, p0);
+		for (int corner = 0; corner < 3; corner++) {
+			quadrics[remap[indices[ix + corner]]].AddPlane(normal, distance, length * 0.5);
+		}
+	}
+	auto cost = [&](uint32_t from, uint32_t to) {
+		const Quadric& a = quadrics[remap[from]];
+		const Quadric& b = quadrics[remap[to]];
+		const double weight = a.Weight + b.Weight;
+		return weight > 0.0 ? (float)std::max(0.0, (a.Evaluate(position(to)) + b.Evaluate(position(to))) / weight) : 0.0f;
+	};
+
+	uint32_t triangleCount = indexCount / 3;
+	const uint32_t targetTriangles = targetIndexCount / 3;
+	float maxError = 0.0f;
+
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+	std::vector<uint32_t> vertexTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t> touched(vertexCount);
+
+	// Each pass collapses the cheapest edges that don't overlap each other, then rebuilds the adjacency for the next pass
+	while (triangleCount > targetTriangles) {
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for (uint32_t index : result) {
+			triangleOffsets[index + 1]++;
+		}
+		for (uint32_t ix = 0; ix < vertexCount; ix++) {
+			triangleOffsets[ix + 1] += triangleOffsets[ix];
+		}
+		vertexTriangles.resize(result.size());
+		std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (uint32_t ix = 0; ix < result.size(); ix++) {
+			vertexTriangles[cursor[result[ix]]++] = ix / 3;
+		}
+
+		collapses.clear();
+		for (uint32_t ix = 0; ix < result.size(); ix += 3) {
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t a = result[ix + corner], b = result[ix + (corner + 1) % 3];
+				if (!locked[a]) collapses.push_back({ a, b, cost(a, b) });
+				if (!locked[b]) collapses.push_back({ b, a, cost(b, a) });
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+		// Only take the cheapest third each pass, so expensive collapses wait until the cheap ones around them are done
+		const float passLimit = collapses[collapses.size() / 3].Cost;
+
+		std::fill(touched.begin(), touched.end(), 0);
+		uint32_t performed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (triangleCount <= targetTriangles || collapse.Cost > passLimit) {
+				break;
+			}
+			if (touched[collapse.From] || touched[collapse.To]) {
+				continue;
+			}
+
+			// Don't allow collapses that would flip a triangle over
+			bool flips = false;
+			for (uint32_t ix = triangleOffsets[collapse.From]; ix < triangleOffsets[collapse.From + 1] && !flips; ix++) {
+				const uint32_t* tri = &result[vertexTriangles[ix] * 3];
+				if (tri[0] == collapse.To || tri[1] == collapse.To || tri[2] == collapse.To) {
+					continue;
+				}
+				glm::vec3 corners[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+				const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+				for (int corner = 0; corner < 3; corner++) {
+					if (tri[corner] == collapse.From) corners[corner] = position(collapse.To);
+				}
+				const glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+				flips = glm::dot(before, after) <= 0.0f;
+			}
+			if (flips) {
+				continue;
+			}
+
+			// Lock the neighbourhood for the rest of the pass, since the adjacency we have is now out of date for it
+			for (uint32_t ix = triangleOffsets[collapse.From]; ix < triangleOffsets[collapse.From + 1]; ix++) {
+				uint32_t* tri = &result[vertexTriangles[ix] * 3];
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+				const bool isRemoved = tri[0] == collapse.To || tri[1] == collapse.To || tri[2] == collapse.To;
+				for (int corner = 0; corner < 3; corner++) {
+					if (tri[corner] == collapse.From) tri[corner] = collapse.To;
+				}
+				if (isRemoved) {
+					triangleCount--;
+				}
+			}
+			quadrics[remap[collapse.To]].Add(quadrics[remap[collapse.From]]);
+			maxError = std::max(maxError, collapse.Cost);
+			performed++;
+		}
+
+		// Drop the triangles that were collapsed away
+		size_t write = 0;
+		for (size_t ix = 0; ix < result.size(); ix += 3) {
+			if (result[ix] != result[ix + 1] && result[ix + 1] != result[ix + 2] && result[ix] != result[ix + 2]) {
+				result[write++] = result[ix];
+				result[write++] = result[ix + 1];
+				result[write++] = result[ix + 2];
+			}
+		}
+		result.resize(write);
+		triangleCount = static_cast<uint32_t>(result.size() / 3);
+
+		if (performed == 0) {
+			break;
+		}
+	}
+
+	if (outError != nullptr) {
+		const MeshBounds bounds = MeshBounds::FromPositions(firstPosition, vertexCount, stride);
+		*outError = bounds.Radius > 0.0f ? glm::sqrt(maxError) / bounds.Radius : 0.0f;
+	}
+	return result;
+}
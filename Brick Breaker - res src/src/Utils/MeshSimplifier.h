@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Reduces the number of triangles in a mesh by collapsing edges, picking the collapses that move the surface the
+/// least using quadric error metrics (Garland and Heckbert). The simplified mesh only needs a new index buffer,
+/// since every collapse moves a vertex onto one of it's neighbours instead of making new vertices
+///
+/// Vertices on a seam (the same position split into several vertices with different normals or UVs) and on an
+/// open border are never moved, so the simplified mesh doesn't tear apart along UV seams or hard edges
+/// </summary>
+class MeshSimplifier {
+public:
+	MeshSimplifier() = delete;
+
+	/// <summary>
+	/// The number of simplified levels to build for a mesh, in addition to the original
+	/// </summary>
+	static const uint32_t DEFAULT_LOD_LEVELS = 3;
+	/// <summary>
+	/// Meshes with fewer triangles than this are already cheap enough, and won't get any LODs
+	/// </summary>
+	static const uint32_t MIN_LOD_TRIANGLES = 64;
+
+	/// <summary>
+	/// Simplifies a triangle list
+	/// </summary>
+	/// <param name="firstPosition">A pointer to the position of the first vertex</param>
+	/// <param name="stride">The size of a vertex in bytes (ex: sizeof(VertexPosNormTexCol))</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices</param>
+	/// <param name="targetIndexCount">The number of indices to try to reduce the mesh to, the result may have more if the mesh can't be simplified further</param>
+	/// <param name="outError">If not null, receives how far the surface moved, relative to the size of the mesh</param>
+	/// <returns>The indices of the simplified mesh, using the same vertices as the original</returns>
+	static std::vector<uint32_t> Simplify(const glm::vec3* firstPosition, size_t stride, uint32_t vertexCount,
+										  const uint32_t* indices, uint32_t indexCount, uint32_t targetIndexCount, float* outError = nullptr);
+};
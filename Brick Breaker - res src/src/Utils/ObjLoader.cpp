@@ -4,6 +4,9 @@
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
+
+#include "Utils/MeshSimplifier.h"
 
 // Borrowed from https://stackoverflow.com/questions/216823/whats-the-best-way-to-trim-stdstring
 #pragma region String Trimming
@@ -46,7 +49,7 @@ static inline std::vector<std::string> SplitString(const std::string& text, cons
 
 #pragma endregion 
 
-VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename)
+VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, uint32_t lodLevels)
 {
 	// Open our file in binary mode
 	std::ifstream file;
@@ -120,21 +123,32 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename)
 				// OBJ format uses 1-based indices
 				vertexIndices -= glm::ivec3(1);
 
-				// add the vertex indices to the list
-				// NOTE: This will create duplicate vertices!
-				// A smarter solution would create a map of what attribute
-				// combos have already been added
+				// add the vertex indices to the list, duplicates are merged when we build the mesh
 				vertices.push_back(vertexIndices);
 			}
 		}
 	}
 
-	// TODO: Generate mesh from the data we loaded
+	// Generate mesh from the data we loaded
 	std::vector<VertexPosNormTexCol> vertexData;
+	std::vector<uint32_t> indexData;
+	indexData.reserve(vertices.size());
 
+	// Corners that use the same attribute combo share a vertex, so we keep track of the ones we've already added
+	std::unordered_map<uint64_t, uint32_t> addedVertices;
 	for (int ix = 0; ix < vertices.size(); ix++) {
 		glm::ivec3 attribs = vertices[ix];
 
+		// 21 bits per attribute index is plenty for the meshes we load (2 million of each)
+		const uint64_t key = ((uint64_t)(attribs.x & 0x1FFFFF) << 42) | ((uint64_t)(attribs.y & 0x1FFFFF) << 21) | (uint64_t)(attribs.z & 0x1FFFFF);
+		auto it = addedVertices.find(key);
+		if (it != addedVertices.end()) {
+			indexData.push_back(it->second);
+			continue;
+		}
+		addedVertices[key] = static_cast<uint32_t>(vertexData.size());
+		indexData.push_back(static_cast<uint32_t>(vertexData.size()));
+
 		// Extract attributes from lists (except color)
 		glm::vec3 position = positions[attribs.x];
 		glm::vec2 uv       = uvs[attribs.y];
@@ -149,9 +163,41 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename)
 	VertexBuffer::Sptr vertexBuffer = VertexBuffer::Create();
 	vertexBuffer->LoadData(vertexData.data(), vertexData.size());
 
+	IndexBuffer::Sptr indexBuffer = IndexBuffer::Create();
+	indexBuffer->LoadData(indexData.data(), indexData.size());
+
 	// Create the VAO, and add the vertices
 	VertexArrayObject::Sptr result = VertexArrayObject::Create();
 	result->AddVertexBuffer(vertexBuffer, VertexPosNormTexCol::V_DECL);
+	result->SetIndexBuffer(indexBuffer);
+	result->SetBounds(MeshBounds::FromPositions(positions.data(), positions.size()));
+
+	// Large meshes are split into meshlets, so the parts that can't be seen can be culled
+	if (indexData.size() / 3 >= ClusterMesh::MIN_CLUSTERED_TRIANGLES) {
+		result->SetClusters(ClusterMesh::Build(&vertexData[0].Position, sizeof(VertexPosNormTexCol), static_cast<uint32_t>(vertexData.size()),
+											   indexData.data(), static_cast<uint32_t>(indexData.size())));
+	}
+
+	// Each LOD halves the triangles of the one before it, and only needs a new index buffer since it uses the same vertices
+	std::vector<uint32_t> lodIndices = indexData;
+	for (uint32_t level = 0; level < lodLevels && lodIndices.size() / 3 >= MeshSimplifier::MIN_LOD_TRIANGLES; level++) {
+		float error = 0.0f;
+		std::vector<uint32_t> simplified = MeshSimplifier::Simplify(&vertexData[0].Position, sizeof(VertexPosNormTexCol), static_cast<uint32_t>(vertexData.size()),
+																	lodIndices.data(), static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(lodIndices.size() / 2), &error);
+		// If the simplifier couldn't get much further, the rest of the levels would be the same
+		if (simplified.size() > lodIndices.size() * 3 / 4) {
+			break;
+		}
+		lodIndices = simplified;
+
+		IndexBuffer::Sptr lodIndexBuffer = IndexBuffer::Create();
+		lodIndexBuffer->LoadData(lodIndices.data(), lodIndices.size());
+		VertexArrayObject::Sptr lod = VertexArrayObject::Create();
+		lod->AddVertexBuffer(vertexBuffer, VertexPosNormTexCol::V_DECL);
+		lod->SetIndexBuffer(lodIndexBuffer);
+		lod->SetBounds(result->GetBounds());
+		result->AddLod(lod, error);
+	}
 
 	return result;
 	//return VertexArrayObject::Create();
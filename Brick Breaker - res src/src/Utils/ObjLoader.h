@@ -6,7 +6,12 @@
 class ObjLoader
 {
 public:
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
+	/// <summary>
+	/// Loads a mesh from an OBJ file
+	/// </summary>
+	/// <param name="filename">The path of the file to load</param>
+	/// <param name="lodLevels">The number of simplified versions to generate for the mesh, each with about half the triangles of the last</param>
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, uint32_t lodLevels = 0);
 
 protected:
 	ObjLoader() = default;
@@ -1,11 +1,15 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 
 #include "Utils/ObjLoader.h"
+#include "Utils/MeshSimplifier.h"
 #include "../FileHelpers.h"
+#include "../JsonStreamReader.h"
 
 std::map<Guid, Texture2D::Sptr> ResourceManager::_textures;
 std::map<Guid, VertexArrayObject::Sptr> ResourceManager::_meshes;
 std::map<Guid, Shader::Sptr> ResourceManager::_shaders;
+std::map<Guid, Level::Sptr> ResourceManager::_levels;
+GeometryPool::Sptr ResourceManager::_geometryPool = nullptr;
 nlohmann::json ResourceManager::_manifest;
 
 void ResourceManager::Init() {
@@ -13,6 +17,9 @@ void ResourceManager::Init() {
 	_manifest["textures"] = std::vector<nlohmann::json>();
 	_manifest["meshes"]   = std::vector<nlohmann::json>();
 	_manifest["shaders"]  = std::vector<nlohmann::json>();
+	_manifest["levels"]   = std::vector<nlohmann::json>();
+
+	_geometryPool = GeometryPool::Create();
 }
 
 Guid ResourceManager::LoadTexture2D(const nlohmann::json& jsonData) {
@@ -53,11 +60,24 @@ Guid ResourceManager::LoadMesh(const nlohmann::json& jsonData) {
 	LOG_ASSERT(jsonData["path"].is_string(), "JSON data must specify at least the file path for a mesh!");
 	std::string file = jsonData["path"].get<std::string>();
 
+	// Meshes get a few levels of detail unless the manifest says otherwise
+	uint32_t lodLevels = MeshSimplifier::DEFAULT_LOD_LEVELS;
+	if (jsonData.contains("lod_levels") && jsonData["lod_levels"].is_number_unsigned()) {
+		lodLevels = jsonData["lod_levels"].get<uint32_t>();
+	}
+
 	// Load the texture and store the result in our resources
-	VertexArrayObject::Sptr mesh = ObjLoader::LoadFromFile(file);
+	VertexArrayObject::Sptr mesh = ObjLoader::LoadFromFile(file, lodLevels);
 	mesh->OverrideGUID(result);
 	_meshes[result] = mesh;
 
+	// Loaded meshes keep their own buffers for the cluster culler, but a copy in the shared pool lets them be
+	// drawn indirectly along with everything else. The LODs use the same vertices, so they only add their indices
+	mesh->SetPoolCopy(_geometryPool, _geometryPool->Copy(*mesh));
+	for (const VertexArrayObject::LodLevel& lod : mesh->GetLods()) {
+		lod.Mesh->SetPoolCopy(_geometryPool, _geometryPool->Copy(*lod.Mesh, mesh.get()));
+	}
+
 	return result;
 }
 
@@ -86,6 +106,22 @@ Guid ResourceManager::LoadShader(const nlohmann::json& jsonData) {
 	return result;
 }
 
+Guid ResourceManager::LoadLevel(const nlohmann::json& jsonData) {
+	// Get the guid of the level from the manifest
+	LOG_ASSERT(jsonData["guid"].is_string(), "JSON data must specify a GUID!");
+	Guid result = Guid(jsonData["guid"].get<std::string>());
+	LOG_ASSERT(result.isValid(), "Loaded GUID is not a valid GUID!");
+
+	// We need the file path to load the level
+	LOG_ASSERT(jsonData["path"].is_string(), "JSON data must specify the file path for a level!");
+	std::string file = jsonData["path"].get<std::string>();
+
+	// Levels are just data, so a broken level is stored as nullptr rather than stopping the game
+	_levels[result] = Level::LoadFromFile(file);
+
+	return result;
+}
+
 Guid ResourceManager::CreateTexture(const std::string& path, const Texture2DDescription& desc /*= Texture2DDescription()*/) {
 	Guid result = Guid::New();
 	nlohmann::json blob;
@@ -122,6 +158,17 @@ Guid ResourceManager::CreateShader(const std::unordered_map<ShaderPartType, std:
 	return result;
 }
 
+Guid ResourceManager::CreateLevel(const std::string& path) {
+	Guid result = Guid::New();
+	nlohmann::json blob;
+	blob["guid"] = result.str();
+	blob["path"] = path;
+
+	_manifest["levels"].push_back(blob);
+	LoadLevel(blob);
+	return result;
+}
+
 Texture2D::Sptr ResourceManager::GetTexture(Guid id) {
 	return _textures[id];
 }
@@ -134,29 +181,48 @@ Shader::Sptr ResourceManager::GetShader(Guid id) {
 	return _shaders[id];
 }
 
+Level::Sptr ResourceManager::GetLevel(Guid id) {
+	return _levels[id];
+}
+
+const GeometryPool::Sptr& ResourceManager::GetGeometryPool() {
+	return _geometryPool;
+}
+
 const nlohmann::json& ResourceManager::GetManifest() {
 	return _manifest;
 }
 
 void ResourceManager::LoadManifest(const std::string& path) {
-	std::string contents = FileHelpers::ReadFile(path);
-	nlohmann::json blob = nlohmann::json::parse(contents);
-
-	LOG_ASSERT(blob["textures"].is_array(), "Textures must exist and be an array!");
-	LOG_ASSERT(blob["meshes"].is_array(), "Meshes must exist and be an array!");
-	LOG_ASSERT(blob["shaders"].is_array(), "Shaders must exist and be an array!");
-
-	for (auto& texBlob : blob["textures"]) {
-		ResourceManager::LoadTexture2D(texBlob);
-	}
-
-	for (auto& meshBlob : blob["meshes"]) {
-		ResourceManager::LoadMesh(meshBlob);
-	}
-
-	for (auto& shaderBlob : blob["shaders"]) {
-		ResourceManager::LoadShader(shaderBlob);
-	}
+	// We stream the manifest, so each resource is loaded as soon as it's entry has been read,
+	// rather than parsing the entire file into a JSON document first
+	bool hasTextures = false, hasMeshes = false, hasShaders = false;
+	bool success = JsonStreamReader::ParseFile(path, [&](const std::string& key, const nlohmann::json& entry) {
+		if (key == "textures") {
+			ResourceManager::LoadTexture2D(entry);
+		}
+		else if (key == "meshes") {
+			ResourceManager::LoadMesh(entry);
+		}
+		else if (key == "shaders") {
+			ResourceManager::LoadShader(entry);
+		}
+		// Levels are optional, since manifests saved before there were levels don't have any
+		else if (key == "levels") {
+			ResourceManager::LoadLevel(entry);
+		}
+	},
+	// The arrays are checked as they start rather than as entries arrive, since an empty array is still valid
+	[&](const std::string& key) {
+		hasTextures |= key == "textures";
+		hasMeshes   |= key == "meshes";
+		hasShaders  |= key == "shaders";
+	});
+
+	LOG_ASSERT(success, "Failed to parse manifest!");
+	LOG_ASSERT(hasTextures, "Textures must exist and be an array!");
+	LOG_ASSERT(hasMeshes, "Meshes must exist and be an array!");
+	LOG_ASSERT(hasShaders, "Shaders must exist and be an array!");
 }
 
 void ResourceManager::SaveManifest(const std::string& path) {
@@ -167,5 +233,8 @@ void ResourceManager::Cleanup() {
 	_textures.clear();
 	_meshes.clear();
 	_shaders.clear();
+	_levels.clear();
+	// Any meshes still alive keep the geometry pool alive until they are deleted
+	_geometryPool = nullptr;
 }
 
@@ -6,8 +6,10 @@
 #include "Graphics/Texture2D.h";
 #include "Graphics/VertexArrayObject.h";
 #include "Graphics/Shader.h";
+#include "Graphics/GeometryPool.h"
 
 #include "Utils/GUID.hpp"
+#include "Game/Level.h"
 
 /// <summary>
 /// Utility class for managing and loading resources from JSON
@@ -39,6 +41,12 @@ public:
 	/// <param name="jsonData">The JSON object containing the shader's information</param>
 	/// <returns>The shader's GUID</returns>
 	static Guid LoadShader(const nlohmann::json& jsonData);
+	/// <summary>
+	/// Loads a new level from the given JSON manifest data and returns it's GUID
+	/// </summary>
+	/// <param name="jsonData">The JSON object containing the level's information</param>
+	/// <returns>The level's GUID</returns>
+	static Guid LoadLevel(const nlohmann::json& jsonData);
 
 	/// <summary>
 	/// Creates a manifest entry for a texture with the given parameters
@@ -59,6 +67,12 @@ public:
 	/// <param name="paths">The paths and corresponding ShaderPartTypes for the program (note: only VS and FS are currently supported)</param>
 	/// <returns>A JSON blob that can be appended to a manifest</returns>
 	static Guid CreateShader(const std::unordered_map<ShaderPartType, std::string>& paths);
+	/// <summary>
+	/// Creates a manifest entry for a level with the given parameters
+	/// </summary>
+	/// <param name="path">The relative path of the level file to load (.json file)</param>
+	/// <returns>A JSON blob that can be appended to a manifest</returns>
+	static Guid CreateLevel(const std::string& path);
 	
 	/// <summary>
 	/// Gets the texture with the given GUID, or nullptr if it has not been loaded
@@ -75,13 +89,24 @@ public:
 	/// </summary>
 	/// <param name="id">The GUID of the shader to fetch</param>
 	static Shader::Sptr GetShader(Guid id);
+	/// <summary>
+	/// Gets the level with the given GUID, or nullptr if it has not been loaded
+	/// </summary>
+	/// <param name="id">The GUID of the level to fetch</param>
+	static Level::Sptr GetLevel(Guid id);
+	/// <summary>
+	/// Gets the pool that small generated meshes are allocated from, and that loaded meshes are copied into,
+	/// so they can share buffers and VAOs and be drawn together with indirect draws
+	/// </summary>
+	static const GeometryPool::Sptr& GetGeometryPool();
 
 	/// <summary>
 	/// Gets the current JSON manifest
 	/// </summary>
 	static const nlohmann::json& GetManifest();
 	/// <summary>
-	/// Loads a manifest file into the resource manager
+	/// Loads a manifest file into the resource manager, streaming the file so that
+	/// each resource is loaded as it is read
 	/// </summary>
 	/// <param name="path">The path to the JSON manifest file</param>
 	static void LoadManifest(const std::string& path);
@@ -100,6 +125,8 @@ protected:
 	static std::map<Guid, Texture2D::Sptr> _textures;
 	static std::map<Guid, VertexArrayObject::Sptr> _meshes;
 	static std::map<Guid, Shader::Sptr> _shaders;
+	static std::map<Guid, Level::Sptr> _levels;
+	static GeometryPool::Sptr _geometryPool;
 
 	static nlohmann::json _manifest;
 };
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "Utils/TransformKernels.h"
+#include <algorithm>
+#include <GLM/gtc/quaternion.hpp>
+
+// SSE2 is part of the base x64 instruction set, so we can always use it there. MSVC lets us use AVX
+// intrinsics without compiling the whole project for AVX, so we check for it at runtime instead
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define TK_HAS_SSE 1
+	#include <emmintrin.h>
+	#if defined(_MSC_VER) || defined(__AVX__)
+		#define TK_HAS_AVX 1
+		#include <immintrin.h>
+	#endif
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+bool TransformKernels::_forceScalar = false;
+bool TransformKernels::_forceSse = false;
+
+#pragma region Scalar
+
+static void _ComputeModelMatricesScalar(
+	const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count,
+	glm::mat4* outModels, glm::mat3* outNormals)
+{
+	for (size_t ix = 0; ix < count; ix++) {
+		const uint32_t index = indices != nullptr ? indices[ix] : static_cast<uint32_t>(ix);
+		const glm::vec3& scale = scales[index];
+		const glm::mat3 rotation = glm::mat3_cast(glm::quat(glm::radians(rotations[index])));
+
+		outModels[index] = glm::mat4(
+			glm::vec4(rotation[0] * scale.x, 0.0f),
+			glm::vec4(rotation[1] * scale.y, 0.0f),
+			glm::vec4(rotation[2] * scale.z, 0.0f),
+			glm::vec4(positions[index], 1.0f));
+		if (outNormals != nullptr) {
+			outNormals[index] = glm::mat3(rotation[0] / scale.x, rotation[1] / scale.y, rotation[2] / scale.z);
+		}
+	}
+}
+
+static void _ComputeMVPsScalar(const glm::mat4& viewProjection, const glm::mat4* models, const uint32_t* indices, size_t count, glm::mat4* outMVPs) {
+	for (size_t ix = 0; ix < count; ix++) {
+		const uint32_t index = indices != nullptr ? indices[ix] : static_cast<uint32_t>(ix);
+		outMVPs[index] = viewProjection * models[index];
+	}
+}
+
+#pragma endregion
+
+#if TK_HAS_SSE
+
+#pragma region Lane Traits
+
+// The kernels are written once against these traits, and instantiated for each instruction set
+
+struct SseLanes {
+	typedef __m128 Type;
+	static const int Width = 4;
+
+	static Type Set(float value) { return _mm_set1_ps(value); }
+	static Type Load(const float* src) { return _mm_load_ps(src); }
+	static void Store(float* dest, Type value) { _mm_store_ps(dest, value); }
+	static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+	// SSE2 has no round instruction, but the default rounding mode for conversions is round to nearest
+	static Type Round(Type value) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(value)); }
+	static Type Equal(Type a, Type b) { return _mm_cmpeq_ps(a, b); }
+	static Type Or(Type a, Type b) { return _mm_or_ps(a, b); }
+	static Type Select(Type mask, Type a, Type b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static void Finish() { }
+};
+
+#if TK_HAS_AVX
+struct AvxLanes {
+	typedef __m256 Type;
+	static const int Width = 8;
+
+	static Type Set(float value) { return _mm256_set1_ps(value); }
+	static Type Load(const float* src) { return _mm256_load_ps(src); }
+	static void Store(float* dest, Type value) { _mm256_store_ps(dest, value); }
+	static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+	static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+	static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+	static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+	static Type Round(Type value) { return _mm256_round_ps(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+	static Type Equal(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+	static Type Or(Type a, Type b) { return _mm256_or_ps(a, b); }
+	static Type Select(Type mask, Type a, Type b) { return _mm256_blendv_ps(b, a, mask); }
+	// Avoids the penalty for switching back to SSE code with the upper halves of the registers in use
+	static void Finish() { _mm256_zeroupper(); }
+};
+
+static bool _DetectAvx() {
+	#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx     = (info[2] & (1 << 28)) != 0;
+	// The OS also needs to be saving the upper halves of the YMM registers on context switches
+	return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+	#else
+	// We were compiled with AVX enabled, so the entire program already requires it
+	return true;
+	#endif
+}
+static const bool s_HasAvx = _DetectAvx();
+#endif
+
+#pragma endregion
+
+#pragma region Kernels
+
+/// <summary>
+/// Calculates the sine and cosine of every lane, accurate to a couple of ulp for the angles we see in practice
+/// The angle is reduced into [-pi/4, pi/4] around the nearest multiple of pi/2, and the quadrant picks
+/// which polynomial and sign each result uses
+/// </summary>
+template <typename L>
+static inline void _SinCos(typename L::Type x, typename L::Type& outSin, typename L::Type& outCos) {
+	typedef typename L::Type V;
+
+	// Nearest multiple of pi/2, subtracted in 3 parts to keep precision for larger angles
+	const V j = L::Round(L::Mul(x, L::Set(0.636619772f)));
+	V r = L::Sub(x, L::Mul(j, L::Set(1.5703125f)));
+	r = L::Sub(r, L::Mul(j, L::Set(4.837512969970703125e-4f)));
+	r = L::Sub(r, L::Mul(j, L::Set(7.54978995489188216e-8f)));
+	const V r2 = L::Mul(r, r);
+
+	// Minimax polynomials on [-pi/4, pi/4]
+	V sinPoly = L::Set(-1.9515295891e-4f);
+	sinPoly = L::Add(L::Mul(sinPoly, r2), L::Set(8.3321608736e-3f));
+	sinPoly = L::Add(L::Mul(sinPoly, r2), L::Set(-1.6666654611e-1f));
+	sinPoly = L::Add(L::Mul(L::Mul(sinPoly, r2), r), r);
+
+	V cosPoly = L::Set(2.443315711809948e-5f);
+	cosPoly = L::Add(L::Mul(cosPoly, r2), L::Set(-1.388731625493765e-3f));
+	cosPoly = L::Add(L::Mul(cosPoly, r2), L::Set(4.166664568298827e-2f));
+	cosPoly = L::Add(L::Sub(L::Set(1.0f), L::Mul(r2, L::Set(0.5f))), L::Mul(L::Mul(cosPoly, r2), r2));
+
+	// Quadrant in [0, 3], (j - 1.5) / 4 is never exactly halfway between integers so the round acts as a floor
+	const V quadrant = L::Sub(j, L::Mul(L::Set(4.0f), L::Round(L::Mul(L::Sub(j, L::Set(1.5f)), L::Set(0.25f)))));
+	const V q1 = L::Equal(quadrant, L::Set(1.0f));
+	const V q2 = L::Equal(quadrant, L::Set(2.0f));
+	const V q3 = L::Equal(quadrant, L::Set(3.0f));
+
+	// Odd quadrants swap sine and cosine
+	const V odd = L::Or(q1, q3);
+	const V sinValue = L::Select(odd, cosPoly, sinPoly);
+	const V cosValue = L::Select(odd, sinPoly, cosPoly);
+
+	const V zero = L::Set(0.0f);
+	outSin = L::Select(L::Or(q2, q3), L::Sub(zero, sinValue), sinValue);
+	outCos = L::Select(L::Or(q1, q2), L::Sub(zero, cosValue), cosValue);
+}
+
+template <typename L>
+static void _ComputeModelMatricesSimd(
+	const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count,
+	glm::mat4* outModels, glm::mat3* outNormals)
+{
+	typedef typename L::Type V;
+	const int W = L::Width;
+
+	// Transposes of the inputs and outputs for the current group of lanes
+	alignas(32) float rot[3][W];
+	alignas(32) float scl[3][W];
+	alignas(32) float model[9][W];
+	alignas(32) float normal[9][W];
+	uint32_t lanes[W];
+
+	const V halfDegToRad = L::Set(0.5f * 0.0174532925f);
+
+	for (size_t base = 0; base < count; base += W) {
+		const int active = static_cast<int>(std::min<size_t>(W, count - base));
+
+		// Gather the inputs, padding out the last group by repeating it's first transform
+		for (int lane = 0; lane < W; lane++) {
+			const size_t ix = base + (lane < active ? lane : 0);
+			lanes[lane] = indices != nullptr ? indices[ix] : static_cast<uint32_t>(ix);
+			const glm::vec3& r = rotations[lanes[lane]];
+			const glm::vec3& s = scales[lanes[lane]];
+			rot[0][lane] = r.x; rot[1][lane] = r.y; rot[2][lane] = r.z;
+			scl[0][lane] = s.x; scl[1][lane] = s.y; scl[2][lane] = s.z;
+		}
+
+		// Euler angles to quaternion, same as glm::quat(glm::vec3)
+		V sx, cx, sy, cy, sz, cz;
+		_SinCos<L>(L::Mul(L::Load(rot[0]), halfDegToRad), sx, cx);
+		_SinCos<L>(L::Mul(L::Load(rot[1]), halfDegToRad), sy, cy);
+		_SinCos<L>(L::Mul(L::Load(rot[2]), halfDegToRad), sz, cz);
+
+		const V cycz = L::Mul(cy, cz);
+		const V sysz = L::Mul(sy, sz);
+		const V sycz = L::Mul(sy, cz);
+		const V cysz = L::Mul(cy, sz);
+		const V qw = L::Add(L::Mul(cx, cycz), L::Mul(sx, sysz));
+		const V qx = L::Sub(L::Mul(sx, cycz), L::Mul(cx, sysz));
+		const V qy = L::Add(L::Mul(cx, sycz), L::Mul(sx, cysz));
+		const V qz = L::Sub(L::Mul(cx, cysz), L::Mul(sx, sycz));
+
+		// Quaternion to rotation matrix, same as glm::mat3_cast
+		const V two = L::Set(2.0f);
+		const V one = L::Set(1.0f);
+		const V xx = L::Mul(qx, qx), yy = L::Mul(qy, qy), zz = L::Mul(qz, qz);
+		const V xy = L::Mul(qx, qy), xz = L::Mul(qx, qz), yz = L::Mul(qy, qz);
+		const V wx = L::Mul(qw, qx), wy = L::Mul(qw, qy), wz = L::Mul(qw, qz);
+
+		V r[9]; // Column major, r[column * 3 + row]
+		r[0] = L::Sub(one, L::Mul(two, L::Add(yy, zz)));
+		r[1] = L::Mul(two, L::Add(xy, wz));
+		r[2] = L::Mul(two, L::Sub(xz, wy));
+		r[3] = L::Mul(two, L::Sub(xy, wz));
+		r[4] = L::Sub(one, L::Mul(two, L::Add(xx, zz)));
+		r[5] = L::Mul(two, L::Add(yz, wx));
+		r[6] = L::Mul(two, L::Add(xz, wy));
+		r[7] = L::Mul(two, L::Sub(yz, wx));
+		r[8] = L::Sub(one, L::Mul(two, L::Add(xx, yy)));
+
+		// The model's upper 3x3 is R * S, and it's inverse transpose is R * S^-1
+		for (int col = 0; col < 3; col++) {
+			const V s = L::Load(scl[col]);
+			for (int row = 0; row < 3; row++) {
+				L::Store(model[col * 3 + row], L::Mul(r[col * 3 + row], s));
+				L::Store(normal[col * 3 + row], L::Div(r[col * 3 + row], s));
+			}
+		}
+
+		// Scatter the results back out
+		for (int lane = 0; lane < active; lane++) {
+			const uint32_t index = lanes[lane];
+			outModels[index] = glm::mat4(
+				glm::vec4(model[0][lane], model[1][lane], model[2][lane], 0.0f),
+				glm::vec4(model[3][lane], model[4][lane], model[5][lane], 0.0f),
+				glm::vec4(model[6][lane], model[7][lane], model[8][lane], 0.0f),
+				glm::vec4(positions[index], 1.0f));
+			if (outNormals != nullptr) {
+				outNormals[index] = glm::mat3(
+					glm::vec3(normal[0][lane], normal[1][lane], normal[2][lane]),
+					glm::vec3(normal[3][lane], normal[4][lane], normal[5][lane]),
+					glm::vec3(normal[6][lane], normal[7][lane], normal[8][lane]));
+			}
+		}
+	}
+
+	L::Finish();
+}
+
+static void _ComputeMVPsSse(const glm::mat4& viewProjection, const glm::mat4* models, const uint32_t* indices, size_t count, glm::mat4* outMVPs) {
+	// Each column of the result is the view projection's columns weighted by a column of the model
+	const float* vp = &viewProjection[0][0];
+	const __m128 c0 = _mm_loadu_ps(vp + 0);
+	const __m128 c1 = _mm_loadu_ps(vp + 4);
+	const __m128 c2 = _mm_loadu_ps(vp + 8);
+	const __m128 c3 = _mm_loadu_ps(vp + 12);
+
+	for (size_t ix = 0; ix < count; ix++) {
+		const uint32_t index = indices != nullptr ? indices[ix] : static_cast<uint32_t>(ix);
+		const float* m = &models[index][0][0];
+		float* result = &outMVPs[index][0][0];
+		for (int col = 0; col < 4; col++) {
+			const float* mc = m + col * 4;
+			__m128 sum = _mm_mul_ps(c0, _mm_set1_ps(mc[0]));
+			sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(mc[1])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(mc[2])));
+			sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(mc[3])));
+			_mm_storeu_ps(result + col * 4, sum);
+		}
+	}
+}
+
+#pragma endregion
+
+#endif
+
+void TransformKernels::ComputeModelMatrices(
+	const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count,
+	glm::mat4* outModels, glm::mat3* outNormals)
+{
+	if (count == 0) {
+		return;
+	}
+	#if TK_HAS_SSE
+	if (!_forceScalar) {
+		#if TK_HAS_AVX
+		if (s_HasAvx && !_forceSse) {
+			_ComputeModelMatricesSimd<AvxLanes>(positions, rotations, scales, indices, count, outModels, outNormals);
+			return;
+		}
+		#endif
+		_ComputeModelMatricesSimd<SseLanes>(positions, rotations, scales, indices, count, outModels, outNormals);
+		return;
+	}
+	#endif
+	_ComputeModelMatricesScalar(positions, rotations, scales, indices, count, outModels, outNormals);
+}
+
+void TransformKernels::ComputeMVPs(
+	const glm::mat4& viewProjection, const glm::mat4* models,
+	const uint32_t* indices, size_t count,
+	glm::mat4* outMVPs)
+{
+	#if TK_HAS_SSE
+	if (!_forceScalar) {
+		_ComputeMVPsSse(viewProjection, models, indices, count, outMVPs);
+		return;
+	}
+	#endif
+	_ComputeMVPsScalar(viewProjection, models, indices, count, outMVPs);
+}
+
+const char* TransformKernels::GetInstructionSet() {
+	if (_forceScalar) {
+		return "Scalar";
+	}
+	#if TK_HAS_AVX
+	if (s_HasAvx && !_forceSse) {
+		return "AVX";
+	}
+	#endif
+	#if TK_HAS_SSE
+	return "SSE2";
+	#else
+	return "Scalar";
+	#endif
+}
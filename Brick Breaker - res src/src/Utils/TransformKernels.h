@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Batched kernels for building object matrices from structure-of-arrays TRS data (see TransformStore)
+///
+/// The model matrix of a TRS transform is T * R * S, so rather than inverting the full 4x4 matrix, the
+/// normal matrix is calculated directly as R * S^-1 (the inverse transpose of the upper 3x3)
+///
+/// On x86 the work is done 8 objects at a time with AVX when the CPU supports it, or 4 at a time with SSE
+/// otherwise. Other platforms fall back to a scalar implementation that matches glm
+/// </summary>
+class TransformKernels {
+public:
+	TransformKernels() = delete;
+
+	/// <summary>
+	/// Calculates the model and normal matrices for a batch of transforms
+	/// Rotations are Euler angles in degrees, matching glm::quat(glm::radians(rotation))
+	/// </summary>
+	/// <param name="positions">The positions of the transforms</param>
+	/// <param name="rotations">The rotations of the transforms, in Euler angles (degrees)</param>
+	/// <param name="scales">The scales of the transforms</param>
+	/// <param name="indices">Optional list of the transforms to calculate, or nullptr to calculate transforms 0 to count - 1</param>
+	/// <param name="count">The number of transforms to calculate</param>
+	/// <param name="outModels">The array to store the model matrices in, at the same index as their inputs</param>
+	/// <param name="outNormals">The array to store the normal matrices in, at the same index as their inputs, may be nullptr</param>
+	static void ComputeModelMatrices(
+		const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count,
+		glm::mat4* outModels, glm::mat3* outNormals);
+
+	/// <summary>
+	/// Multiplies a batch of model matrices by a view projection matrix
+	/// </summary>
+	/// <param name="viewProjection">The view projection matrix to multiply with</param>
+	/// <param name="models">The model matrices to transform</param>
+	/// <param name="indices">Optional list of the matrices to transform, or nullptr to transform matrices 0 to count - 1</param>
+	/// <param name="count">The number of matrices to transform</param>
+	/// <param name="outMVPs">The array to store the results in, at the same index as their inputs</param>
+	static void ComputeMVPs(
+		const glm::mat4& viewProjection, const glm::mat4* models,
+		const uint32_t* indices, size_t count,
+		glm::mat4* outMVPs);
+
+	/// <summary>
+	/// Gets the name of the instruction set the kernels will use on this machine (ex: "AVX", "SSE2", "Scalar")
+	/// </summary>
+	static const char* GetInstructionSet();
+
+	/// <summary>
+	/// Forces the kernels to use the scalar fallback, for comparing results and performance against the SIMD paths
+	/// </summary>
+	static void SetForceScalar(bool value) { _forceScalar = value; }
+	/// <summary>
+	/// Forces the kernels to use SSE even when the CPU supports AVX, so both SIMD paths can be checked on one machine
+	/// </summary>
+	static void SetForceSse(bool value) { _forceSse = value; }
+
+protected:
+	static bool _forceScalar;
+	static bool _forceSse;
+};
@@ -23,6 +23,8 @@
 #include "Graphics/Shader.h"
 #include "Graphics/Texture2D.h"
 #include "Graphics/VertexTypes.h"
+#include "Graphics/Culling.h"
+#include "Graphics/GLState.h"
 
 // Utilities
 #include "Utils/MeshBuilder.h"
@@ -31,10 +33,25 @@
 #include "Utils/ImGuiHelper.h"
 
 #include "Camera.h"
+#include "Scene/Scene.h"
+#include "Scene/RenderQueue.h"
+#include "Scene/IndirectRenderer.h"
+#include "Scene/ClusterCuller.h"
+#include "Scene/ParticleSystem.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/TransformKernels.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/FixedTimestep.h"
+#include "Utils/FrameTimings.h"
+
+// Game
+#include "Game/BrickBreakerSim.h"
+#include "Game/HeadlessRunner.h"
+#include "Game/InputLog.h"
+#include "Game/Level.h"
 
 //#define LOG_GL_NOTIFICATIONS
 
@@ -82,34 +99,18 @@ void GlfwWindowResizedCallback(GLFWwindow* window, int width, int height) {
 	windowSize = glm::ivec2(width, height);
 }
 
-//Variables
-bool win = false; //check if player won
-bool lose = false; //check if player lost
-GLfloat dirX, dirY = 1.0f, speedX = 0.0f, speedY = 0.013f, radius = 0.3f; //properties of ball
-GLfloat brickRadius = 0.63f; //properties of brick
-int brickCount = 0; //when hits 5, player wins
-
-//key input to move paddle
-GLfloat movePaddle(GLfloat xPos) {
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) { //move left
-		if (xPos > -6.12)
-			xPos -= 0.05;
-	}
-
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) { //move right
-		if (xPos < 6.12)
-			xPos += 0.05;
-	}
-
-	return xPos;
-}
-
-GLfloat calcSpeed(GLfloat speedX, GLfloat speedY) {
-	return (sqrt((pow(speedX, 2)) + (pow(speedY, 2))));
-}
-
-GLfloat calcDist(GLfloat x1, GLfloat y1, GLfloat x2, GLfloat y2) {
-	return (sqrt((pow((x2 - x1), 2) + pow((y2 - y1), 2))));
+//key input to move paddle, fire and toggle lighting
+SimInput sampleInput() {
+	SimInput result;
+	result.SetDown(SimKey::Left, glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS); //move left
+	result.SetDown(SimKey::Right, glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS); //move right
+	result.SetDown(SimKey::Fire, glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS); //shoot projectiles
+	result.SetDown(SimKey::Lighting1, glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS);
+	result.SetDown(SimKey::Lighting2, glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS);
+	result.SetDown(SimKey::Lighting3, glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS);
+	result.SetDown(SimKey::Lighting4, glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS);
+	result.SetDown(SimKey::Lighting5, glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS);
+	return result;
 }
 
 
@@ -161,340 +162,6 @@ glm::vec4 UNIT_W = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 glm::vec4 ZERO = glm::vec4(0.0f);
 glm::vec4 ONE = glm::vec4(1.0f);
 
-// Helper structure for material parameters
-// to our shader
-struct MaterialInfo : IResource {
-	typedef std::shared_ptr<MaterialInfo> Sptr;
-	// A human readable name for the material
-	std::string     Name;
-	// The shader that the material is using
-	Shader::Sptr    Shader;
-
-	// Material shader parameters
-	Texture2D::Sptr Texture;
-	float           Shininess;
-
-	/// <summary>
-	/// Handles applying this material's state to the OpenGL pipeline
-	/// Will bind the shader, update material uniforms, and bind textures
-	/// </summary>
-	virtual void Apply() {
-		// Material properties
-		Shader->SetUniform("u_Material.Shininess", Shininess);
-
-		// For textures, we pass the *slot* that the texture sure draw from
-		Shader->SetUniform("u_Material.Diffuse", 0);
-
-		// Bind the texture
-		if (Texture != nullptr) {
-			Texture->Bind(0);
-		}
-	}
-
-	/// <summary>
-	/// Loads a material from a JSON blob
-	/// </summary>
-	static MaterialInfo::Sptr FromJson(const nlohmann::json& data) {
-		MaterialInfo::Sptr result = std::make_shared<MaterialInfo>();
-		result->OverrideGUID(Guid(data["guid"]));
-		result->Name = data["name"].get<std::string>();
-		result->Shader = ResourceManager::GetShader(Guid(data["shader"]));
-
-		// material specific parameters
-		result->Texture = ResourceManager::GetTexture(Guid(data["texture"]));
-		result->Shininess = data["shininess"].get<float>();
-		return result;
-	}
-
-	/// <summary>
-	/// Converts this material into it's JSON representation for storage
-	/// </summary>
-	nlohmann::json ToJson() const {
-		return {
-			{ "guid", GetGUID().str() },
-			{ "name", Name },
-			{ "shader", Shader ? Shader->GetGUID().str() : "" },
-			{ "texture", Texture ? Texture->GetGUID().str() : "" },
-			{ "shininess", Shininess },
-		};
-	}
-};
-
-// Helper structure to represent an object 
-// with a transform, mesh, and material
-struct RenderObject {
-	// Human readable name for the object
-	std::string             Name;
-	// Unique ID for the object
-	Guid                    GUID;
-	// The object's world transform
-	glm::mat4               Transform;
-	// The object's mesh
-	VertexArrayObject::Sptr Mesh;
-	// The object's material
-	MaterialInfo::Sptr      Material;
-
-	// If we want to use MeshFactory, we can populate this list
-	std::vector<MeshBuilderParam> MeshBuilderParams;
-
-	// Position of the object
-	glm::vec3 Position;
-	// Rotation of the object in Euler angler
-	glm::vec3 Rotation;
-	// The scale of the object
-	glm::vec3 Scale;
-
-	RenderObject() :
-		Name("Unknown"),
-		GUID(Guid::New()),
-		Transform(MAT4_IDENTITY),
-		Mesh(nullptr),
-		Material(nullptr),
-		MeshBuilderParams(std::vector<MeshBuilderParam>()),
-		Position(ZERO),
-		Rotation(ZERO),
-		Scale(ONE) {}
-
-	// Recalculates the Transform from the parameters (pos, rot, scale)
-	void RecalcTransform() {
-		Rotation = glm::fmod(Rotation, glm::vec3(360.0f)); // Wrap all our angles into the 0-360 degree range
-		Transform = glm::translate(MAT4_IDENTITY, Position) * glm::mat4_cast(glm::quat(glm::radians(Rotation))) * glm::scale(MAT4_IDENTITY, Scale);
-	}
-
-	// Regenerates this object's mesh if it is using the MeshFactory
-	void GenerateMesh() {
-		if (MeshBuilderParams.size() > 0) {
-			if (Mesh != nullptr) {
-				LOG_WARN("Overriding existing mesh!");
-			}
-			MeshBuilder<VertexPosNormTexCol> mesh;
-			for (int ix = 0; ix < MeshBuilderParams.size(); ix++) {
-				MeshFactory::AddParameterized(mesh, MeshBuilderParams[ix]);
-			}
-			Mesh = mesh.Bake();
-		}
-	}
-
-	/// <summary>
-	/// Loads a render object from a JSON blob
-	/// </summary>
-	static RenderObject FromJson(const nlohmann::json& data) {
-		RenderObject result = RenderObject();
-		result.Name = data["name"];
-		result.GUID = Guid(data["guid"]);
-		result.Mesh = ResourceManager::GetMesh(Guid(data["mesh"]));
-		// TODO material is not in resource manager
-		//objects[ix]["material"] = obj.Material->GetGUID().str();
-		result.Position = ParseJsonVec3(data["position"]);
-		result.Rotation = ParseJsonVec3(data["rotation"]);
-		result.Scale = ParseJsonVec3(data["scale"]);
-		// If we have mesh parameters, we'll use that instead of the existing mesh
-		if (data.contains("mesh_params") && data["mesh_params"].is_array()) {
-			std::vector<nlohmann::json> meshbuilderParams = data["mesh_params"].get<std::vector<nlohmann::json>>();
-			MeshBuilder<VertexPosNormTexCol> mesh;
-			for (int ix = 0; ix < meshbuilderParams.size(); ix++) {
-				MeshBuilderParam p = MeshBuilderParam::FromJson(meshbuilderParams[ix]);
-				result.MeshBuilderParams.push_back(p);
-				MeshFactory::AddParameterized(mesh, p);
-			}
-			result.Mesh = mesh.Bake();
-		}
-		return result;
-	}
-
-	/// <summary>
-	/// Converts this object into it's JSON representation for storage
-	/// </summary>
-	nlohmann::json ToJson() const {
-		nlohmann::json result = {
-			{ "name", Name },
-			{ "guid", GUID.str() },
-			{ "mesh", Mesh->GetGUID().str() },
-			{ "material", Material->GetGUID().str() },
-			{ "position", GlmToJson(Position) },
-			{ "rotation", GlmToJson(Rotation) },
-			{ "scale", GlmToJson(Scale) },
-		};
-		if (MeshBuilderParams.size() > 0) {
-			std::vector<nlohmann::json> params = std::vector<nlohmann::json>();
-			params.resize(MeshBuilderParams.size());
-			for (int ix = 0; ix < MeshBuilderParams.size(); ix++) {
-				params[ix] = MeshBuilderParams[ix].ToJson();
-			}
-			result["mesh_params"] = params;
-		}
-		return result;
-	}
-};
-
-// Helper structure for our light data
-struct Light {
-	glm::vec3 Position;
-	glm::vec3 Color;
-	// Basically inverse of how far our light goes (1/dist, approx)
-	float Attenuation = 1.0f / 5.0f;
-	// The approximate range of our light
-	float Range = 4.0f;
-
-	/// <summary>
-	/// Loads a light from a JSON blob
-	/// </summary>
-	static Light FromJson(const nlohmann::json& data) {
-		Light result;
-		result.Position = ParseJsonVec3(data["position"]);
-		result.Color = ParseJsonVec3(data["color"]);
-		result.Range = data["range"].get<float>();
-		result.Attenuation = 1.0f / (1.0f + result.Range);
-		return result;
-	}
-
-	/// <summary>
-	/// Converts this object into it's JSON representation for storage
-	/// </summary>
-	nlohmann::json ToJson() const {
-		return {
-			{ "position", GlmToJson(Position) },
-			{ "color", GlmToJson(Color) },
-			{ "range", Range },
-		};
-	}
-
-};
-
-// Temporary structure for storing all our scene stuffs
-struct Scene {
-	typedef std::shared_ptr<Scene> Sptr;
-
-	std::unordered_map<Guid, MaterialInfo::Sptr> Materials; // Really should be in resources but meh
-
-	// Stores all the objects in our scene
-	std::vector<RenderObject>  Objects;
-	// Stores all the lights in our scene
-	std::vector<Light>         Lights;
-	// The camera for our scene
-	Camera::Sptr               Camera;
-
-	Shader::Sptr               BaseShader; // Should think of more elegant ways of handling this
-
-	Scene() :
-		Materials(std::unordered_map<Guid, MaterialInfo::Sptr>()),
-		Objects(std::vector<RenderObject>()),
-		Lights(std::vector<Light>()),
-		Camera(nullptr),
-		BaseShader(nullptr) {}
-
-	/// <summary>
-	/// Searches all render objects in the scene and returns the first
-	/// one who's name matches the one given, or nullptr if no object
-	/// is found
-	/// </summary>
-	/// <param name="name">The name of the object to find</param>
-	RenderObject* FindObjectByName(const std::string name) {
-		auto it = std::find_if(Objects.begin(), Objects.end(), [&](const RenderObject& obj) {
-			return obj.Name == name;
-			});
-		return it == Objects.end() ? nullptr : &(*it);
-	}
-
-	/// <summary>
-	/// Loads a scene from a JSON blob
-	/// </summary>
-	static Scene::Sptr FromJson(const nlohmann::json& data) {
-		Scene::Sptr result = std::make_shared<Scene>();
-		result->BaseShader = ResourceManager::GetShader(Guid(data["default_shader"]));
-
-		LOG_ASSERT(data["materials"].is_array(), "Materials not present in scene!");
-		for (auto& material : data["materials"]) {
-			MaterialInfo::Sptr mat = MaterialInfo::FromJson(material);
-			result->Materials[mat->GetGUID()] = mat;
-		}
-
-		LOG_ASSERT(data["objects"].is_array(), "Objects not present in scene!");
-		for (auto& object : data["objects"]) {
-			RenderObject obj = RenderObject::FromJson(object);
-			obj.Material = result->Materials[Guid(object["material"])];
-			result->Objects.push_back(obj);
-		}
-
-		LOG_ASSERT(data["lights"].is_array(), "Lights not present in scene!");
-		for (auto& light : data["lights"]) {
-			result->Lights.push_back(Light::FromJson(light));
-		}
-
-		// Create and load camera config
-		result->Camera = Camera::Create();
-		result->Camera->SetPosition(ParseJsonVec3(data["camera"]["position"]));
-		result->Camera->SetForward(ParseJsonVec3(data["camera"]["normal"]));
-
-		return result;
-	}
-
-	/// <summary>
-	/// Converts this object into it's JSON representation for storage
-	/// </summary>
-	nlohmann::json ToJson() const {
-		nlohmann::json blob;
-		// Save the default shader (really need a material class)
-		blob["default_shader"] = BaseShader->GetGUID().str();
-
-		// Save materials (TODO: this should be managed by the ResourceManager)
-		std::vector<nlohmann::json> materials;
-		materials.resize(Materials.size());
-		int ix = 0;
-		for (auto& [key, value] : Materials) {
-			materials[ix] = value->ToJson();
-			ix++;
-		}
-		blob["materials"] = materials;
-
-		// Save renderables
-		std::vector<nlohmann::json> objects;
-		objects.resize(Objects.size());
-		for (int ix = 0; ix < Objects.size(); ix++) {
-			objects[ix] = Objects[ix].ToJson();
-		}
-		blob["objects"] = objects;
-
-		// Save lights
-		std::vector<nlohmann::json> lights;
-		lights.resize(Lights.size());
-		for (int ix = 0; ix < Lights.size(); ix++) {
-			lights[ix] = Lights[ix].ToJson();
-		}
-		blob["lights"] = lights;
-
-		// Save camera info
-		blob["camera"] = {
-			{"position", GlmToJson(Camera->GetPosition()) },
-			{"normal",   GlmToJson(Camera->GetForward()) }
-		};
-
-		return blob;
-	}
-
-	/// <summary>
-	/// Saves this scene to an output JSON file
-	/// </summary>
-	/// <param name="path">The path of the file to write to</param>
-	void Save(const std::string& path) {
-		// Save data to file
-		FileHelpers::WriteContentsToFile(path, ToJson().dump());
-		LOG_INFO("Saved scene to \"{}\"", path);
-	}
-
-	/// <summary>
-	/// Loads a scene from an input JSON file
-	/// </summary>
-	/// <param name="path">The path of the file to read from</param>
-	/// <returns>A new scene loaded from the file</returns>
-	static Scene::Sptr Load(const std::string& path) {
-		LOG_INFO("Loading scene from \"{}\"", path);
-		std::string content = FileHelpers::ReadFile(path);
-		nlohmann::json blob = nlohmann::json::parse(content);
-		return FromJson(blob);
-	}
-};
-
 /// <summary>
 /// Handles setting the shader uniforms for our light structure in our array of lights
 /// </summary>
@@ -547,9 +214,11 @@ bool DrawSaveLoadImGui(Scene::Sptr& scene, std::string& path) {
 	if (ImGui::Button("Load")) {
 		// Since it's a reference to a ptr, this will
 		// overwrite the existing scene!
-		scene = Scene::Load(path);
-
-		return true;
+		Scene::Sptr loaded = Scene::Load(path);
+		if (loaded != nullptr) {
+			scene = loaded;
+			return true;
+		}
 	}
 	return false;
 }
@@ -579,9 +248,30 @@ bool DrawLightImGui(const char* title, Light& light) {
 ////////////////// END OF NEW ////////////////////////
 //////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char** argv) {
 	Logger::Init(); // We'll borrow the logger from the toolkit, but we need to initialize it
 
+	// The game can run without a window for soak tests and regression checks, in which case we never touch OpenGL
+	if (HeadlessRunner::IsRequested(argc, argv)) {
+		return HeadlessRunner::Main(argc, argv);
+	}
+
+	// The input for a session can be recorded to a file, and replayed later to reproduce it exactly
+	std::string recordPath, replayPath;
+	// The brick layout to play, recordings need to be replayed on the same level they were recorded on
+	std::string levelPath = "levels/default.json";
+	for (int ix = 1; ix + 1 < argc; ix++) {
+		if (std::string(argv[ix]) == "--record") {
+			recordPath = argv[++ix];
+		}
+		else if (std::string(argv[ix]) == "--replay") {
+			replayPath = argv[++ix];
+		}
+		else if (std::string(argv[ix]) == "--level") {
+			levelPath = argv[++ix];
+		}
+	}
+
 	//Initialize GLFW
 	if (!initGLFW())
 		return 1;
@@ -633,7 +323,6 @@ int main() {
 		Guid plane = ResourceManager::CreateMesh("background.obj");
 		Guid paddleTex = ResourceManager::CreateTexture("textures/paddleTex.jpg");
 		Guid ballTex = ResourceManager::CreateTexture("textures/green.jpg");
-		Guid brickTex = ResourceManager::CreateTexture("textures/brickTex.jpg");
 		Guid backgroundTex = ResourceManager::CreateTexture("textures/background2.png");
 		Guid WinTex = ResourceManager::CreateTexture("textures/brickwin.jpeg");
 		Guid LossTex = ResourceManager::CreateTexture("textures/brickloss.jpeg");
@@ -661,12 +350,6 @@ int main() {
 		paddleMaterial->Shininess = 1.0f;
 		scene->Materials[paddleMaterial->GetGUID()] = paddleMaterial;
 
-		MaterialInfo::Sptr brickMaterial = std::make_shared<MaterialInfo>();
-		brickMaterial->Shader = scene->BaseShader;
-		brickMaterial->Texture = ResourceManager::GetTexture(brickTex);
-		brickMaterial->Shininess = 1.0f;
-		scene->Materials[brickMaterial->GetGUID()] = brickMaterial;
-
 		MaterialInfo::Sptr bgMaterial = std::make_shared<MaterialInfo>();
 		bgMaterial->Shader = scene->BaseShader;
 		bgMaterial->Texture = ResourceManager::GetTexture(backgroundTex);
@@ -709,107 +392,181 @@ int main() {
 
 		// Set up all our sample objects
 
-		RenderObject ball = RenderObject();
-		ball.Position = glm::vec3(0.0f, 0.0f, 0.0f);
-		ball.Scale = glm::vec3(0.3f, 0.3f, 0.3f);
+		RenderObject& ball = scene->CreateObject("Ball");
+		ball.SetPosition(glm::vec3(0.0f, 0.0f, 0.0f));
+		ball.SetScale(glm::vec3(0.3f, 0.3f, 0.3f));
 		ball.Mesh = ResourceManager::GetMesh(sphereMesh);
 		ball.Material = ballMaterial;
-		ball.Name = "Ball";
-		scene->Objects.push_back(ball);
 
-		RenderObject paddle = RenderObject();
-		paddle.Position = glm::vec3(0.0f, 5.8f, 0.0f);
-		paddle.Rotation = glm::vec3(180.0f, -90.0f, 0.0f);
-		paddle.Scale = glm::vec3(1.0f, 0.484f, 0.23f);
+		RenderObject& paddle = scene->CreateObject("Paddle");
+		paddle.SetPosition(glm::vec3(0.0f, 5.8f, 0.0f));
+		paddle.SetRotation(glm::vec3(180.0f, -90.0f, 0.0f));
+		paddle.SetScale(glm::vec3(1.0f, 0.484f, 0.23f));
 		paddle.Mesh = ResourceManager::GetMesh(paddleMesh);
 		paddle.Material = paddleMaterial;
-		paddle.Name = "Paddle";
-		scene->Objects.push_back(paddle);
-
-		RenderObject brick1 = RenderObject();
-		brick1.Position = glm::vec3(-4.3f, -4.5f, 0.0f);
-		brick1.Scale = glm::vec3(0.7f, 0.7f, 0.7f);
-		brick1.Mesh = ResourceManager::GetMesh(sphereMesh);
-		brick1.Material = brickMaterial;
-		brick1.Name = "Brick 1";
-		scene->Objects.push_back(brick1);
-
-		RenderObject brick2 = RenderObject();
-		brick2.Position = glm::vec3(-4.3f, -0.52f, 0.0f);
-		brick2.Scale = glm::vec3(0.7f, 0.7f, 0.7f);
-		brick2.Mesh = ResourceManager::GetMesh(sphereMesh);
-		brick2.Material = brickMaterial;
-		brick2.Name = "Brick 2";
-		scene->Objects.push_back(brick2);
-
-		RenderObject brick3 = RenderObject();
-		brick3.Position = glm::vec3(0.0f, -2.5f, 0.0f);
-		brick3.Scale = glm::vec3(0.7f, 0.7f, 0.7f);
-		brick3.Mesh = ResourceManager::GetMesh(sphereMesh);
-		brick3.Material = brickMaterial;
-		brick3.Name = "Brick 3";
-		scene->Objects.push_back(brick3);
-
-		RenderObject brick4 = RenderObject();
-		brick4.Position = glm::vec3(4.3f, -4.5f, 0.0f);
-		brick4.Scale = glm::vec3(0.7f, 0.7f, 0.7f);
-		brick4.Mesh = ResourceManager::GetMesh(sphereMesh);
-		brick4.Material = brickMaterial;
-		brick4.Name = "Brick 4";
-		scene->Objects.push_back(brick4);
-
-		RenderObject brick5 = RenderObject();
-		brick5.Position = glm::vec3(4.3f, -0.52f, 0.0f);
-		brick5.Scale = glm::vec3(0.7f, 0.7f, 0.7f);
-		brick5.Mesh = ResourceManager::GetMesh(sphereMesh);
-		brick5.Material = brickMaterial;
-		brick5.Name = "Brick 5";
-		scene->Objects.push_back(brick5);
-
-		RenderObject background = RenderObject();
-		background.Position = glm::vec3(0.0f, 0.0f, -10.0f);
-		background.Scale = glm::vec3(1.0f, 1.0f, 1.0f);
-		background.Rotation = glm::vec3(-90.0f, 0.0f, 0.0f);
+
+		// The bricks come from the level file instead of the scene (see levels/default.json)
+
+		RenderObject& background = scene->CreateObject("back");
+		background.SetPosition(glm::vec3(0.0f, 0.0f, -10.0f));
+		background.SetScale(glm::vec3(1.0f, 1.0f, 1.0f));
+		background.SetRotation(glm::vec3(-90.0f, 0.0f, 0.0f));
 		background.Mesh = ResourceManager::GetMesh(plane);
 		background.Material = bgMaterial;
-		background.Name = "back";
-		scene->Objects.push_back(background);
 
-		RenderObject Winscreen = RenderObject();
-		Winscreen.Position = glm::vec3(0.0f, 0.0f, -50.0f);
-		Winscreen.Scale = glm::vec3(1.0f, 1.0f, 1.0f);
-		Winscreen.Rotation = glm::vec3(-90.0f, 0.0f, 0.0f);
+		RenderObject& Winscreen = scene->CreateObject("winscreen");
+		Winscreen.SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
+		Winscreen.SetScale(glm::vec3(1.0f, 1.0f, 1.0f));
+		Winscreen.SetRotation(glm::vec3(-90.0f, 0.0f, 0.0f));
 		Winscreen.Mesh = ResourceManager::GetMesh(plane);
 		Winscreen.Material = winMat;
-		Winscreen.Name = "winscreen";
-		scene->Objects.push_back(Winscreen);
 
-		RenderObject Lossscreen = RenderObject();
-		Lossscreen.Position = glm::vec3(0.0f, 0.0f, -50.0f);
-		Lossscreen.Scale = glm::vec3(1.0f, 1.0f, 1.0f);
-		Lossscreen.Rotation = glm::vec3(-90.0f, 0.0f, 0.0f);
+		RenderObject& Lossscreen = scene->CreateObject("lossscreen");
+		Lossscreen.SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
+		Lossscreen.SetScale(glm::vec3(1.0f, 1.0f, 1.0f));
+		Lossscreen.SetRotation(glm::vec3(-90.0f, 0.0f, 0.0f));
 		Lossscreen.Mesh = ResourceManager::GetMesh(plane);
 		Lossscreen.Material = lossMat;
-		Lossscreen.Name = "lossscreen";
-		scene->Objects.push_back(Lossscreen);
 
 		// Save the scene to a JSON file
 		scene->Save("scene.json");
 	}
 
+	// Objects using the base shader can be drawn with multi-draw indirect instead, which needs a variant of the
+	// shader that reads it's matrices from a storage buffer
+	Shader::Sptr indirectShader = nullptr;
+	if (IndirectRenderer::IsSupported()) {
+		indirectShader = Shader::Create();
+		indirectShader->LoadShaderPartFromFile("shaders/vertex_shader_indirect.glsl", ShaderPartType::Vertex);
+		indirectShader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", ShaderPartType::Fragment);
+		if (!indirectShader->Link()) {
+			indirectShader = nullptr;
+		}
+	}
+
+	// Debris from destroyed bricks is simulated and drawn on the GPU, as long as we have compute shaders
+	ParticleSystem::Sptr debris = nullptr;
+	if (ParticleSystem::IsSupported()) {
+		Shader::Sptr debrisUpdateShader = Shader::Create();
+		Shader::Sptr debrisDrawShader = Shader::Create();
+		bool isLoaded = debrisUpdateShader->LoadShaderPartFromFile("shaders/particles_update.glsl", ShaderPartType::Compute) &&
+			debrisDrawShader->LoadShaderPartFromFile("shaders/particles_vert.glsl", ShaderPartType::Vertex) &&
+			debrisDrawShader->LoadShaderPartFromFile("shaders/particles_frag.glsl", ShaderPartType::Fragment);
+		if (isLoaded && debrisUpdateShader->Link() && debrisDrawShader->Link()) {
+			debris = ParticleSystem::Create(65536, debrisUpdateShader, debrisDrawShader);
+		}
+	}
+	ParticleSettings debrisSettings;
+	int debrisPerBrick = 4000;
+
 	// Post-load setup
 	SetupShaderAndLights(scene->BaseShader, scene->Lights.data(), scene->Lights.size());
+	if (indirectShader != nullptr) {
+		SetupShaderAndLights(indirectShader, scene->Lights.data(), scene->Lights.size());
+	}
 
-	RenderObject* ball = scene->FindObjectByName("Ball");
-	RenderObject* paddle = scene->FindObjectByName("Paddle");
-	RenderObject* brick1 = scene->FindObjectByName("Brick 1");
-	RenderObject* brick2 = scene->FindObjectByName("Brick 2");
-	RenderObject* brick3 = scene->FindObjectByName("Brick 3");
-	RenderObject* brick4 = scene->FindObjectByName("Brick 4");
-	RenderObject* brick5 = scene->FindObjectByName("Brick 5");
-	RenderObject* backgroundplane = scene->FindObjectByName("back");
-	RenderObject* winplane = scene->FindObjectByName("winscreen");
-	RenderObject* lossplane = scene->FindObjectByName("lossscreen");
+	// The brick layout, if it fails to load we fall back to any bricks that were saved in the scene
+	Level::Sptr level = ResourceManager::GetLevel(ResourceManager::CreateLevel(levelPath));
+	std::string levelLoadPath = levelPath;
+	levelLoadPath.reserve(256);
+
+	// Box bricks are drawn with a unit cube, stretched to the size of the brick. It goes in the geometry pool so all
+	// the box bricks can be drawn with instancing
+	MeshBuilder<VertexPosNormTexCol> boxBuilder;
+	MeshFactory::AddCube(boxBuilder, glm::vec3(0.0f), glm::vec3(1.0f));
+	VertexArrayObject::Sptr boxBrickMesh = boxBuilder.Bake(ResourceManager::GetGeometryPool());
+
+	// The game logic, which only knows about positions. The scene objects just show what the simulation is doing
+	BrickBreakerSim sim;
+	// Handles to the objects our game logic works with. Handles belong to a scene, so these
+	// need to be looked up again whenever a new scene gets loaded
+	ObjectHandle ballHandle, paddleHandle;
+	ObjectHandle winplaneHandle, lossplaneHandle;
+	// Bricks saved in the scene, in the same order as the simulation's bricks, if there's no level
+	std::vector<ObjectHandle> brickHandles;
+	// Whether each of the simulation's bricks is still being shown
+	std::vector<uint8_t> bricksShown;
+	// Level bricks aren't scene objects, they're drawn straight from the simulation's bricks with one instanced
+	// command for each brick type. The instances are only rebuilt when a brick breaks or the camera moves
+	std::vector<MaterialInfo::Sptr> brickMaterials;
+	std::vector<VertexArrayObject::Sptr> brickMeshes;
+	std::vector<std::vector<IndirectRenderer::ObjectData>> brickInstances;
+	std::vector<uint8_t> isBrickTypeIndirect;
+	std::unordered_map<std::string, Texture2D::Sptr> brickTextures;
+	bool isBrickInstancesDirty = true;
+	glm::mat4 brickViewProjection = glm::mat4(0.0f);
+	// The camera zooms out for levels with a bigger playfield than the default one
+	float viewScale = 15.0f;
+	float viewCenterY = 0.0f;
+	// The simulated position of the paddle from the previous simulation step, the balls keep track of their own
+	glm::vec2 previousPaddleState;
+	auto findGameObjects = [&]() {
+		ballHandle = scene->FindHandleByName("Ball");
+		paddleHandle = scene->FindHandleByName("Paddle");
+		winplaneHandle = scene->FindHandleByName("winscreen");
+		lossplaneHandle = scene->FindHandleByName("lossscreen");
+		// A new game starts with the win and loss screens out of view
+		scene->GetObjectByHandle(winplaneHandle)->SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
+		scene->GetObjectByHandle(lossplaneHandle)->SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
+
+		brickHandles.clear();
+		if (level != nullptr) {
+			level->Apply(sim);
+			previousPaddleState = sim.GetPaddlePosition();
+			// The level replaces any bricks that were saved in the scene
+			for (int ix = 1; ; ix++) {
+				RenderObject* brick = scene->GetObjectByHandle(scene->FindHandleByName("Brick " + std::to_string(ix)));
+				if (brick == nullptr) {
+					break;
+				}
+				brick->SetPosition(glm::vec3(-10.f, 0.0f, 0.0f));
+			}
+		}
+		else {
+			// Rebuild the simulation from wherever the objects are in the scene
+			previousPaddleState = glm::vec2(scene->GetObjectByHandle(paddleHandle)->GetPosition());
+			sim.SetPlayfield(BrickBreakerSim::Playfield());
+			sim.Reset(glm::vec2(scene->GetObjectByHandle(ballHandle)->GetPosition()), previousPaddleState);
+			for (int ix = 1; ; ix++) {
+				ObjectHandle handle = scene->FindHandleByName("Brick " + std::to_string(ix));
+				if (!handle.IsValid()) {
+					break;
+				}
+				brickHandles.push_back(handle);
+				sim.AddBrick(glm::vec2(scene->GetObjectByHandle(handle)->GetPosition()));
+			}
+		}
+		bricksShown.assign(sim.GetBricks().size(), 1);
+
+		// Each brick type gets it's own material, bricks of the same shape share a mesh
+		const size_t typeCount = level != nullptr ? level->Types.size() : 0;
+		brickMaterials.resize(typeCount);
+		brickMeshes.resize(typeCount);
+		brickInstances.resize(typeCount);
+		isBrickTypeIndirect.resize(typeCount);
+		for (size_t ix = 0; ix < typeCount; ix++) {
+			const Level::BrickType& type = level->Types[ix];
+			auto it = brickTextures.find(type.Texture);
+			if (it == brickTextures.end()) {
+				it = brickTextures.emplace(type.Texture, ResourceManager::GetTexture(ResourceManager::CreateTexture(type.Texture))).first;
+			}
+			brickMaterials[ix] = std::make_shared<MaterialInfo>();
+			brickMaterials[ix]->Shader = scene->BaseShader;
+			brickMaterials[ix]->Texture = it->second;
+			brickMaterials[ix]->Shininess = type.Shininess;
+			brickMeshes[ix] = type.Shape == BrickShape::Circle ? scene->GetObjectByHandle(ballHandle)->Mesh : boxBrickMesh;
+		}
+		isBrickInstancesDirty = true;
+
+		// Fit the camera to the playfield, the default one fits in the original view without moving the camera
+		const BrickBreakerSim::Playfield& playfield = sim.GetPlayfield();
+		const float aspect = static_cast<float>(windowSize.x) / static_cast<float>(windowSize.y);
+		viewScale = std::max(15.0f, std::max(playfield.LoseY - playfield.WallTop, 2.0f * playfield.WallX / aspect));
+		viewCenterY = viewScale > 15.0f ? (playfield.LoseY + playfield.WallTop) * 0.5f : 0.0f;
+		scene->Camera->SetPosition(glm::vec3(0.0f, viewCenterY, 9.0f));
+		scene->Camera->LookAt(glm::vec3(0.0f, viewCenterY, 0.0f));
+	};
+	findGameObjects();
 
 	// We'll use this to allow editing the save/load path
 	// via ImGui, note the reserve to allocate extra space
@@ -821,11 +578,49 @@ int main() {
 
 	// Our high-precision timer
 	double lastFrame = glfwGetTime();
+	// The game logic was tuned for 60 updates a second, so that's what we step it at
+	FixedTimestep timestep = FixedTimestep(1.0 / 60.0, 8);
+	sim.SetTickRate(static_cast<float>(1.0 / timestep.GetStep()));
+
+	// Recording and playback of the input for every simulation step. Both start from the scene we loaded at startup
+	InputLog::Sptr recording = recordPath.empty() ? nullptr : InputLog::Create(sim.GetTickRate());
+	InputPlayback playback = InputPlayback(replayPath.empty() ? nullptr : InputLog::Load(replayPath));
+	bool isReplaying = !playback.IsFinished();
+	if (isReplaying && playback.GetLog()->GetTickRate() != sim.GetTickRate()) {
+		LOG_WARN("\"{}\" was recorded at {} steps per second, but we're running at {}, so it won't play back the same",
+			replayPath, playback.GetLog()->GetTickRate(), sim.GetTickRate());
+	}
+	// The time of every frame while replaying, so a replay doubles as a benchmark of a real session
+	FrameTimings replayTimings;
+	// The input from the last simulation step, which also drives the lighting toggles
+	SimInput lastInput;
+	bool isVsync = true;
+	glfwSwapInterval(1);
+
+	// Per-object MVP matrices, calculated in one batch before we start drawing
+	std::vector<glm::mat4> mvpMatrices;
+	// Per-object world space bounding spheres and visibility, for frustum culling
+	std::vector<glm::vec4> boundingSpheres;
+	std::vector<uint8_t>   visibility;
+	// Visible objects are sorted by shader, material and mesh before being drawn, to cut down on state changes
+	RenderQueue renderQueue;
+	// Objects whose meshes are in the resource manager's geometry pool can be drawn with one call per material instead
+	IndirectRenderer indirectRenderer = IndirectRenderer(ResourceManager::GetGeometryPool());
+	bool useIndirect = indirectShader != nullptr;
+	// Every ball after the first (which is the Ball object) and every projectile is an instance of the ball's mesh
+	std::vector<IndirectRenderer::ObjectData> ballInstances;
+	ballInstances.reserve(sim.GetBalls().GetCapacity());
+	// Large meshes that were split into meshlets only draw the meshlets that are in view and facing the camera
+	ClusterCuller clusterCuller;
+	bool useClusterCulling = true;
+	// Distant objects use simplified meshes, as long as the error is smaller than this fraction of the screen height
+	float lodThreshold = 0.002f;
 
 	///// Game loop /////
 	while (!glfwWindowShouldClose(window)) {
 		glfwPollEvents();
 		ImGuiHelper::StartFrame();
+		GLState::ResetStats();
 
 		// Calculate the time since our last frame (dt)
 		double thisFrame = glfwGetTime();
@@ -836,175 +631,154 @@ int main() {
 		if (isDebugWindowOpen) {
 			// Make a checkbox for the monkey rotation
 			ImGui::Checkbox("Rotating", &isRotating);
+			// Rendering can run uncapped without changing how fast the game plays
+			if (ImGui::Checkbox("VSync", &isVsync)) {
+				glfwSwapInterval(isVsync ? 1 : 0);
+			}
+			ImGui::Text("Frame time: %.2f ms, simulation steps: %llu (%llu dropped)", dt * 1000.0f,
+				(unsigned long long)timestep.GetStepCount(), (unsigned long long)timestep.GetDroppedSteps());
+			ImGui::Text("Balls and projectiles: %u / %u", sim.GetBalls().GetCount(), sim.GetBalls().GetCapacity());
+			ImGui::Text("Level: %s, bricks broken: %u / %u", level != nullptr ? level->Name.c_str() : "(scene)", sim.GetBricksHit(), sim.GetBreakableBricks());
+			if (debris != nullptr) {
+				ImGui::SliderInt("Debris per brick", &debrisPerBrick, 0, 65536);
+				const ParticleSystem::Stats& debrisStats = debris->GetStats();
+				ImGui::Text("Debris: %u particles, %s (%u work groups)", debris->GetCapacity(),
+					debrisStats.IsActive ? "simulating" : "idle", debrisStats.WorkGroups);
+			}
+			if (recording != nullptr) {
+				ImGui::Text("Recording input: %u steps", recording->GetStepCount());
+			}
+			if (isReplaying) {
+				ImGui::Text("Replaying input: %u / %u steps", playback.GetStep(), playback.GetLog()->GetStepCount());
+			}
+			// Toggle between multi-draw indirect and drawing each object on it's own
+			if (indirectShader != nullptr) {
+				ImGui::Checkbox("Multi-draw indirect", &useIndirect);
+			}
+			ImGui::Checkbox("Cluster culling", &useClusterCulling);
+			ImGui::DragFloat("LOD threshold", &lodThreshold, 0.0001f, 0.0f, 0.1f, "%.4f");
+
+			// Levels can be swapped while playing, loading one is quick enough to fit in a frame
+			ImGui::Separator();
+			ImGui::InputText("Level", levelLoadPath.data(), levelLoadPath.capacity());
+			if (ImGui::Button("Load level")) {
+				const double loadStart = glfwGetTime();
+				Level::Sptr loaded = ResourceManager::GetLevel(ResourceManager::CreateLevel(levelLoadPath.c_str()));
+				if (loaded != nullptr) {
+					level = loaded;
+					findGameObjects();
+					timestep.Reset();
+					LOG_INFO("Switched to level \"{}\" in {:.3f} ms", level->Name, (glfwGetTime() - loadStart) * 1000.0);
+					// Recordings only make sense from the level they started on
+					if (recording != nullptr) {
+						LOG_WARN("Loaded a new level, restarting the input recording");
+						recording = InputLog::Create(sim.GetTickRate());
+					}
+					isReplaying = false;
+				}
+			}
 
 			// Make a new area for the scene saving/loading
 			ImGui::Separator();
 			if (DrawSaveLoadImGui(scene, scenePath)) {
 				// Re-initialize lights, as they may have moved around
 				SetupShaderAndLights(scene->BaseShader, scene->Lights.data(), scene->Lights.size());
+				if (indirectShader != nullptr) {
+					SetupShaderAndLights(indirectShader, scene->Lights.data(), scene->Lights.size());
+				}
+				// Our handles belonged to the old scene
+				findGameObjects();
+				clusterCuller.Clear();
+				timestep.Reset();
+				// Recordings only make sense from the scene they started in
+				if (recording != nullptr) {
+					LOG_WARN("Loaded a new scene, restarting the input recording");
+					recording = InputLog::Create(sim.GetTickRate());
+				}
+				isReplaying = false;
 			}
 			ImGui::Separator();
 		}
 
+		// Resolve our handles for this frame, these pointers are only valid until objects are added or removed
+		RenderObject* ball = scene->GetObjectByHandle(ballHandle);
+		RenderObject* paddle = scene->GetObjectByHandle(paddleHandle);
+		RenderObject* winplane = scene->GetObjectByHandle(winplaneHandle);
+		RenderObject* lossplane = scene->GetObjectByHandle(lossplaneHandle);
 
 
 		/////////// UPDATING GAME LOOP /////////////
 
-		//Check for Collisions
-		if ((ball->Position.x >= 7.21f) || (ball->Position.x <= -7.21f)) //bounce off left or right wall
-			dirX *= -1;
-		if (ball->Position.y <= -7.17f) //bounce off top wall
-			dirY *= -1;
-
-		//ball hits sphere bricks
-		if (calcDist(brick1->Position.x, brick1->Position.y, ball->Position.x, ball->Position.y) <= (brickRadius + radius)) {
-			brickCount++;
-			speedX = (sqrt(pow((ball->Position.x - brick1->Position.x), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-			speedY = (sqrt(pow((ball->Position.y - brick1->Position.y), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-
-			if (brick1->Position.x > ball->Position.x)
-				dirX = -1;
-			if (brick1->Position.x < ball->Position.x)
-				dirX = 1;
-			if (brick1->Position.y > ball->Position.y)
-				dirY = -1;
-			if (brick1->Position.y < ball->Position.y)
-				dirY = 1;
-
-			brick1->Position = glm::vec3(-10.f, 0.0f, 0.0f);
-		}
-
-		if (calcDist(brick2->Position.x, brick2->Position.y, ball->Position.x, ball->Position.y) <= (brickRadius + radius)) {
-			brickCount++;
-			speedX = (sqrt(pow((ball->Position.x - brick2->Position.x), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-			speedY = (sqrt(pow((ball->Position.y - brick2->Position.y), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-
-			if (brick2->Position.x > ball->Position.x)
-				dirX = -1;
-			if (brick2->Position.x < ball->Position.x)
-				dirX = 1;
-			if (brick2->Position.y > ball->Position.y)
-				dirY = -1;
-			if (brick2->Position.y < ball->Position.y)
-				dirY = 1;
-
-			brick2->Position = glm::vec3(-10.f, 0.0f, 0.0f);
-		}
-
-		if (calcDist(brick3->Position.x, brick3->Position.y, ball->Position.x, ball->Position.y) <= (brickRadius + radius)) {
-			brickCount++;
-			speedX = (sqrt(pow((ball->Position.x - brick3->Position.x), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-			speedY = (sqrt(pow((ball->Position.y - brick3->Position.y), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-
-			if (brick3->Position.x > ball->Position.x)
-				dirX = -1;
-			if (brick3->Position.x < ball->Position.x)
-				dirX = 1;
-			if (brick3->Position.y > ball->Position.y)
-				dirY = -1;
-			if (brick3->Position.y < ball->Position.y)
-				dirY = 1;
-
-			brick3->Position = glm::vec3(-10.f, 0.0f, 0.0f);
-		}
-
-		if (calcDist(brick4->Position.x, brick4->Position.y, ball->Position.x, ball->Position.y) <= (brickRadius + radius)) {
-			brickCount++;
-			speedX = (sqrt(pow((ball->Position.x - brick4->Position.x), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-			speedY = (sqrt(pow((ball->Position.y - brick4->Position.y), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-
-			if (brick4->Position.x > ball->Position.x)
-				dirX = -1;
-			if (brick4->Position.x < ball->Position.x)
-				dirX = 1;
-			if (brick4->Position.y > ball->Position.y)
-				dirY = -1;
-			if (brick4->Position.y < ball->Position.y)
-				dirY = 1;
-
-			brick4->Position = glm::vec3(-10.f, 0.0f, 0.0f);
+		// The game logic runs in fixed steps, so gameplay is the same speed no matter how fast we render
+		uint32_t simSteps = timestep.Advance(dt);
+		for (uint32_t step = 0; step < simSteps; step++) {
+			previousPaddleState = sim.GetPaddlePosition();
+			lastInput = isReplaying ? playback.Next() : sampleInput();
+			if (recording != nullptr) {
+				recording->Append(lastInput);
+			}
+			sim.Step(lastInput);
 		}
 
-		if (calcDist(brick5->Position.x, brick5->Position.y, ball->Position.x, ball->Position.y) <= (brickRadius + radius)) {
-			brickCount++;
-			speedX = (sqrt(pow((ball->Position.x - brick5->Position.x), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-			speedY = (sqrt(pow((ball->Position.y - brick5->Position.y), 2))) / ((brickRadius + radius) / calcSpeed(speedX, speedY));
-
-			if (brick5->Position.x > ball->Position.x)
-				dirX = -1;
-			if (brick5->Position.x < ball->Position.x)
-				dirX = 1;
-			if (brick5->Position.y > ball->Position.y)
-				dirY = -1;
-			if (brick5->Position.y < ball->Position.y)
-				dirY = 1;
-
-			brick5->Position = glm::vec3(-10.f, 0.0f, 0.0f);
+		if (isReplaying) {
+			replayTimings.Add(dt);
+			if (playback.IsFinished()) {
+				// Once the replay is over the player takes control again
+				isReplaying = false;
+				const uint64_t expected = playback.GetLog()->GetFinalChecksum();
+				if (expected != 0 && expected != sim.ComputeChecksum()) {
+					LOG_WARN("Replay of \"{}\" ended in a different state than it was recorded in", replayPath);
+				}
+				else {
+					LOG_INFO("Replay of \"{}\" finished", replayPath);
+				}
+				replayTimings.LogSummary(replayPath);
+				replayTimings.SaveCsv(replayPath + ".frames.csv");
+			}
 		}
 
-		//bounce off paddle (changes angle depending on where it hits paddle)
-		if (ball->Position.y >= 5.36f
-			&& (ball->Position.x >= (paddle->Position.x - 1.44f))
-			&& ball->Position.x <= (paddle->Position.x + 1.44f)) {
-
-			dirY = -1;
-
-			if (ball->Position.x < (paddle->Position.x - 0.864f)) { //far left end
-				dirX = -1;
-				speedX = 0.015f * 2;
-				speedY = 0.015f * 2;
-			}
-			else if (ball->Position.x >= (paddle->Position.x - 0.864f) && ball->Position.x < (paddle->Position.x - 0.288f)) { //left side
-				dirX = -1;
-				speedX = 0.0061f * 2;
-				speedY = 0.0148f * 2;
+		// Blend between the last two steps for rendering
+		const float alpha = timestep.GetAlpha();
+		const BallPool& balls = sim.GetBalls();
+		ball->SetPosition(glm::vec3(glm::mix(balls.GetPreviousPositions()[0], balls.GetPositions()[0], alpha), ball->GetPosition().z));
+		paddle->SetPosition(glm::vec3(glm::mix(previousPaddleState, sim.GetPaddlePosition(), alpha), paddle->GetPosition().z));
+
+		// Bricks that have been hit burst into debris, and get moved out of view
+		const std::vector<BrickBreakerSim::Brick>& simBricks = sim.GetBricks();
+		for (size_t ix = 0; ix < simBricks.size(); ix++) {
+			if (simBricks[ix].IsAlive || !bricksShown[ix]) {
+				continue;
 			}
-			else if (ball->Position.x >= (paddle->Position.x - 0.288f) && ball->Position.x <= (paddle->Position.x + 0.288)) { //middle
-				dirX = 0;
-				speedX = 0.0f;
-				speedY = 0.011f * 2;
+			if (debris != nullptr) {
+				ParticleEmitter emitter;
+				emitter.Position = glm::vec3(simBricks[ix].Position, 0.0f);
+				emitter.Color = glm::vec3(1.0f, 0.55f, 0.2f);
+				emitter.Count = static_cast<uint32_t>(debrisPerBrick);
+				emitter.Life = 1.5f;
+				emitter.Seed = static_cast<uint32_t>(ix * 7919 + sim.GetStepCount());
+				debris->Emit(emitter);
 			}
-			else if (ball->Position.x > (paddle->Position.x + 0.288f) && ball->Position.x <= (paddle->Position.x + 0.864f)) { //right side
-				dirX = 1;
-				speedX = 0.0061f * 2;
-				speedY = 0.0148f * 2;
-			}
-			else if (ball->Position.x > (paddle->Position.x + 0.864f)) { //far right end
-				dirX = 1;
-				speedX = 0.015f * 2;
-				speedY = 0.015f * 2;
+			RenderObject* brick = ix < brickHandles.size() ? scene->GetObjectByHandle(brickHandles[ix]) : nullptr;
+			if (brick != nullptr) {
+				brick->SetPosition(glm::vec3(-10.f, 0.0f, 0.0f));
 			}
+			bricksShown[ix] = 0;
+			isBrickInstancesDirty = true;
 		}
-
-		if (ball->Position.y > 6.f) { //player loses (ball goes past paddle)
-
-			speedX = 0.0f;
-			speedY = 0.0f;
-			lose = true;
-		}
-
-		if (brickCount == 5) { //player wins (hits all 5 bricks)
-			win = true;
+		if (debris != nullptr) {
+			debris->Update(dt, debrisSettings);
 		}
 
-		//Update ball movement
-		if (!lose && !win)
-			ball->Position += glm::vec3(speedX * dirX /** 2.0f*/, speedY * dirY * 2.0f, 0.f);
-
-		//Update paddle movement
-		if (!lose && !win)
-			paddle->Position.x = movePaddle(paddle->Position.x);
-		 
 		//Lose Condition
-		if (lose) {
-			lossplane->Position = glm::vec3(0.0f, 0.0f, 4.0f);
-			winplane->Position = glm::vec3(0.0f, 0.0f, -50.0f);
+		if (sim.GetState() == SimState::Lost) {
+			lossplane->SetPosition(glm::vec3(0.0f, viewCenterY, 4.0f));
+			winplane->SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
 		}
 
 		//Win Condition
-		if (win) {
-			winplane->Position = glm::vec3(0.0f, 0.0f, 4.0f);
-			lossplane->Position = glm::vec3(0.0f, 0.0f, -50.0f);
+		if (sim.GetState() == SimState::Won) {
+			winplane->SetPosition(glm::vec3(0.0f, viewCenterY, 4.0f));
+			lossplane->SetPosition(glm::vec3(0.0f, 0.0f, -50.0f));
 		}
 
 		//Swapping Shaders for Lighting Toggles
@@ -1015,33 +789,33 @@ int main() {
 		  When the player hits a number button, I would swap the materials of each object to showcase a certain shader. 
 		  Under each of the toggles, I'll explain what the associated shader does.
 		*/
-		if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) { //no lighting
+		if (lastInput.IsDown(SimKey::Lighting1)) { //no lighting
 			/*"nolight.glsl"
 			  the frag_color returns a vec4 with values of 0, so that no colour outputs
 			*/
 		}
 
-		if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) { //ambient lighting
+		if (lastInput.IsDown(SimKey::Lighting2)) { //ambient lighting
 			/* "diff.glsl"
 				made the specular value 0
 				we only return the diffuse component (no specular)
 			*/
 		}
 
-		if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) { //specular lighting
+		if (lastInput.IsDown(SimKey::Lighting3)) { //specular lighting
 			/* "spec.glsl"
 				diffuse value is 0 
 				we do not return a texture colour either, so all you see is grayscale shading as highlights
 			*/
 		}
 
-		if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) { //ambient + specular
+		if (lastInput.IsDown(SimKey::Lighting4)) { //ambient + specular
 			/* "frag_blinn_phong_textured.glsl"
 			* default shader by adding specular and diffuse
 			*/
 		}
 
-		if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) { //turn material off
+		if (lastInput.IsDown(SimKey::Lighting5)) { //turn material off
 			/* "notex.glsl"
 			*  do no return a texture and apply the lighting from the specular and diffuse
 			*/
@@ -1055,7 +829,7 @@ int main() {
 		Shader::Sptr shader = scene->BaseShader;
 		Camera::Sptr camera = scene->Camera;
 
-		camera->SetOrthoVerticalScale(15.0f);
+		camera->SetOrthoVerticalScale(viewScale);
 		camera->SetOrthoEnabled(true);
 
 		// Bind our shader for use
@@ -1063,6 +837,9 @@ int main() {
 
 		// Update our application level uniforms every frame
 		shader->SetUniform("u_CamPos", scene->Camera->GetPosition());
+		if (indirectShader != nullptr) {
+			indirectShader->SetUniform("u_CamPos", scene->Camera->GetPosition());
+		}
 
 		// Draw some ImGui stuff for the lights
 		if (isDebugWindowOpen) {
@@ -1071,6 +848,9 @@ int main() {
 				sprintf_s(buff, "Light %d##%d", ix, ix);
 				if (DrawLightImGui(buff, scene->Lights[ix])) {
 					SetShaderLight(shader, "u_Lights", ix, scene->Lights[ix]);
+					if (indirectShader != nullptr) {
+						SetShaderLight(indirectShader, "u_Lights", ix, scene->Lights[ix]);
+					}
 				}
 			}
 			// Split lights from the objects in ImGui
@@ -1078,50 +858,218 @@ int main() {
 		}
 
 
-		// Render all our objects
-		for (int ix = 0; ix < scene->Objects.size(); ix++) {
-			RenderObject* object = &scene->Objects[ix];
+		// Update the transforms for any objects that have moved since last frame, static objects keep their cached matrices
+		uint32_t recalculatedTransforms = scene->Transforms.RecalcDirty();
+		if (isDebugWindowOpen) {
+			ImGui::Text("Transforms recalculated: %u / %u (%s)", recalculatedTransforms, (uint32_t)scene->Transforms.GetCount(), TransformKernels::GetInstructionSet());
+			ImGui::Separator();
+		}
 
-			// Update the object's transform for rendering
-			object->RecalcTransform();
+		// Calculate all the MVP matrices for this frame in one pass, indexed by transform
+		mvpMatrices.resize(scene->Transforms.GetCount());
+		TransformKernels::ComputeMVPs(camera->GetViewProjection(), scene->Transforms.GetWorldMatrices(), nullptr, mvpMatrices.size(), mvpMatrices.data());
 
-			// Set vertex shader parameters
-			shader->SetUniformMatrix("u_ModelViewProjection", camera->GetViewProjection() * object->Transform);
-			shader->SetUniformMatrix("u_Model", object->Transform);
-			shader->SetUniformMatrix("u_NormalMatrix", glm::mat3(glm::transpose(glm::inverse(object->Transform))));
+		// Cull any objects that are outside of the camera's view
+		boundingSpheres.resize(scene->Objects.size());
+		visibility.resize(scene->Objects.size());
+		for (int ix = 0; ix < scene->Objects.size(); ix++) {
+			const RenderObject& object = scene->Objects[ix];
+			boundingSpheres[ix] = Culling::TransformSphere(object.Mesh->GetBounds(), object.GetTransform());
+		}
+		uint32_t drawnCount = Culling::CullSpheres(camera->GetFrustumPlanes(), boundingSpheres.data(), boundingSpheres.size(), visibility.data());
+		if (isDebugWindowOpen) {
+			ImGui::Text("Objects drawn: %u, culled: %u", drawnCount, (uint32_t)scene->Objects.size() - drawnCount);
+			ImGui::Separator();
+		}
 
-			// Apply this object's material
-			object->Material->Apply();
+		// Queue up all our objects to render
+		renderQueue.Clear();
+		indirectRenderer.Clear();
+		clusterCuller.ResetStats();
+		uint32_t lodCounts[MeshSimplifier::DEFAULT_LOD_LEVELS + 1] = {};
+		for (int ix = 0; ix < scene->Objects.size(); ix++) {
+			RenderObject* object = &scene->Objects[ix];
 
-			// Draw the object
-			object->Mesh->Draw();
+			// Pick the level of detail based on how big the object is on screen
+			uint32_t lodLevel = 0;
+			VertexArrayObject* mesh = object->Mesh->SelectLod(camera->GetProjectedSize(boundingSpheres[ix]), lodThreshold, &lodLevel);
+			if (visibility[ix]) {
+				lodCounts[std::min<uint32_t>(lodLevel, MeshSimplifier::DEFAULT_LOD_LEVELS)]++;
+			}
+
+			// Only draw the object if it's inside the camera's view, we still want it to show up in ImGui though
+			// Full detail meshes with meshlets are culled piece by piece, and drawn with only their visible triangles
+			bool isClustered = visibility[ix] && useClusterCulling && lodLevel == 0 && object->Mesh->GetClusters() != nullptr;
+			if (isClustered) {
+				mesh = clusterCuller.Cull(ix, object->Mesh, object->GetTransform(), camera->GetFrustumPlanes(), camera->GetPosition());
+			}
+			// Objects with the base shader and a pooled mesh go to the indirect renderer, everything else goes in the queue
+			bool isIndirect = visibility[ix] && !isClustered && useIndirect && object->Material->Shader == scene->BaseShader &&
+				indirectRenderer.Submit(object->Material.get(), mesh, object->GetTransform(), mvpMatrices[object->TransformIndex], object->GetNormalMatrix());
+			if (visibility[ix] && !isIndirect && mesh != nullptr) {
+				Shader* objectShader = object->Material->Shader != nullptr ? object->Material->Shader.get() : shader.get();
+				float viewDepth = glm::dot(glm::vec3(boundingSpheres[ix]) - camera->GetPosition(), camera->GetForward());
+				renderQueue.Submit(objectShader, object->Material.get(), mesh, ix, viewDepth);
+			}
 
 			// If our debug window is open, then let's draw some info for our objects!
 			if (isDebugWindowOpen) {
 				// All these elements will go into the last opened window
 				if (ImGui::CollapsingHeader(object->Name.c_str())) {
 					ImGui::PushID(ix); // Push a new ImGui ID scope for this object
-					ImGui::DragFloat3("Position", &object->Position.x, 0.01f);
-					ImGui::DragFloat3("Rotation", &object->Rotation.x, 1.0f);
-					ImGui::DragFloat3("Scale", &object->Scale.x, 0.01f, 0.0f);
+					glm::vec3 position = object->GetPosition();
+					glm::vec3 rotation = object->GetRotation();
+					glm::vec3 scale = object->GetScale();
+					if (ImGui::DragFloat3("Position", &position.x, 0.01f)) object->SetPosition(position);
+					if (ImGui::DragFloat3("Rotation", &rotation.x, 1.0f)) object->SetRotation(rotation);
+					if (ImGui::DragFloat3("Scale", &scale.x, 0.01f, 0.0f)) object->SetScale(scale);
 					ImGui::PopID(); // Pop the ImGui ID scope for the object
 				}
 			}
 		}
 
+		// The extra balls are drawn with a single instanced command, blended between steps the same as the Ball object
+		ballInstances.clear();
+		for (uint32_t ix = 1; ix < balls.GetCount(); ix++) {
+			const glm::vec2 position = glm::mix(balls.GetPreviousPositions()[ix], balls.GetPositions()[ix], alpha);
+			const float scale = balls.GetRadii()[ix] / BrickBreakerSim::BALL_RADIUS;
+			IndirectRenderer::ObjectData instance;
+			instance.Model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(position, ball->GetPosition().z)), ball->GetScale() * scale);
+			instance.ModelViewProjection = camera->GetViewProjection() * instance.Model;
+			instance.NormalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(instance.Model))));
+			ballInstances.push_back(instance);
+		}
+		bool isBallsIndirect = useIndirect && ball->Material->Shader == scene->BaseShader &&
+			indirectRenderer.SubmitInstances(ball->Material.get(), ball->Mesh.get(), ballInstances.data(), (uint32_t)ballInstances.size());
+
+		// The level's bricks that are still alive, grouped by type. Circle bricks are scaled the same as the bricks
+		// the scene used to have, and box bricks stretch a unit cube to their size
+		if (isBrickInstancesDirty || camera->GetViewProjection() != brickViewProjection) {
+			for (std::vector<IndirectRenderer::ObjectData>& instances : brickInstances) {
+				instances.clear();
+			}
+			for (const BrickBreakerSim::Brick& brick : simBricks) {
+				if (!brick.IsAlive || brick.Type >= brickInstances.size()) {
+					continue;
+				}
+				const glm::vec3 scale = brick.Shape == BrickShape::Circle ?
+					glm::vec3(0.7f * brick.HalfExtents.x / BrickBreakerSim::BRICK_RADIUS) :
+					glm::vec3(2.0f * brick.HalfExtents, 2.0f * std::min(brick.HalfExtents.x, brick.HalfExtents.y));
+				IndirectRenderer::ObjectData instance;
+				instance.Model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(brick.Position, 0.0f)), scale);
+				instance.ModelViewProjection = camera->GetViewProjection() * instance.Model;
+				instance.NormalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(instance.Model))));
+				brickInstances[brick.Type].push_back(instance);
+			}
+			isBrickInstancesDirty = false;
+			brickViewProjection = camera->GetViewProjection();
+		}
+		for (size_t type = 0; type < brickInstances.size(); type++) {
+			isBrickTypeIndirect[type] = useIndirect &&
+				indirectRenderer.SubmitInstances(brickMaterials[type].get(), brickMeshes[type].get(), brickInstances[type].data(), (uint32_t)brickInstances[type].size());
+		}
+
+		// Draw everything we queued up, grouped so that we only bind what changes between objects
+		renderQueue.Sort();
+		renderQueue.Execute([&](Shader& objectShader, const RenderQueue::Item& item) {
+			const RenderObject& object = scene->Objects[item.ObjectIndex];
+			// Set vertex shader parameters
+			objectShader.SetUniformMatrix("u_ModelViewProjection", mvpMatrices[object.TransformIndex]);
+			objectShader.SetUniformMatrix("u_Model", object.GetTransform());
+			objectShader.SetUniformMatrix("u_NormalMatrix", object.GetNormalMatrix());
+		});
+		if (useIndirect) {
+			indirectRenderer.Execute(*indirectShader);
+		}
+		// Without multi-draw indirect, or if the mesh isn't pooled, the extra balls and the bricks get drawn one at a time
+		auto drawInstances = [&](MaterialInfo& material, VertexArrayObject& mesh, const std::vector<IndirectRenderer::ObjectData>& instances) {
+			if (instances.empty()) {
+				return;
+			}
+			Shader* instanceShader = material.Shader != nullptr ? material.Shader.get() : shader.get();
+			instanceShader->Bind();
+			material.ApplyUniforms();
+			if (material.Texture != nullptr) {
+				material.Texture->Bind(0);
+			}
+			for (const IndirectRenderer::ObjectData& instance : instances) {
+				instanceShader->SetUniformMatrix("u_ModelViewProjection", instance.ModelViewProjection);
+				instanceShader->SetUniformMatrix("u_Model", instance.Model);
+				instanceShader->SetUniformMatrix("u_NormalMatrix", glm::mat3(instance.NormalMatrix));
+				mesh.Draw();
+			}
+		};
+		if (!isBallsIndirect) {
+			drawInstances(*ball->Material, *ball->Mesh, ballInstances);
+		}
+		for (size_t type = 0; type < brickInstances.size(); type++) {
+			if (!isBrickTypeIndirect[type]) {
+				drawInstances(*brickMaterials[type], *brickMeshes[type], brickInstances[type]);
+			}
+		}
+		// Particles go last, since they blend over everything else without writing depth
+		if (debris != nullptr) {
+			debris->Draw(camera->GetViewProjection(), static_cast<float>(windowSize.y), camera->GetProjection()[1][1]);
+		}
+
 		// If our debug window is open, notify that we no longer will render new
 		// elements to it
 		if (isDebugWindowOpen) {
+			const RenderQueue::Stats& stats = renderQueue.GetStats();
+			ImGui::Separator();
+			ImGui::Text("Draw calls: %u, shader binds: %u, material changes: %u, texture binds: %u, mesh binds: %u",
+				stats.DrawCalls, stats.ShaderBinds, stats.MaterialChanges, stats.TextureBinds, stats.MeshBinds);
+			if (useIndirect) {
+				const IndirectRenderer::Stats& indirectStats = indirectRenderer.GetStats();
+				ImGui::Text("Indirect objects: %u, multi-draw calls: %u", indirectStats.Objects, indirectStats.DrawCalls);
+			}
+			ImGui::Text("Objects per LOD: %u, %u, %u, %u", lodCounts[0], lodCounts[1], lodCounts[2], lodCounts[3]);
+			if (useClusterCulling) {
+				const ClusterCuller::Stats& clusterStats = clusterCuller.GetStats();
+				ImGui::Text("Clustered objects: %u, meshlets drawn: %u / %u, triangles drawn: %u / %u", clusterStats.Objects,
+					clusterStats.MeshletsVisible, clusterStats.MeshletsTested, clusterStats.TrianglesDrawn, clusterStats.TrianglesTotal);
+			}
+
+			// Show how many of this frame's binds were actually sent to OpenGL
+			const GLState::Stats& glStats = GLState::GetStats();
+			ImGui::Text("GL binds issued: %u / %u (programs: %u, textures: %u, VAOs: %u)",
+				glStats.Issued, glStats.Requested, glStats.ProgramBinds, glStats.TextureBinds, glStats.VertexArrayBinds);
+
+			// Show how well the small meshes are packed into the shared geometry buffers
+			const GeometryPool::Sptr& geometryPool = ResourceManager::GetGeometryPool();
+			const BufferAllocator::Stats vertexSpace = geometryPool->GetVertexStats();
+			const BufferAllocator::Stats indexSpace = geometryPool->GetIndexStats();
+			ImGui::Text("Pooled meshes: %u (%u layouts)", geometryPool->GetAllocationCount(), geometryPool->GetLayoutCount());
+			ImGui::Text("Vertex pool: %u / %u KB, %u free blocks, %.0f%% fragmented",
+				(uint32_t)(vertexSpace.Used / 1024), (uint32_t)(vertexSpace.Capacity / 1024), vertexSpace.FreeBlocks, vertexSpace.Fragmentation * 100.0f);
+			ImGui::Text("Index pool: %u / %u KB, %u free blocks, %.0f%% fragmented",
+				(uint32_t)(indexSpace.Used / 1024), (uint32_t)(indexSpace.Capacity / 1024), indexSpace.FreeBlocks, indexSpace.Fragmentation * 100.0f);
+			if (ImGui::Button("Defragment geometry pool")) {
+				uint32_t moved = geometryPool->Defragment();
+				LOG_INFO("Defragmented geometry pool, moved {} meshes", moved);
+			}
+			bool isValidating = GLState::IsValidationEnabled();
+			if (ImGui::Checkbox("Validate GL state", &isValidating)) {
+				GLState::SetValidationEnabled(isValidating);
+			}
 			ImGui::End();
 		}
 
-		VertexArrayObject::Unbind();
+		// Check the state cache once per frame while validating, this also catches anything that changed state behind it's back
+		if (GLState::IsValidationEnabled()) {
+			GLState::Validate();
+		}
 
 		lastFrame = thisFrame;
 		ImGuiHelper::EndFrame();
 		glfwSwapBuffers(window);
 	}
 
+	if (recording != nullptr) {
+		recording->SetFinalChecksum(sim.ComputeChecksum());
+		recording->Save(recordPath);
+	}
+
 	// Clean up the ImGui library
 	ImGuiHelper::Cleanup();  
 
@@ -0,0 +1,97 @@
+#version 430
+
+// Spawns and integrates the particles for ParticleSystem, one particle per invocation
+// This is the same math as ParticleSim, so any changes here need to be made there too
+layout(local_size_x = 256) in;
+
+// Matches Particle in ParticleSim.h
+struct Particle {
+	// XYZ is the position, W is the number of seconds left to live
+	vec4 PositionLife;
+	// XYZ is the velocity, W is the size
+	vec4 VelocitySize;
+	// RGB is the color, A is the total lifetime
+	vec4 Color;
+};
+
+// Matches ParticleSystem::EmitterData
+struct Emitter {
+	vec4  PositionSpeed;
+	vec4  ColorLife;
+	vec4  Size;
+	// X is the first index, Y is the count and Z is the seed
+	uvec4 Range;
+};
+
+layout(std430, binding = 1) buffer b_Particles {
+	Particle Particles[];
+};
+
+layout(std430, binding = 2) readonly buffer b_Emitters {
+	Emitter Emitters[];
+};
+
+uniform float u_DeltaTime;
+uniform vec3  u_Gravity;
+uniform float u_Drag;
+uniform int   u_Capacity;
+uniform int   u_EmitterCount;
+
+// Matches ParticleSim::Hash
+uint hash(uint value) {
+	value ^= value >> 16;
+	value *= 0x7FEB352Du;
+	value ^= value >> 15;
+	value *= 0x846CA68Bu;
+	value ^= value >> 16;
+	return value;
+}
+
+// Matches ParticleSim::Random
+float random(uint seed, uint index, uint stream) {
+	return float(hash(seed ^ hash(index * 4u + stream)) >> 8) / 16777216.0;
+}
+
+// Matches ParticleSim::Spawn
+Particle spawn(Emitter emitter, uint index) {
+	uint seed = emitter.Range.z;
+	float angle = random(seed, index, 0u) * 6.28318531;
+	float speed = emitter.PositionSpeed.w * (0.25 + 0.75 * random(seed, index, 1u));
+	float depth = random(seed, index, 2u) - 0.5;
+	float life = emitter.ColorLife.w * (0.75 + 0.5 * random(seed, index, 3u));
+
+	Particle result;
+	result.PositionLife = vec4(emitter.PositionSpeed.xyz, life);
+	result.VelocitySize = vec4(cos(angle) * speed, sin(angle) * speed, depth * speed, emitter.Size.x * (1.0 + depth));
+	result.Color = vec4(emitter.ColorLife.rgb, life);
+	return result;
+}
+
+void main() {
+	uint ix = gl_GlobalInvocationID.x;
+	if (ix >= uint(u_Capacity)) {
+		return;
+	}
+
+	// Particles in the range of a new emitter get replaced, later emitters win if the ranges overlap
+	for (int emitterIx = u_EmitterCount - 1; emitterIx >= 0; emitterIx--) {
+		Emitter emitter = Emitters[emitterIx];
+		uint offset = (ix + uint(u_Capacity) - emitter.Range.x) % uint(u_Capacity);
+		if (offset < emitter.Range.y) {
+			Particles[ix] = spawn(emitter, offset);
+			return;
+		}
+	}
+
+	// Matches ParticleSim::Integrate
+	Particle particle = Particles[ix];
+	if (particle.PositionLife.w <= 0.0) {
+		return;
+	}
+	vec3 velocity = particle.VelocitySize.xyz;
+	velocity += u_Gravity * u_DeltaTime;
+	velocity *= max(0.0, 1.0 - u_Drag * u_DeltaTime);
+	particle.VelocitySize.xyz = velocity;
+	particle.PositionLife = vec4(particle.PositionLife.xyz + velocity * u_DeltaTime, particle.PositionLife.w - u_DeltaTime);
+	Particles[ix] = particle;
+}
@@ -0,0 +1,44 @@
+#version 430
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+// The index of the object being drawn, comes from the draw command's base instance
+layout(location = 4) in uint inDrawIndex;
+
+layout(location = 0) out vec3 outWorldPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+
+// Matches IndirectRenderer::ObjectData
+struct ObjectData {
+	// Just the model transform, we'll do worldspace lighting
+	mat4 Model;
+	// Complete MVP
+	mat4 ModelViewProjection;
+	// Normal Matrix for transforming normals, only the upper 3x3 is used
+	mat4 NormalMatrix;
+};
+
+layout(std430, binding = 0) readonly buffer b_Objects {
+	ObjectData Objects[];
+};
+
+void main() {
+	ObjectData object = Objects[inDrawIndex];
+
+	gl_Position = object.ModelViewProjection * vec4(inPosition, 1.0);
+
+	// Pass vertex pos in world space to frag shader
+	outWorldPos = (object.Model * vec4(inPosition, 1.0)).xyz;
+
+	// Normals
+	outNormal = mat3(object.NormalMatrix) * inNormal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+
+	outColor = inColor;
+}